@@ -19,6 +19,9 @@ public class CLWorks : ModuleRules
 			Path.Combine(ModuleDirectory),
         });
 		
+		// The OpenCL:: core also builds without Unreal, see the plugin's CMakeLists.txt
+		PublicDefinitions.Add("CLWORKS_WITH_UNREAL=1");
+
 		PublicDependencyModuleNames.AddRange(new string[]
 		{
 			"Core",
@@ -34,6 +37,8 @@ public class CLWorks : ModuleRules
 			"Projects",
 			"Slate",
 			"SlateCore",
+			"TraceLog",
+			"Json",
 		});
 
         DynamicallyLoadedModuleNames.AddRange(new string[]
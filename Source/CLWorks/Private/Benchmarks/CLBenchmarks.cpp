@@ -0,0 +1,413 @@
+#include "Misc/AutomationTest.h"
+
+#include "CLWorksLib.h"
+#include "CLWorksLog.h"
+
+#include "Utils/BuiltinPrograms.h"
+#include "Utils/MipGenerator.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Texture2D.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+// Performance suite of the core paths, run headless with:
+//   UnrealEditor-Cmd <Project> -nullrhi -ExecCmds="Automation RunTests CLWorks Benchmark; Quit"
+// 
+// Command line:
+//   -CLBenchmarkPlatform=N / -CLBenchmarkDevice=N	Selects the device, e.g. a POCL CPU platform
+//   -CLBenchmarkOutput=<file>						Results file, defaults to Saved/Benchmarks/CLWorks/Results.json
+//   -CLBenchmarkBaseline=<file>					Previous results, regressions beyond the tolerance fail the test
+//   -CLBenchmarkTolerance=<percent>				Allowed regression, defaults to 10
+
+BEGIN_DEFINE_SPEC(FCLBenchmarkSpecs, "CLWorks Benchmark",
+				  EAutomationTestFlags::EditorContext | 
+				  EAutomationTestFlags::CommandletContext |
+				  EAutomationTestFlags::PerfFilter);
+
+OpenCL::DevicePtr mpDevice = nullptr;
+OpenCL::ContextPtr mpContext = nullptr;
+
+// Measurements of the current run, written once all tests finished
+TSharedPtr<FJsonObject> mpResults = nullptr;
+FDelegateHandle mWriteResultsHandle;
+
+/// <summary>
+/// Selects the benchmarked device once per process.
+/// </summary>
+/// <returns>False if the device or its context is invalid</returns>
+bool Setup()
+{
+	if (!mpDevice)
+	{
+		uint32 platformIndex = 0;
+		uint32 deviceIndex = 0;
+		FParse::Value(FCommandLine::Get(), TEXT("CLBenchmarkPlatform="), platformIndex);
+		FParse::Value(FCommandLine::Get(), TEXT("CLBenchmarkDevice="), deviceIndex);
+
+		mpDevice = OpenCL::MakeDevice(deviceIndex, platformIndex);
+		if (mpDevice->Get())
+			mpContext = OpenCL::MakeContext(mpDevice);
+	}
+
+	if (!mpResults.IsValid())
+	{
+		mpResults = MakeShared<FJsonObject>();
+		mWriteResultsHandle = FAutomationTestFramework::Get().OnAfterAllTestsEvent.AddLambda([this]()
+		{
+			WriteResults();
+		});
+	}
+
+	return mpDevice->Get() && mpContext && mpContext->Get();
+}
+
+static FString GetOutputFile()
+{
+	FString path;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("CLBenchmarkOutput="), path))
+		path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("CLWorks"), TEXT("Results.json"));
+	return path;
+}
+
+static TSharedPtr<FJsonObject> LoadResults(const FString& path)
+{
+	FString json;
+	TSharedPtr<FJsonObject> root;
+	if (FFileHelper::LoadFileToString(json, *path))
+	{
+		TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+		FJsonSerializer::Deserialize(reader, root);
+	}
+	return root;
+}
+
+/// <summary>
+/// Replaces the results file with the run's measurements, so benchmarks that
+/// didn't run leave no stale entries behind.
+/// </summary>
+void WriteResults()
+{
+	FAutomationTestFramework::Get().OnAfterAllTestsEvent.Remove(mWriteResultsHandle);
+	mWriteResultsHandle.Reset();
+
+	TSharedPtr<FJsonObject> results = MoveTemp(mpResults);
+	if (!results.IsValid() || results->Values.Num() == 0)
+		return;
+
+	const FString outputFile = GetOutputFile();
+
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(results.ToSharedRef(), writer);
+	if (!FFileHelper::SaveStringToFile(json, *outputFile))
+		UE_LOG(LogCLWorks, Error, TEXT("Couldn't Write Benchmark Results: %s"), *outputFile);
+}
+
+/// <summary>
+/// Records a measurement of the run and checks it against the baseline.
+/// </summary>
+/// <param name="name">The unique benchmark name</param>
+/// <param name="value">The measurement</param>
+/// <param name="unit">The unit, written alongside the value</param>
+/// <param name="isHigherBetter">Whether larger values are improvements</param>
+void Report(const FString& name, 
+			double value, 
+			const TCHAR* unit, 
+			bool isHigherBetter)
+{
+	UE_LOG(LogCLWorks, Display, TEXT("Benchmark %s: %.3f %s"), *name, value, unit);
+
+	TSharedPtr<FJsonObject> entry = MakeShared<FJsonObject>();
+	entry->SetNumberField(TEXT("value"), value);
+	entry->SetStringField(TEXT("unit"), unit);
+	entry->SetBoolField(TEXT("higherIsBetter"), isHigherBetter);
+	mpResults->SetObjectField(name, entry);
+
+	FString baselineFile;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("CLBenchmarkBaseline="), baselineFile))
+		return;
+
+	static TSharedPtr<FJsonObject> Baseline = LoadResults(baselineFile);
+	if (!Baseline.IsValid())
+	{
+		AddError(FString::Printf(TEXT("Invalid Benchmark Baseline: %s"), *baselineFile));
+		return;
+	}
+
+	const TSharedPtr<FJsonObject>* baselineEntry = nullptr;
+	if (!Baseline->TryGetObjectField(name, baselineEntry))
+		return;
+
+	const double baselineValue = (*baselineEntry)->GetNumberField(TEXT("value"));
+	if (baselineValue <= 0.0)
+		return;
+
+	float tolerance = 10.0f;
+	FParse::Value(FCommandLine::Get(), TEXT("CLBenchmarkTolerance="), tolerance);
+
+	// Positive is an improvement
+	const double change = (isHigherBetter ? value - baselineValue : baselineValue - value) / baselineValue * 100.0;
+	if (change < -tolerance)
+		AddError(FString::Printf(TEXT("Regression %s: %.3f %s vs Baseline %.3f %s (%.1f%%)"), *name, value, unit, baselineValue, unit, change));
+	else
+		AddInfo(FString::Printf(TEXT("%s: %.3f %s vs Baseline %.3f %s (%+.1f%%)"), *name, value, unit, baselineValue, unit, change));
+}
+
+/// <summary>
+/// Best wall time of the repetitions in seconds, after one warm up run.
+/// </summary>
+template<typename Func>
+double TimeBest(int32 repetitions, 
+				Func&& func)
+{
+	func();
+
+	double best = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < repetitions; ++i)
+	{
+		const double start = FPlatformTime::Seconds();
+		func();
+		best = FMath::Min(best, FPlatformTime::Seconds() - start);
+	}
+	return best;
+}
+
+static FString GetStrategyName(OpenCL::MemoryStrategy strategy)
+{
+	switch (strategy)
+	{
+		case OpenCL::MemoryStrategy::COPY_ONCE:
+			return TEXT("CopyOnce");
+		case OpenCL::MemoryStrategy::STREAM:
+			return TEXT("Stream");
+		case OpenCL::MemoryStrategy::ZERO_COPY:
+			return TEXT("ZeroCopy");
+		default:
+			return TEXT("Invalid");
+	}
+}
+
+static double ToMBps(size_t bytes, double seconds)
+{
+	return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+END_DEFINE_SPEC(FCLBenchmarkSpecs);
+
+void FCLBenchmarkSpecs::Define()
+{
+	// Errors raised before a test skip its body
+	BeforeEach([this]()
+	{
+		if (!Setup())
+			AddError(TEXT("Invalid Benchmark Device, Skipping the Benchmarks!"));
+	});
+
+	Describe("Buffer", [this]()
+	{
+		It("(1) Host Device Bandwidth", [this]()
+		{
+			const OpenCL::MemoryStrategy strategies[] =
+			{
+				OpenCL::MemoryStrategy::COPY_ONCE,
+				OpenCL::MemoryStrategy::STREAM,
+				OpenCL::MemoryStrategy::ZERO_COPY
+			};
+
+			const size_t sizes[] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024 };
+
+			OpenCL::CommandQueue queue(mpContext, mpDevice);
+
+			for (OpenCL::MemoryStrategy strategy : strategies)
+			{
+				for (size_t size : sizes)
+				{
+					std::vector<uint8_t> host(size, 1);
+
+					OpenCL::Buffer buffer(mpDevice, mpContext, host.data(), size, OpenCL::AccessType::READ_WRITE, strategy);
+					if (!TestTrue(TEXT("Failed Buffer Creation!"), buffer.IsValid()))
+						return;
+
+					const FString name = FString::Printf(TEXT("Buffer.%s.%lluKB"), *GetStrategyName(strategy), static_cast<uint64>(size / 1024));
+
+					// COPY_ONCE buffers can't be uploaded into after creation
+					if (strategy != OpenCL::MemoryStrategy::COPY_ONCE)
+					{
+						const double uploadSeconds = TimeBest(5, [&]()
+						{
+							buffer.Upload(queue, host.data(), size);
+							queue.WaitForFinish();
+						});
+						Report(name + TEXT(".Upload"), ToMBps(size, uploadSeconds), TEXT("MB/s"), true);
+					}
+
+					const double fetchSeconds = TimeBest(5, [&]()
+					{
+						buffer.Fetch(queue, host.data(), size);
+					});
+					Report(name + TEXT(".Readback"), ToMBps(size, fetchSeconds), TEXT("MB/s"), true);
+				}
+			}
+		});
+	});
+
+	Describe("Kernel", [this]()
+	{
+		It("(1) Launch Overhead", [this]()
+		{
+			std::shared_ptr<OpenCL::Program> program = BuiltinPrograms::Get("BenchmarkEmpty", "__kernel void empty(__global int* data) { }", mpContext, mpDevice);
+			if (!TestTrue(TEXT("Invalid Program!"), program != nullptr))
+				return;
+
+			OpenCL::Buffer buffer(mpDevice, mpContext, nullptr, sizeof(int32_t), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+
+			OpenCL::Kernel kernel(*program, "empty");
+			if (!TestTrue(TEXT("Couldn't Set Kernel Arguments!"), kernel.SetArgument<OpenCL::Buffer>(0, buffer)))
+				return;
+
+			OpenCL::CommandQueue queue(mpContext, mpDevice);
+
+			const int32 launches = 1000;
+			const size_t count = 1;
+
+			const double seconds = TimeBest(3, [&]()
+			{
+				for (int32 i = 0; i < launches; ++i)
+					queue.EnqueueRange(kernel, 1, &count);
+				queue.WaitForFinish();
+			});
+
+			TestTrue(TEXT("Couldn't Enqueue the Queue!"), queue.IsValid());
+
+			Report(TEXT("Kernel.EnqueueRange"), seconds * 1e6 / launches, TEXT("us"), false);
+		});
+	});
+
+	Describe("Program", [this]()
+	{
+		It("(1) Build Time", [this]()
+		{
+			const char* source = "__kernel void scale(__global float* data, float factor)\n"
+								 "{ int i = get_global_id(0);\n"
+								 "data[i] = data[i] * factor + sin(data[i]); }";
+
+			// Drivers may keep their own binary cache, cold builds use a fresh context each time
+			const double coldSeconds = TimeBest(3, [&]()
+			{
+				OpenCL::ContextPtr context = OpenCL::MakeContext(mpDevice);
+				OpenCL::Program program(context, mpDevice);
+				program.ReadFromString(source);
+			});
+
+			BuiltinPrograms::Get("BenchmarkBuild", source, mpContext, mpDevice);
+
+			const int32 lookups = 1000;
+			const double cachedSeconds = TimeBest(3, [&]()
+			{
+				for (int32 i = 0; i < lookups; ++i)
+					BuiltinPrograms::Get("BenchmarkBuild", source, mpContext, mpDevice);
+			});
+
+			Report(TEXT("Program.Build.Cold"), coldSeconds * 1e3, TEXT("ms"), false);
+			Report(TEXT("Program.Build.Cached"), cachedSeconds * 1e6 / lookups, TEXT("us"), false);
+		});
+	});
+
+	Describe("Image", [this]()
+	{
+		It("(1) Readback", [this]()
+		{
+			const OpenCL::Image::Format formats[] = { OpenCL::Image::RGBA8, OpenCL::Image::RGBA16F, OpenCL::Image::RGBA32F };
+			const TCHAR* formatNames[] = { TEXT("RGBA8"), TEXT("RGBA16F"), TEXT("RGBA32F") };
+
+			OpenCL::CommandQueue queue(mpContext, mpDevice);
+
+			for (int32 i = 0; i < UE_ARRAY_COUNT(formats); ++i)
+			{
+				OpenCL::Image image(mpContext, mpDevice, 1024, 1024, 1, formats[i]);
+				if (!TestNotNull(TEXT("Failed Image Creation!"), image.Get()))
+					return;
+
+				std::vector<uint8_t> output(image.GetDataSize());
+
+				const double seconds = TimeBest(5, [&]()
+				{
+					image.Fetch(queue, output.data());
+				});
+
+				Report(FString::Printf(TEXT("Image.Readback.%s"), formatNames[i]), ToMBps(image.GetDataSize(), seconds), TEXT("MB/s"), true);
+			}
+		});
+
+		It("(2) UTexture2D Upload", [this]()
+		{
+			// Headless runs have no RHI to upload into
+			if (!FApp::CanEverRender())
+			{
+				AddInfo(TEXT("Skipped, Rendering Disabled"));
+				return;
+			}
+
+			OpenCL::CommandQueue queue(mpContext, mpDevice);
+
+			OpenCL::Image image(mpContext, mpDevice, 1024, 1024);
+			if (!TestNotNull(TEXT("Failed Image Creation!"), image.Get()))
+				return;
+
+			const double seconds = TimeBest(5, [&]()
+			{
+				TObjectPtr<UTexture2D> texture = image.CreateUTexture2D(queue);
+				FlushRenderingCommands();
+			});
+
+			Report(TEXT("Image.UTexture2D.Upload"), ToMBps(image.GetDataSize(), seconds), TEXT("MB/s"), true);
+		});
+	});
+
+	Describe("MipGenerator", [this]()
+	{
+		It("(1) Throughput", [this]()
+		{
+			const size_t width = 1024;
+			const size_t height = 1024;
+			const uint8_t channels = 4;
+			const size_t values = width * height * channels;
+
+			auto run = [&](const TCHAR* format, auto* src, auto generate)
+			{
+				std::vector<Mip> mips;
+				const double seconds = TimeBest(3, [&]()
+				{
+					generate(mips, src, width, height, 1, channels);
+
+					// The first mip is the source
+					for (size_t i = 1; i < mips.size(); ++i)
+						delete[] static_cast<decltype(src)>(mips[i].mPixels);
+					mips.clear();
+				});
+
+				Report(FString::Printf(TEXT("MipGenerator.%s"), format), seconds > 0.0 ? width * height / seconds * 1e-6 : 0.0, TEXT("MPixels/s"), true);
+			};
+
+			std::vector<uint8_t> int8(values, 128);
+			std::vector<uint32_t> uint32(values, 128);
+			std::vector<int32_t> int32(values, 128);
+			std::vector<uint16_t> float16(values, FFloat16(0.5f).Encoded);
+			std::vector<float> float32(values, 0.5f);
+
+			run(TEXT("Int8"), int8.data(), &MipGenerator::GenerateMipsInt8);
+			run(TEXT("UInt32"), uint32.data(), &MipGenerator::GenerateMipsUInt32);
+			run(TEXT("Int32"), int32.data(), &MipGenerator::GenerateMipsInt32);
+			run(TEXT("Float16"), float16.data(), &MipGenerator::GenerateMipsFloat16);
+			run(TEXT("Float"), float32.data(), &MipGenerator::GenerateMipsFloat);
+		});
+	});
+}
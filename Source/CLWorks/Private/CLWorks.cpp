@@ -4,18 +4,54 @@
 
 #include "Interfaces/IPluginManager.h"
 #include "Profiler/CLProfilerManager.h"
+#include "Profiler/CLTraceExporter.h"
+#include "Profiler/CLWorksInstrumentation.h"
+#include "Profiler/CLWorkGroupTuner.h"
+#include "Render/CLTexturePool.h"
+#include "Render/UTextureUtils.h"
 
+#include "Core/CLDeviceEnumerator.h"
+#include "Core/CLRegistry.h"
+
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
 #include "Misc/Paths.h"
 #include "ShaderCore.h"
 
 #define LOCTEXT_NAMESPACE "FCLWorksModule"
 
+namespace
+{
+	FAutoConsoleCommand ListDevicesCommand(
+		TEXT("CLWorks.ListDevices"),
+		TEXT("Logs every OpenCL platform and device with its capabilities and selection scores."),
+		FConsoleCommandDelegate::CreateStatic(&OpenCL::DeviceEnumerator::Dump));
+}
+
+TSharedFuture<void> FCLWorksModule::ReadyFuture;
+
 void FCLWorksModule::StartupModule()
 {
 	FString PluginShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("CLWorks"))->GetBaseDir(), TEXT("/Shaders"));
 	AddShaderSourceDirectoryMapping(TEXT("/CLShaders"), PluginShaderDir);
 
+	// Loading the ICDs and creating the default context can take over a second with some
+	// vendors, keep it off the game thread during boot
+	ReadyFuture = Async(EAsyncExecution::ThreadPool, []()
+	{
+		OpenCL::Registry::GetContext(OpenCL::Registry::GetDevice());
+	}).Share();
+
 	mpCLProfileManager = MakeUnique<FCLProfilerManager>();
+
+	// Feed the core's dispatches and transfers into the profiler and tuner
+	mpInstrumentation = MakeUnique<FCLWorksInstrumentation>();
+	OpenCL::Instrumentation::Set(mpInstrumentation.Get());
+	mpCLTexturePool = MakeUnique<FCLTexturePool>();
+
+	// Batched blits are recorded into one render graph per frame
+	mEndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&UTextureUtils::FlushFrameBatch);
 }
 
 void FCLWorksModule::ShutdownModule()
@@ -23,7 +59,37 @@ void FCLWorksModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	FCoreDelegates::OnEndFrame.Remove(mEndFrameHandle);
+
+	// The warm up may still be creating the shared context
+	if (ReadyFuture.IsValid())
+		ReadyFuture.Wait();
+
+	// Don't lose a running device trace
+	if (FCLTraceExporter::IsCapturing())
+		FCLTraceExporter::StopCapture();
+
+	// Persist sizes tuned since the last save
+	FCLWorkGroupTuner::Save();
+
+	OpenCL::Instrumentation::Set(nullptr);
+	mpInstrumentation.Reset();
+
+	mpCLTexturePool.Reset();
 	mpCLProfileManager.Reset();
+
+	// Release the shared contexts before the ICD unloads
+	OpenCL::Registry::Reset();
+}
+
+TSharedFuture<void> FCLWorksModule::GetReadyFuture()
+{
+	return ReadyFuture;
+}
+
+bool FCLWorksModule::IsReady()
+{
+	return ReadyFuture.IsValid() && ReadyFuture.IsReady();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -1,6 +1,9 @@
 #include "Core/CLBuffer.h"
 
-#include "CLWorksLog.h"
+#include "Core/CLInstrumentation.h"
+#include "Core/CLLog.h"
+
+#include <cstring>
 
 namespace OpenCL
 {
@@ -18,11 +21,10 @@ namespace OpenCL
 	{
 		if (strategy == MemoryStrategy::ZERO_COPY)
 		{
-			SVMSupport svmSupport = device->GetSVMSupported();
-			if (svmSupport == SVMSupport::None)
+			if (device->GetCapabilities().SVM == SVMSupport::None)
 			{
 				// Fallback to streaming memory strategy on devices with no zero-copy support.
-				UE_LOG(LogCLWorks, Log, TEXT("Falling Back To STREAM Memory Strategy!"));
+				CL_LOG(Log, "Falling Back To STREAM Memory Strategy!");
 
 				mStrategy = MemoryStrategy::STREAM;
 			}
@@ -85,7 +87,7 @@ namespace OpenCL
 		}
 	}
 
-	void Buffer::Fetch(const OpenCL::CommandQueue& queue,
+	bool Buffer::Fetch(const OpenCL::CommandQueue& queue,
 					   void* output, 
 					   size_t size, 
 					   size_t offset)
@@ -94,6 +96,7 @@ namespace OpenCL
 		{
 			case MemoryStrategy::COPY_ONCE:
 			{
+				cl_event event = nullptr;
 				cl_int err = clEnqueueReadBuffer(queue,
 												 mpBuffer, 
 												 CL_TRUE, 
@@ -102,18 +105,22 @@ namespace OpenCL
 												 output, 
 												 0, 
 												 nullptr, 
-												 nullptr);
+												 queue.IsProfiling() ? &event : nullptr);
 
 				if (err < 0)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Read Buffer: %d"), err);
-					return;
+					CL_LOG(Error, "Failed to Read Buffer: %d", err);
+					return false;
 				}
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, event, TransferDirection::Readback, TransferCommand::Read, size, mStrategy);
 				break;
 			}
 			case MemoryStrategy::STREAM:
 			{
 				cl_int err;
+				cl_event mapEvent = nullptr;
 				void* hostPtr = clEnqueueMapBuffer(queue, 
 												   mpBuffer, 
 												   CL_TRUE,
@@ -122,47 +129,69 @@ namespace OpenCL
 												   size, 
 												   0,
 												   nullptr, 
-												   nullptr, 
+												   queue.IsProfiling() ? &mapEvent : nullptr,
 												   &err);
 
 				if (!hostPtr)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Map Buffer: %d"), err);
-					return;
+					CL_LOG(Error, "Failed to Map Buffer: %d", err);
+					return false;
 				}
 
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, mapEvent, TransferDirection::Readback, TransferCommand::Map, size, mStrategy);
+
 				std::memcpy(output, (uint8_t*)hostPtr + offset, size);
 
+				cl_event unmapEvent = nullptr;
 				clEnqueueUnmapMemObject(queue, 
 										mpBuffer, 
 										hostPtr, 
 										0, 
 										nullptr, 
-										nullptr);
+										queue.IsProfiling() ? &unmapEvent : nullptr);
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, unmapEvent, TransferDirection::Readback, TransferCommand::Unmap, 0, mStrategy);
 				break;
 			}
 			case MemoryStrategy::ZERO_COPY:
 			{
-				clEnqueueSVMMap(queue, 
-								CL_TRUE, 
-								CL_MAP_WRITE, 
-								mpSVMPtr, 
-								size, 
-								0,
-								nullptr, 
-								nullptr);
+				cl_event mapEvent = nullptr;
+				cl_int err = clEnqueueSVMMap(queue, 
+											 CL_TRUE, 
+											 CL_MAP_WRITE, 
+											 mpSVMPtr, 
+											 size, 
+											 0,
+											 nullptr, 
+											 queue.IsProfiling() ? &mapEvent : nullptr);
+
+				if (err < 0)
+				{
+					CL_LOG(Error, "Failed to Map Buffer: %d", err);
+					return false;
+				}
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, mapEvent, TransferDirection::Readback, TransferCommand::Map, size, mStrategy);
 
 				uint8_t* pt = (uint8_t*)mpSVMPtr + offset;
 				memcpy(output, pt, size);
 
+				cl_event unmapEvent = nullptr;
 				clEnqueueSVMUnmap(queue, 
 									mpSVMPtr, 
 									0, 
 									nullptr,
-									nullptr);
+									queue.IsProfiling() ? &unmapEvent : nullptr);
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, unmapEvent, TransferDirection::Readback, TransferCommand::Unmap, 0, mStrategy);
 				break;
 			}
 		}
+		return true;
 	}
 
 	void Buffer::FetchAsync(const std::shared_ptr<OpenCL::CommandQueue>& queue,
@@ -187,10 +216,17 @@ namespace OpenCL
 
 				if (err < 0)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Read Buffer: %d"), err);
+					CL_LOG(Error, "Failed to Read Buffer: %d", err);
 					return;
 				}
 
+				// The readback event stays with the buffer, the profiler gets its own reference
+				if (queue->IsProfiling())
+				{
+					clRetainEvent(mReadbackEvent.mpEvent);
+					Instrumentation::Get().OnTransferEnqueued(*queue, mReadbackEvent.mpEvent, TransferDirection::Readback, TransferCommand::Read, size, mStrategy);
+				}
+
 				mReadbackEvent.SetOnCompleteCallback([callback]()
 				{
 					callback();
@@ -213,10 +249,16 @@ namespace OpenCL
 
 				if (err < 0)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Map Buffer: %d"), err);
+					CL_LOG(Error, "Failed to Map Buffer: %d", err);
 					return;
 				}
 
+				if (queue->IsProfiling())
+				{
+					clRetainEvent(mReadbackEvent.mpEvent);
+					Instrumentation::Get().OnTransferEnqueued(*queue, mReadbackEvent.mpEvent, TransferDirection::Readback, TransferCommand::Map, size, mStrategy);
+				}
+
 				std::weak_ptr<CommandQueue> queuePtr = queue;
 				mReadbackEvent.SetOnCompleteCallback([hostPtr, callback, queuePtr, output, offset, size, this]()
 				{
@@ -225,12 +267,16 @@ namespace OpenCL
 					{
 						std::memcpy(output, (uint8_t*)hostPtr + offset, size);
 
+						cl_event unmapEvent = nullptr;
 						clEnqueueUnmapMemObject(queue->Get(),
 											    mpBuffer,
 											    hostPtr,
 											    0,
 											    nullptr,
-											    nullptr);
+											    queue->IsProfiling() ? &unmapEvent : nullptr);
+
+						if (queue->IsProfiling())
+							Instrumentation::Get().OnTransferEnqueued(*queue, unmapEvent, TransferDirection::Readback, TransferCommand::Unmap, 0, mStrategy);
 					}
 
 					callback();
@@ -252,10 +298,16 @@ namespace OpenCL
 
 				if (err < 0)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Map Buffer: %d"), err);
+					CL_LOG(Error, "Failed to Map Buffer: %d", err);
 					return;
 				}
 
+				if (queue->IsProfiling())
+				{
+					clRetainEvent(mReadbackEvent.mpEvent);
+					Instrumentation::Get().OnTransferEnqueued(*queue, mReadbackEvent.mpEvent, TransferDirection::Readback, TransferCommand::Map, size, mStrategy);
+				}
+
 				std::weak_ptr<CommandQueue> queuePtr = queue;
 				mReadbackEvent.SetOnCompleteCallback([callback, queuePtr, output, offset, size, this]()
 				{
@@ -265,11 +317,15 @@ namespace OpenCL
 						uint8_t* pt = (uint8_t*)mpSVMPtr + offset;
 						memcpy(output, pt, size);
 
+						cl_event unmapEvent = nullptr;
 						clEnqueueSVMUnmap(queue->Get(),
 										  mpSVMPtr,
 										  0, 
 										  nullptr,
-										  nullptr);
+										  queue->IsProfiling() ? &unmapEvent : nullptr);
+
+						if (queue->IsProfiling())
+							Instrumentation::Get().OnTransferEnqueued(*queue, unmapEvent, TransferDirection::Readback, TransferCommand::Unmap, 0, mStrategy);
 					}
 
 					callback();
@@ -288,13 +344,14 @@ namespace OpenCL
 		{
 			case MemoryStrategy::COPY_ONCE:
 			{
-				check(false);
-				UE_LOG(LogCLWorks, Error, TEXT("Attempted to Upload Into a COPY_ONCE buffer."));
+				CL_ASSERT(false);
+				CL_LOG(Error, "Attempted to Upload Into a COPY_ONCE buffer.");
 				break;
 			}
 			case MemoryStrategy::STREAM:
 			{
 				cl_int err;
+				cl_event mapEvent = nullptr;
 				void* hostPtr = clEnqueueMapBuffer(queue, 
 												   mpBuffer, 
 												   CL_TRUE, 
@@ -303,43 +360,87 @@ namespace OpenCL
 												   size, 
 												   0, 
 												   nullptr, 
-												   nullptr, 
+												   queue.IsProfiling() ? &mapEvent : nullptr,
 												   &err);
 
 				if (!hostPtr)
 				{
-					UE_LOG(LogCLWorks, Error, TEXT("Failed to Map Buffer: %d"), err);
+					CL_LOG(Error, "Failed to Map Buffer: %d", err);
 					return;
 				}
 
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, mapEvent, TransferDirection::Upload, TransferCommand::Map, 0, mStrategy);
+
 				std::memcpy((uint8_t*)hostPtr + offset, src, size);
 
+				// Written data reaches the device on unmap
+				cl_event unmapEvent = nullptr;
 				clEnqueueUnmapMemObject(queue, 
 										mpBuffer, 
 										hostPtr, 
 										0, 
 										nullptr, 
-										nullptr);
+										queue.IsProfiling() ? &unmapEvent : nullptr);
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, unmapEvent, TransferDirection::Upload, TransferCommand::Unmap, size, mStrategy);
 				break;
 			}
 			case MemoryStrategy::ZERO_COPY:
 			{
-				clEnqueueSVMMap(queue, 
-								CL_TRUE, 
-								CL_MAP_WRITE, 
-								mpSVMPtr, 
-								size, 
-								0, 
-								nullptr, 
-								nullptr);
+				uint8_t* dstPtr = static_cast<uint8_t*>(mpSVMPtr) + offset;
+
+				cl_event mapEvent = nullptr;
+				cl_int err = clEnqueueSVMMap(queue, 
+											 CL_TRUE, 
+											 CL_MAP_WRITE, 
+											 dstPtr, 
+											 size, 
+											 0, 
+											 nullptr, 
+											 queue.IsProfiling() ? &mapEvent : nullptr);
 
-				memcpy((uint8_t*)mpSVMPtr + offset, src, size);
+				if (err < 0)
+				{
+					// Copy through the runtime instead, e.g. once the region is already mapped elsewhere
+					CL_LOG(Warning, "Failed to Map Buffer: %d, Falling Back to Copy.", err);
+
+					cl_event copyEvent = nullptr;
+					err = clEnqueueSVMMemcpy(queue, 
+											 CL_TRUE, 
+											 dstPtr, 
+											 src, 
+											 size, 
+											 0, 
+											 nullptr, 
+											 queue.IsProfiling() ? &copyEvent : nullptr);
+
+					if (err < 0)
+					{
+						CL_LOG(Error, "Failed to Copy Into Buffer: %d", err);
+						return;
+					}
+
+					if (queue.IsProfiling())
+						Instrumentation::Get().OnTransferEnqueued(queue, copyEvent, TransferDirection::Upload, TransferCommand::Write, size, mStrategy);
+					break;
+				}
 
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, mapEvent, TransferDirection::Upload, TransferCommand::Map, 0, mStrategy);
+
+				std::memcpy(dstPtr, src, size);
+
+				cl_event unmapEvent = nullptr;
 				clEnqueueSVMUnmap(queue, 
-								  mpSVMPtr, 
+								  dstPtr, 
 								  0, 
 								  nullptr, 
-								  nullptr);
+								  queue.IsProfiling() ? &unmapEvent : nullptr);
+
+				if (queue.IsProfiling())
+					Instrumentation::Get().OnTransferEnqueued(queue, unmapEvent, TransferDirection::Upload, TransferCommand::Unmap, size, mStrategy);
 				break;
 			}
 		}
@@ -359,7 +460,7 @@ namespace OpenCL
 
 		if (err < 0)
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Create Buffer: %d"), err);
+			CL_LOG(Error, "Couldn't Create Buffer: %d", err);
 			return nullptr;
 		}
 		return buffer;
@@ -377,7 +478,7 @@ namespace OpenCL
 
 		if (err < 0)
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Create Kernel Argument!: %d"), err);
+			CL_LOG(Error, "Couldn't Create Kernel Argument!: %d", err);
 			return false;
 		}
 
@@ -0,0 +1,548 @@
+#include "Core/CLCommandBuffer.h"
+
+#include "Core/CLDeviceCapabilities.h"
+#include "Core/CLLog.h"
+
+#include <algorithm>
+
+namespace OpenCL
+{
+#if defined(cl_khr_command_buffer)
+	struct CommandBuffer::NativeCommandBuffer
+	{
+		clCreateCommandBufferKHR_fn Create = nullptr;
+		clCommandNDRangeKernelKHR_fn CommandNDRangeKernel = nullptr;
+		clCommandCopyBufferKHR_fn CommandCopyBuffer = nullptr;
+		clCommandFillBufferKHR_fn CommandFillBuffer = nullptr;
+		clFinalizeCommandBufferKHR_fn Finalize = nullptr;
+		clEnqueueCommandBufferKHR_fn Enqueue = nullptr;
+		clReleaseCommandBufferKHR_fn Release = nullptr;
+
+		cl_command_buffer_khr Handle = nullptr;
+
+	#if defined(cl_khr_command_buffer_mutable_dispatch)
+		clUpdateMutableCommandsKHR_fn UpdateMutableCommands = nullptr;
+
+		// Recordings whose dispatches' arguments are updated in place, one handle per command
+		bool bMutable = false;
+		std::vector<cl_mutable_command_khr> MutableCommands;
+	#endif
+
+		// The last replay, waited on if the driver refuses to replay a buffer still in flight
+		cl_event LastEvent = nullptr;
+	public:
+		~NativeCommandBuffer()
+		{
+			ReleaseHandle();
+		}
+
+		bool Load(cl_device_id device)
+		{
+			cl_platform_id platform = nullptr;
+			clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, nullptr);
+
+			Create = reinterpret_cast<clCreateCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCreateCommandBufferKHR"));
+			CommandNDRangeKernel = reinterpret_cast<clCommandNDRangeKernelKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCommandNDRangeKernelKHR"));
+			CommandCopyBuffer = reinterpret_cast<clCommandCopyBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCommandCopyBufferKHR"));
+			CommandFillBuffer = reinterpret_cast<clCommandFillBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clCommandFillBufferKHR"));
+			Finalize = reinterpret_cast<clFinalizeCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clFinalizeCommandBufferKHR"));
+			Enqueue = reinterpret_cast<clEnqueueCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clEnqueueCommandBufferKHR"));
+			Release = reinterpret_cast<clReleaseCommandBufferKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clReleaseCommandBufferKHR"));
+
+		#if defined(cl_khr_command_buffer_mutable_dispatch)
+			cl_mutable_dispatch_fields_khr fields = 0;
+			if (DeviceCapabilities::Get(device)->IsExtensionSupported("cl_khr_command_buffer_mutable_dispatch") &&
+				clGetDeviceInfo(device, CL_DEVICE_MUTABLE_DISPATCH_CAPABILITIES_KHR, sizeof(fields), &fields, nullptr) == CL_SUCCESS &&
+				(fields & CL_MUTABLE_DISPATCH_ARGUMENTS_KHR) != 0)
+			{
+				UpdateMutableCommands = reinterpret_cast<clUpdateMutableCommandsKHR_fn>(clGetExtensionFunctionAddressForPlatform(platform, "clUpdateMutableCommandsKHR"));
+				bMutable = UpdateMutableCommands != nullptr;
+			}
+		#endif
+
+			return Create && CommandNDRangeKernel && CommandCopyBuffer && CommandFillBuffer && Finalize && Enqueue && Release;
+		}
+
+		void ReleaseHandle()
+		{
+			if (LastEvent)
+			{
+				clReleaseEvent(LastEvent);
+				LastEvent = nullptr;
+			}
+
+			// The driver keeps a buffer still in flight alive until it completes
+			if (Handle)
+			{
+				Release(Handle);
+				Handle = nullptr;
+			}
+		}
+
+		// Captures the commands, dispatches with the kernels' currently bound arguments
+		bool Build(cl_command_queue queue,
+				   const std::vector<Command>& commands)
+		{
+			ReleaseHandle();
+
+			const cl_command_buffer_properties_khr* properties = nullptr;
+			const cl_command_properties_khr* dispatchProperties = nullptr;
+		#if defined(cl_khr_command_buffer_mutable_dispatch)
+			const cl_command_buffer_properties_khr mutableProperties[] = { CL_COMMAND_BUFFER_FLAGS_KHR, CL_COMMAND_BUFFER_MUTABLE_KHR, 0 };
+			const cl_command_properties_khr mutableDispatchProperties[] = { CL_MUTABLE_DISPATCH_UPDATABLE_FIELDS_KHR, CL_MUTABLE_DISPATCH_ARGUMENTS_KHR, 0 };
+			if (bMutable)
+			{
+				properties = mutableProperties;
+				dispatchProperties = mutableDispatchProperties;
+			}
+			MutableCommands.assign(commands.size(), nullptr);
+		#endif
+
+			cl_int err = 0;
+			Handle = Create(1, &queue, properties, &err);
+			if (err < 0 || !Handle)
+			{
+				CL_LOG(Warning, "Couldn't Create Command Buffer, Emulating It: %d", err);
+				Handle = nullptr;
+				return false;
+			}
+
+			for (size_t i = 0; i < commands.size(); ++i)
+			{
+				const Command& command = commands[i];
+
+				cl_mutable_command_khr* mutableCommand = nullptr;
+			#if defined(cl_khr_command_buffer_mutable_dispatch)
+				if (bMutable)
+					mutableCommand = &MutableCommands[i];
+			#endif
+
+				switch (command.Type)
+				{
+					case CommandType::Range:
+						err = CommandNDRangeKernel(Handle,
+												   nullptr,
+												   dispatchProperties,
+												   command.pKernel->Get(),
+												   command.WorkDim,
+												   nullptr,
+												   command.GlobalWorkSize,
+												   command.bHasLocalSize ? command.LocalWorkSize : nullptr,
+												   0,
+												   nullptr,
+												   nullptr,
+												   mutableCommand);
+						break;
+					case CommandType::Copy:
+						err = CommandCopyBuffer(Handle,
+												nullptr,
+												nullptr,
+												command.Source,
+												command.Destination,
+												command.SourceOffset,
+												command.DestinationOffset,
+												command.Size,
+												0,
+												nullptr,
+												nullptr,
+												nullptr);
+						break;
+					case CommandType::Fill:
+						err = CommandFillBuffer(Handle,
+												nullptr,
+												nullptr,
+												command.Destination,
+												command.Pattern.data(),
+												command.Pattern.size(),
+												command.DestinationOffset,
+												command.Size,
+												0,
+												nullptr,
+												nullptr,
+												nullptr);
+						break;
+				}
+
+				if (err < 0)
+				{
+					CL_LOG(Warning, "Couldn't Record %s Into Command Buffer, Emulating It: %d", GetCommandName(command), err);
+					ReleaseHandle();
+					return false;
+				}
+			}
+
+			err = Finalize(Handle);
+			if (err < 0)
+			{
+				CL_LOG(Warning, "Couldn't Finalize Command Buffer, Emulating It: %d", err);
+				ReleaseHandle();
+				return false;
+			}
+			return true;
+		}
+
+		// Rebinds the arguments of the stale dispatches without recording the buffer again
+		bool UpdateArguments(const std::vector<Command>& commands)
+		{
+		#if defined(cl_khr_command_buffer_mutable_dispatch)
+			if (!bMutable || !Handle)
+				return false;
+
+			std::vector<std::vector<cl_mutable_dispatch_arg_khr>> args(commands.size());
+			std::vector<std::vector<cl_mutable_dispatch_arg_khr>> svmArgs(commands.size());
+			std::vector<cl_mutable_dispatch_config_khr> configs;
+			configs.reserve(commands.size());
+
+			for (size_t i = 0; i < commands.size(); ++i)
+			{
+				const Command& command = commands[i];
+				if (command.Type != CommandType::Range || !command.bStale)
+					continue;
+
+				const Kernel& kernel = *command.pKernel;
+				for (cl_uint index = 0; index < static_cast<cl_uint>(kernel.GetArgumentCount()); ++index)
+				{
+					cl_mutable_dispatch_arg_khr arg = {};
+					bool bSVM = false;
+					if (!kernel.GetArgumentValue(index, arg.arg_value, arg.arg_size, bSVM))
+						continue;
+
+					arg.arg_index = index;
+					(bSVM ? svmArgs[i] : args[i]).push_back(arg);
+				}
+
+				cl_mutable_dispatch_config_khr config = {};
+				config.command = MutableCommands[i];
+				config.num_args = static_cast<cl_uint>(args[i].size());
+				config.num_svm_args = static_cast<cl_uint>(svmArgs[i].size());
+				config.arg_list = args[i].data();
+				config.arg_svm_list = svmArgs[i].data();
+				configs.push_back(config);
+			}
+
+			if (configs.empty())
+				return true;
+
+			std::vector<cl_command_buffer_update_type_khr> types(configs.size(), CL_STRUCTURE_TYPE_MUTABLE_DISPATCH_CONFIG_KHR);
+			std::vector<const void*> configPointers;
+			for (const cl_mutable_dispatch_config_khr& config : configs)
+				configPointers.push_back(&config);
+
+			cl_int err = UpdateMutableCommands(Handle, static_cast<cl_uint>(configs.size()), types.data(), configPointers.data());
+
+			// Devices without simultaneous use can't update a buffer that's still pending
+			if (err == CL_INVALID_OPERATION && LastEvent)
+			{
+				clWaitForEvents(1, &LastEvent);
+				err = UpdateMutableCommands(Handle, static_cast<cl_uint>(configs.size()), types.data(), configPointers.data());
+			}
+
+			if (err < 0)
+			{
+				CL_LOG(Warning, "Couldn't Update Command Buffer Arguments, Recording It Again: %d", err);
+				return false;
+			}
+			return true;
+		#else
+			return false;
+		#endif
+		}
+
+		cl_int Submit(cl_command_queue queue)
+		{
+			cl_event event = nullptr;
+			cl_int err = Enqueue(1, &queue, Handle, 0, nullptr, &event);
+
+			// Devices without simultaneous use can't replay a buffer that's still pending
+			if (err == CL_INVALID_OPERATION && LastEvent)
+			{
+				clWaitForEvents(1, &LastEvent);
+				err = Enqueue(1, &queue, Handle, 0, nullptr, &event);
+			}
+
+			if (err < 0)
+				return err;
+
+			if (LastEvent)
+				clReleaseEvent(LastEvent);
+			LastEvent = event;
+			return CL_SUCCESS;
+		}
+	};
+#else
+	// Headers predating cl_khr_command_buffer only get the emulation
+	struct CommandBuffer::NativeCommandBuffer
+	{
+		bool Load(cl_device_id) { return false; }
+		bool Build(cl_command_queue, const std::vector<Command>&) { return false; }
+		bool UpdateArguments(const std::vector<Command>&) { return false; }
+		cl_int Submit(cl_command_queue) { return CL_INVALID_OPERATION; }
+	};
+#endif
+
+	CommandBuffer::CommandBuffer(const CommandQueue& queue)
+		: mpCommandQueue(queue.Get()),
+		mpDeviceId(queue.GetDeviceId())
+	{
+		if (!mpCommandQueue)
+		{
+			CL_LOG(Error, "Command Buffer Requires a Valid Queue!");
+			return;
+		}
+
+		clRetainCommandQueue(mpCommandQueue);
+		mIsValid = true;
+	}
+
+	CommandBuffer::~CommandBuffer()
+	{
+		mpNative.reset();
+
+		if (mpCommandQueue)
+		{
+			clReleaseCommandQueue(mpCommandQueue);
+			mpCommandQueue = nullptr;
+		}
+	}
+
+	bool CommandBuffer::RecordRange(const Kernel& kernel,
+									size_t work_dim,
+									const size_t* global_work_size,
+									const size_t* local_work_size)
+	{
+		if (!CanRecord(kernel.GetName().c_str()))
+			return false;
+
+		if (!kernel.IsValid() || work_dim == 0 || work_dim > 3 || !global_work_size)
+		{
+			CL_LOG(Error, "Couldn't Record %s Into Command Buffer!", kernel.GetName().c_str());
+			return false;
+		}
+
+		Command command;
+		command.pKernel = &kernel;
+		command.WorkDim = static_cast<cl_uint>(work_dim);
+		std::copy(global_work_size, global_work_size + work_dim, command.GlobalWorkSize);
+
+		if (local_work_size)
+		{
+			std::copy(local_work_size, local_work_size + work_dim, command.LocalWorkSize);
+			command.bHasLocalSize = true;
+		}
+
+		mCommands.push_back(command);
+		return true;
+	}
+
+	bool CommandBuffer::RecordCopy(const Buffer& source,
+								   const Buffer& destination,
+								   size_t size,
+								   size_t sourceOffset,
+								   size_t destinationOffset)
+	{
+		if (!CanRecord("Buffer Copy"))
+			return false;
+
+		if (!source.Get() || !destination.Get() || size == 0 ||
+			sourceOffset + size > source.Size() || destinationOffset + size > destination.Size())
+		{
+			CL_LOG(Error, "Couldn't Record Buffer Copy Into Command Buffer!");
+			return false;
+		}
+
+		Command command;
+		command.Type = CommandType::Copy;
+		command.Source = source.Get();
+		command.Destination = destination.Get();
+		command.SourceOffset = sourceOffset;
+		command.DestinationOffset = destinationOffset;
+		command.Size = size;
+
+		mCommands.push_back(std::move(command));
+		return true;
+	}
+
+	bool CommandBuffer::RecordFill(const Buffer& buffer,
+								   const void* pattern,
+								   size_t patternSize,
+								   size_t size,
+								   size_t offset)
+	{
+		if (!CanRecord("Buffer Fill"))
+			return false;
+
+		if (!buffer.Get() || !pattern || patternSize == 0 || size == 0 ||
+			size % patternSize != 0 || offset % patternSize != 0 || offset + size > buffer.Size())
+		{
+			CL_LOG(Error, "Couldn't Record Buffer Fill Into Command Buffer!");
+			return false;
+		}
+
+		Command command;
+		command.Type = CommandType::Fill;
+		command.Destination = buffer.Get();
+		command.DestinationOffset = offset;
+		command.Size = size;
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(pattern);
+		command.Pattern.assign(bytes, bytes + patternSize);
+
+		mCommands.push_back(std::move(command));
+		return true;
+	}
+
+	bool CommandBuffer::Finalize()
+	{
+		if (!mIsValid || mIsFinalized)
+			return mIsFinalized;
+
+		bool bStale = false;
+		if (!FlushArguments(bStale))
+			return false;
+
+		mIsFinalized = true;
+
+		if (mCommands.empty() || !DeviceCapabilities::Get(mpDeviceId)->IsExtensionSupported("cl_khr_command_buffer"))
+			return true;
+
+		std::unique_ptr<NativeCommandBuffer> native = std::make_unique<NativeCommandBuffer>();
+		if (native->Load(mpDeviceId) && native->Build(mpCommandQueue, mCommands))
+			mpNative = std::move(native);
+		return true;
+	}
+
+	bool CommandBuffer::Enqueue()
+	{
+		if (!mIsValid || !mIsFinalized)
+		{
+			CL_LOG(Error, "Couldn't Enqueue an Unfinalized Command Buffer!");
+			return false;
+		}
+
+		bool bStale = false;
+		if (!FlushArguments(bStale))
+			return false;
+
+		if (!mpNative)
+			return EnqueueEmulated();
+
+		// The driver's recording holds the arguments bound when it was recorded, mutable ones are
+		// updated in place while others are recorded again
+		if (bStale && !mpNative->UpdateArguments(mCommands) && !mpNative->Build(mpCommandQueue, mCommands))
+		{
+			mpNative.reset();
+			return EnqueueEmulated();
+		}
+
+		cl_int err = mpNative->Submit(mpCommandQueue);
+		if (err < 0)
+		{
+			CL_LOG(Error, "Couldn't Enqueue the Command Buffer: %d", err);
+			return false;
+		}
+		return true;
+	}
+
+	void CommandBuffer::Reset()
+	{
+		mpNative.reset();
+		mCommands.clear();
+		mIsFinalized = false;
+	}
+
+	const char* CommandBuffer::GetCommandName(const Command& command)
+	{
+		switch (command.Type)
+		{
+			case CommandType::Copy:
+				return "Buffer Copy";
+			case CommandType::Fill:
+				return "Buffer Fill";
+			case CommandType::Range:
+			default:
+				return command.pKernel->GetName().c_str();
+		}
+	}
+
+	bool CommandBuffer::CanRecord(const char* name) const
+	{
+		if (!mIsValid)
+			return false;
+
+		if (mIsFinalized)
+		{
+			CL_LOG(Error, "Couldn't Record %s, the Command Buffer Is Finalized!", name);
+			return false;
+		}
+		return true;
+	}
+
+	bool CommandBuffer::FlushArguments(bool& bStale)
+	{
+		for (Command& command : mCommands)
+		{
+			if (command.Type != CommandType::Range)
+				continue;
+
+			if (!command.pKernel->FlushArguments())
+				return false;
+
+			const uint64_t version = command.pKernel->GetArgumentVersion();
+			command.bStale = command.ArgumentVersion != version;
+			command.ArgumentVersion = version;
+			bStale = bStale || command.bStale;
+		}
+		return true;
+	}
+
+	bool CommandBuffer::EnqueueEmulated() const
+	{
+		for (const Command& command : mCommands)
+		{
+			cl_int err = 0;
+			switch (command.Type)
+			{
+				case CommandType::Range:
+					err = clEnqueueNDRangeKernel(mpCommandQueue,
+												 command.pKernel->Get(),
+												 command.WorkDim,
+												 nullptr,
+												 command.GlobalWorkSize,
+												 command.bHasLocalSize ? command.LocalWorkSize : nullptr,
+												 0,
+												 nullptr,
+												 nullptr);
+					break;
+				case CommandType::Copy:
+					err = clEnqueueCopyBuffer(mpCommandQueue,
+											  command.Source,
+											  command.Destination,
+											  command.SourceOffset,
+											  command.DestinationOffset,
+											  command.Size,
+											  0,
+											  nullptr,
+											  nullptr);
+					break;
+				case CommandType::Fill:
+					err = clEnqueueFillBuffer(mpCommandQueue,
+											  command.Destination,
+											  command.Pattern.data(),
+											  command.Pattern.size(),
+											  command.DestinationOffset,
+											  command.Size,
+											  0,
+											  nullptr,
+											  nullptr);
+					break;
+			}
+
+			if (err < 0)
+			{
+				CL_LOG(Error, "Couldn't Enqueue %s From the Command Buffer: %d", GetCommandName(command), err);
+				return false;
+			}
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -1,14 +1,16 @@
 #include "Core/CLCommandQueue.h"
 
 #include "Core/CLContext.h"
+#include "Core/CLInstrumentation.h"
 #include "Core/CLKernel.h"
+#include "Core/CLLog.h"
 
-#include "Profiler/CLProfilerManager.h"
-
-#include "CLWorksLog.h"
+#include <atomic>
 
 namespace OpenCL
 {
+	static std::atomic<uint64_t> NextQueueId = 1;
+
 	CommandQueue::CommandQueue()
 		: mpCommandQueue(nullptr),
 		mIsValid(false)
@@ -17,19 +19,23 @@ namespace OpenCL
 	}
 
 	CommandQueue::CommandQueue(const OpenCL::ContextPtr& context, 
-							   const OpenCL::DevicePtr& device)
+							   const OpenCL::DevicePtr& device,
+							   bool forceProfiling)
 		: mpCommandQueue(nullptr),
 		mpContext(context),
 		mpAttachedDevice(device),
 		mIsValid(true)
 	{
-		Initialize(context->Get(), device->Get());
+		Initialize(context->Get(), device->Get(), forceProfiling);
 	}
 
 	CommandQueue::~CommandQueue()
 	{
 		if (mpCommandQueue)
 		{
+			if (mIsProfiling)
+				Instrumentation::Get().OnQueueReleased(*this);
+
 			clReleaseCommandQueue(mpCommandQueue);
 			mpCommandQueue = nullptr;
 		}
@@ -40,12 +46,25 @@ namespace OpenCL
 		clFinish(mpCommandQueue);
 	}
 
-	void CommandQueue::EnqueueRange(const OpenCL::Kernel& kernel,
+	bool CommandQueue::EnqueueRange(const OpenCL::Kernel& kernel,
 									size_t work_dim, 
 									const size_t* global_work_size,
 									const size_t* local_work_size)
 	{
-		cl_event event;
+		// Arguments the driver rejects were already reported
+		if (!kernel.FlushArguments())
+			return false;
+
+		Instrumentation& instrumentation = Instrumentation::Get();
+
+		// Dispatches leaving the local size to the driver may get a tuned one, trials
+		// handing back dispatch data only run on profiling queues
+		size_t selectedLocalSize[3] = {};
+		std::shared_ptr<void> dispatchData;
+		if (!local_work_size)
+			local_work_size = instrumentation.SelectLocalSize(*this, kernel, work_dim, global_work_size, selectedLocalSize, dispatchData);
+
+		cl_event event = nullptr;
 		int32_t err = clEnqueueNDRangeKernel(mpCommandQueue,
 											 kernel.Get(),
 											 work_dim,
@@ -54,42 +73,67 @@ namespace OpenCL
 											 local_work_size,
 											 0,
 											 NULL,
-											 &event);
+											 mIsProfiling ? &event : nullptr);
+
+		// A rejected local size falls back to the driver's choice
+		if (err < 0 && local_work_size == selectedLocalSize)
+		{
+			instrumentation.OnDispatchRejected(dispatchData);
+			dispatchData.reset();
 
-		FCLProfilerManager::EnqueueProfiledKernel(*this, kernel, event, work_dim, global_work_size, local_work_size);
+			local_work_size = nullptr;
+			err = clEnqueueNDRangeKernel(mpCommandQueue,
+										 kernel.Get(),
+										 work_dim,
+										 NULL,
+										 global_work_size,
+										 local_work_size,
+										 0,
+										 NULL,
+										 mIsProfiling ? &event : nullptr);
+		}
 
 		if (err < 0)
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Enqueue the Kernel: %d"), err);
+			CL_LOG(Error, "Couldn't Enqueue the Kernel: %d", err);
 			mIsValid = false;
+			return false;
 		}
+
+		// Only profiling queues have an event or trial to report
+		if (mIsProfiling)
+			instrumentation.OnKernelEnqueued(*this, kernel, event, work_dim, global_work_size, local_work_size, dispatchData);
+		return true;
 	}
 
 	void CommandQueue::Initialize(cl_context context,
-								  cl_device_id device)
+								  cl_device_id device,
+								  bool forceProfiling)
 	{
-	#ifdef CL_VERSION_2_0
+		mpDeviceId = device;
+		mId = NextQueueId.fetch_add(1, std::memory_order_relaxed);
+
+		mIsProfiling = forceProfiling || Instrumentation::Get().IsProfilingEnabled();
 
-	#if WITH_EDITOR
-		cl_command_queue_properties props[3] =
+	#ifdef CL_VERSION_2_0
+		cl_queue_properties profilingProps[3] =
 		{
 			CL_QUEUE_PROPERTIES,
 			CL_QUEUE_PROFILING_ENABLE,
 			0
 		};
-	#else
-		cl_command_queue_properties* props = nullptr;
-	#endif
+
+		const cl_queue_properties* props = mIsProfiling ? profilingProps : nullptr;
 
 		int32_t err = 0;
 		mpCommandQueue = clCreateCommandQueueWithProperties(context, device, props, &err);
 		if (err < 0)
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Failed Command Queue Creation: %d"), err);
+			CL_LOG(Error, "Failed Command Queue Creation: %d", err);
 			mIsValid = false;
 		}
 	#else
-		mpCommandQueue = clCreateCommandQueue(context, device, 0, nullptr);
+		mpCommandQueue = clCreateCommandQueue(context, device, mIsProfiling ? CL_QUEUE_PROFILING_ENABLE : 0, nullptr);
 	#endif
 	}
 }
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include "Core/CLComputeGraph.h"
+
+#include "Core/CLLog.h"
+
+#include <algorithm>
+
+namespace OpenCL
+{
+	ComputeGraph::PassContext::PassContext(const ComputeGraph& graph,
+										   uint32_t passIndex,
+										   CommandQueue& queue)
+		: mGraph(graph),
+		mPassIndex(passIndex),
+		mpQueue(&queue)
+	{
+	}
+
+	cl_mem ComputeGraph::PassContext::Get(GraphResource resource) const
+	{
+		const Pass& pass = mGraph.mPasses[mPassIndex];
+
+		const bool bDeclared = std::find(pass.Reads.begin(), pass.Reads.end(), resource.Index) != pass.Reads.end() ||
+							   std::find(pass.Writes.begin(), pass.Writes.end(), resource.Index) != pass.Writes.end();
+		if (!bDeclared)
+		{
+			CL_LOG(Error, "Pass %s Accessed an Undeclared Resource!", pass.Name.c_str());
+			return nullptr;
+		}
+		return mGraph.mResources[resource.Index].Memory;
+	}
+
+	ComputeGraph::ComputeGraph(TransientPool& pool)
+		: mPool(pool)
+	{
+	}
+
+	GraphResource ComputeGraph::CreateBuffer(const std::string& name,
+											 size_t size)
+	{
+		Resource resource;
+		resource.Name = name;
+		resource.Desc.Kind = TransientDesc::Type::Buffer;
+		resource.Desc.Size = size;
+		return AddResource(std::move(resource));
+	}
+
+	GraphResource ComputeGraph::CreateImage2D(const std::string& name,
+											  const cl_image_format& format,
+											  size_t width,
+											  size_t height)
+	{
+		Resource resource;
+		resource.Name = name;
+		resource.Desc.Kind = TransientDesc::Type::Image2D;
+		resource.Desc.Format = format;
+		resource.Desc.Width = width;
+		resource.Desc.Height = height;
+		return AddResource(std::move(resource));
+	}
+
+	GraphResource ComputeGraph::ImportBuffer(const std::string& name,
+											 const Buffer& buffer)
+	{
+		// Shared virtual memory has no memory object to hand to the passes
+		if (!buffer.Get())
+		{
+			CL_LOG(Error, "Couldn't Import %s, Buffer Has No Memory Object!", name.c_str());
+			return GraphResource();
+		}
+		return ImportMemory(name, buffer.Get());
+	}
+
+	GraphResource ComputeGraph::ImportMemory(const std::string& name,
+											 cl_mem memory)
+	{
+		Resource resource;
+		resource.Name = name;
+		resource.bImported = true;
+		resource.Memory = memory;
+		return AddResource(std::move(resource));
+	}
+
+	void ComputeGraph::MarkOutput(GraphResource resource)
+	{
+		if (IsValidResource(resource, "Mark"))
+			mResources[resource.Index].bOutput = true;
+	}
+
+	void ComputeGraph::AddPass(const std::string& name,
+							   const std::vector<GraphResource>& reads,
+							   const std::vector<GraphResource>& writes,
+							   PassFunction&& execute,
+							   CommandQueue* queue,
+							   bool bNeverCull)
+	{
+		Pass pass;
+		pass.Name = name;
+		pass.Execute = std::move(execute);
+		pass.Queue = queue;
+		pass.bNeverCull = bNeverCull;
+
+		for (GraphResource resource : reads)
+		{
+			if (IsValidResource(resource, "Read"))
+				pass.Reads.push_back(resource.Index);
+		}
+
+		for (GraphResource resource : writes)
+		{
+			if (IsValidResource(resource, "Write"))
+				pass.Writes.push_back(resource.Index);
+		}
+
+		mPasses.push_back(std::move(pass));
+	}
+
+	bool ComputeGraph::Execute(CommandQueue& queue)
+	{
+		if (mIsExecuted)
+		{
+			CL_LOG(Error, "Compute Graph Was Already Executed!");
+			return false;
+		}
+		mIsExecuted = true;
+
+		mPool.BeginFrame();
+
+		const bool bCompiled = Compile();
+		if (!bCompiled)
+		{
+			mPool.EndFrame();
+			return false;
+		}
+
+		auto GetQueue = [&](uint32_t passIndex) -> CommandQueue&
+		{
+			return mPasses[passIndex].Queue ? *mPasses[passIndex].Queue : queue;
+		};
+
+		// Passes with dependents on other queues signal an event once done
+		std::vector<bool> signals(mPasses.size(), false);
+		std::vector<CommandQueue*> sideQueues;
+		for (uint32_t i = 0; i < mPasses.size(); ++i)
+		{
+			if (mPasses[i].bCulled)
+				continue;
+
+			CommandQueue& target = GetQueue(i);
+			for (uint32_t dependency : mPasses[i].Dependencies)
+			{
+				if (&GetQueue(dependency) != &target)
+					signals[dependency] = true;
+			}
+
+			if (&target != &queue && std::find(sideQueues.begin(), sideQueues.end(), &target) == sideQueues.end())
+				sideQueues.push_back(&target);
+		}
+
+		std::vector<cl_event> events(mPasses.size(), nullptr);
+
+		// Other queues start after the work already on the graph's queue, the pooled memory may
+		// still be in use by its previous frame
+		cl_event frameStart = nullptr;
+		if (!sideQueues.empty())
+		{
+			clEnqueueMarkerWithWaitList(queue.Get(), 0, nullptr, &frameStart);
+			clFlush(queue.Get());
+
+			for (CommandQueue* sideQueue : sideQueues)
+				clEnqueueBarrierWithWaitList(sideQueue->Get(), 1, &frameStart, nullptr);
+		}
+
+		mExecutedPassCount = 0;
+		for (uint32_t i = 0; i < mPasses.size(); ++i)
+		{
+			Pass& pass = mPasses[i];
+			if (pass.bCulled)
+				continue;
+
+			CommandQueue& target = GetQueue(i);
+
+			std::vector<cl_event> waits;
+			for (uint32_t dependency : pass.Dependencies)
+			{
+				if (&GetQueue(dependency) != &target && events[dependency])
+					waits.push_back(events[dependency]);
+			}
+
+			if (!waits.empty())
+				clEnqueueBarrierWithWaitList(target.Get(), static_cast<cl_uint>(waits.size()), waits.data(), nullptr);
+
+			if (pass.Execute)
+				pass.Execute(PassContext(*this, i, target));
+
+			if (signals[i])
+			{
+				clEnqueueMarkerWithWaitList(target.Get(), 0, nullptr, &events[i]);
+				clFlush(target.Get());
+			}
+			++mExecutedPassCount;
+		}
+
+		// Join the other queues back so later work on the graph's queue sees their results
+		std::vector<cl_event> joins;
+		for (CommandQueue* sideQueue : sideQueues)
+		{
+			cl_event join = nullptr;
+			clEnqueueMarkerWithWaitList(sideQueue->Get(), 0, nullptr, &join);
+			clFlush(sideQueue->Get());
+			joins.push_back(join);
+		}
+
+		if (!joins.empty())
+			clEnqueueBarrierWithWaitList(queue.Get(), static_cast<cl_uint>(joins.size()), joins.data(), nullptr);
+
+		for (cl_event join : joins)
+			clReleaseEvent(join);
+
+		for (cl_event event : events)
+		{
+			if (event)
+				clReleaseEvent(event);
+		}
+
+		if (frameStart)
+			clReleaseEvent(frameStart);
+
+		mPool.EndFrame();
+		return true;
+	}
+
+	GraphResource ComputeGraph::AddResource(Resource&& resource)
+	{
+		GraphResource handle;
+		handle.Index = static_cast<uint32_t>(mResources.size());
+		mResources.push_back(std::move(resource));
+		return handle;
+	}
+
+	bool ComputeGraph::IsValidResource(GraphResource resource, const char* action) const
+	{
+		if (resource.Index < mResources.size())
+			return true;
+
+		CL_LOG(Error, "Couldn't %s Invalid Graph Resource!", action);
+		return false;
+	}
+
+	void ComputeGraph::CullPasses()
+	{
+		std::vector<bool> needed(mResources.size(), false);
+		for (size_t i = 0; i < mResources.size(); ++i)
+			needed[i] = mResources[i].bImported || mResources[i].bOutput;
+
+		// Walking backwards, a pass is needed if something needed later reads what it writes
+		for (auto itr = mPasses.rbegin(); itr != mPasses.rend(); ++itr)
+		{
+			Pass& pass = *itr;
+
+			bool bNeeded = pass.bNeverCull;
+			for (uint32_t resource : pass.Writes)
+				bNeeded = bNeeded || needed[resource];
+
+			pass.bCulled = !bNeeded;
+			if (!bNeeded)
+				continue;
+
+			for (uint32_t resource : pass.Reads)
+				needed[resource] = true;
+		}
+	}
+
+	bool ComputeGraph::ComputeLifetimes()
+	{
+		std::vector<bool> written(mResources.size(), false);
+
+		for (uint32_t i = 0; i < mPasses.size(); ++i)
+		{
+			const Pass& pass = mPasses[i];
+			if (pass.bCulled)
+				continue;
+
+			for (uint32_t index : pass.Reads)
+			{
+				Resource& resource = mResources[index];
+				if (!resource.bImported && !written[index])
+				{
+					CL_LOG(Error, "Pass %s Reads %s Before It's Written!", pass.Name.c_str(), resource.Name.c_str());
+					return false;
+				}
+			}
+
+			for (uint32_t index : pass.Writes)
+				written[index] = true;
+
+			for (const std::vector<uint32_t>* accesses : { &pass.Reads, &pass.Writes })
+			{
+				for (uint32_t index : *accesses)
+				{
+					Resource& resource = mResources[index];
+					if (resource.FirstPass < 0)
+						resource.FirstPass = static_cast<int32_t>(i);
+					resource.LastPass = static_cast<int32_t>(i);
+				}
+			}
+		}
+		return true;
+	}
+
+	void ComputeGraph::AddDependency(uint32_t pass, int32_t dependency)
+	{
+		if (dependency < 0 || static_cast<uint32_t>(dependency) == pass)
+			return;
+
+		std::vector<uint32_t>& dependencies = mPasses[pass].Dependencies;
+		if (std::find(dependencies.begin(), dependencies.end(), static_cast<uint32_t>(dependency)) == dependencies.end())
+			dependencies.push_back(static_cast<uint32_t>(dependency));
+	}
+
+	bool ComputeGraph::Compile()
+	{
+		CullPasses();
+
+		if (!ComputeLifetimes())
+			return false;
+
+		std::vector<int32_t> lastWriter(mResources.size(), -1);
+		std::vector<std::vector<uint32_t>> readers(mResources.size());
+
+		for (uint32_t i = 0; i < mPasses.size(); ++i)
+		{
+			Pass& pass = mPasses[i];
+			if (pass.bCulled)
+				continue;
+
+			// Transients first used here take storage whose previous users are done
+			for (const std::vector<uint32_t>* accesses : { &pass.Reads, &pass.Writes })
+			{
+				for (uint32_t index : *accesses)
+				{
+					Resource& resource = mResources[index];
+					if (resource.bImported || resource.Memory || resource.FirstPass != static_cast<int32_t>(i))
+						continue;
+
+					const TransientAllocation allocation = mPool.Allocate(resource.Desc, resource.FirstPass, resource.LastPass);
+					if (!allocation.Memory)
+					{
+						CL_LOG(Error, "Couldn't Allocate %s for Pass %s!", resource.Name.c_str(), pass.Name.c_str());
+						return false;
+					}
+
+					resource.Memory = allocation.Memory;
+					AddDependency(i, allocation.PreviousLastPass);
+				}
+			}
+
+			// Read after write
+			for (uint32_t index : pass.Reads)
+				AddDependency(i, lastWriter[index]);
+
+			// Write after write and write after read
+			for (uint32_t index : pass.Writes)
+			{
+				AddDependency(i, lastWriter[index]);
+				for (uint32_t reader : readers[index])
+					AddDependency(i, static_cast<int32_t>(reader));
+			}
+
+			for (uint32_t index : pass.Reads)
+				readers[index].push_back(i);
+
+			for (uint32_t index : pass.Writes)
+			{
+				lastWriter[index] = static_cast<int32_t>(i);
+				readers[index].clear();
+			}
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "Core/CLContext.h"
 
-#include "CLWorksLog.h"
+#include "Core/CLLog.h"
 
 #include <vector>
 #include <cstdlib>
@@ -15,7 +15,22 @@ namespace OpenCL
 	Context::Context(const std::shared_ptr<OpenCL::Device>& device,
 					 const ContextProperties& properties)
 	{
-		Initialize(device->Get(), properties);
+		cl_device_id deviceId = device->Get();
+		Initialize(&deviceId, 1, properties);
+	}
+
+	Context::Context(const std::vector<DevicePtr>& devices,
+					 const ContextProperties& properties)
+	{
+		std::vector<cl_device_id> deviceIds;
+		deviceIds.reserve(devices.size());
+		for (const DevicePtr& device : devices)
+		{
+			if (device && device->Get())
+				deviceIds.push_back(device->Get());
+		}
+
+		Initialize(deviceIds.data(), static_cast<cl_uint>(deviceIds.size()), properties);
 	}
 
 	Context::~Context()
@@ -35,13 +50,13 @@ namespace OpenCL
 		err = clGetSupportedImageFormats(mpContext, mem_flags, CL_MEM_OBJECT_IMAGE2D, 0, NULL, &num_formats);
 		if (err != CL_SUCCESS) 
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Querying Supported Image Formats Count!"));
+			CL_LOG(Error, "Querying Supported Image Formats Count!");
 			return;
 		}
 
 		if (num_formats == 0) 
 		{
-			UE_LOG(LogCLWorks, Log, TEXT("No Supported Image Formats Found."));
+			CL_LOG(Log, "No Supported Image Formats Found.");
 			return;
 		}
 
@@ -52,26 +67,27 @@ namespace OpenCL
 		err = clGetSupportedImageFormats(mpContext, mem_flags, CL_MEM_OBJECT_IMAGE2D, num_formats, formats, NULL);
 		if (err != CL_SUCCESS) 
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Error Retrieving Supported Image Formats: %d"), err);
+			CL_LOG(Error, "Error Retrieving Supported Image Formats: %d", err);
 			free(formats);
 			return;
 		}
 
 		// Print supported formats
-		UE_LOG(LogCLWorks, Log, TEXT("Supported OpenCL Image Formats:"));
+		CL_LOG(Log, "Supported OpenCL Image Formats:");
 		for (cl_uint i = 0; i < num_formats; i++)
 		{
-			UE_LOG(LogCLWorks, Log, TEXT("  [%d] Channel Order = %d, Data Type = %d"), i, 
+			CL_LOG(Log, "  [%d] Channel Order = %d, Data Type = %d", i, 
 																					   formats[i].image_channel_order, 
 																					   formats[i].image_channel_data_type);
 		}
 		free(formats);
 	}
 
-	void Context::Initialize(cl_device_id device, 
+	void Context::Initialize(const cl_device_id* devices,
+							 cl_uint numDevices,
 							 const ContextProperties& properties)
 	{
-		if (device == nullptr)
+		if (numDevices == 0 || devices[0] == nullptr)
 			return;
 
 		cl_int err = 0;
@@ -82,7 +98,7 @@ namespace OpenCL
 		// TODO:: Implement Interop
 		std::vector<cl_context_properties> props;
 
-		mpContext = clCreateContext(props.data(), 1, &device, NULL, NULL, &err);
+		mpContext = clCreateContext(props.data(), numDevices, devices, NULL, NULL, &err);
 		if (err < 0)
 		{
 			perror("Couldn't create a context!");
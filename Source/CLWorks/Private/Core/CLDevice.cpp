@@ -1,77 +1,44 @@
 #include "Core/CLDevice.h"
 
-#include "CLWorksLog.h"
+#include "Core/CLInstrumentation.h"
+#include "Core/CLLog.h"
 
 namespace OpenCL
 {
 	Device::Device(uint32_t deviceIndex,
 				   uint32_t platformIndex)
 	{
-		cl_platform_id platform = nullptr;
-		cl_device_id dev = nullptr;
-		int32_t err = 0;
+		// Enumeration reports out of range indices
+		if (const DeviceDescription* description = DeviceEnumerator::GetDevice(deviceIndex, platformIndex))
+			mpDevice = description->Device;
 
-		// Identify the platforms -----------------------------------------------------------------
-		cl_uint numPlatforms = 0;
-		clGetPlatformIDs(0, nullptr, &numPlatforms);
-		if (numPlatforms == 0) 
-			return;
-
-		if (numPlatforms < platformIndex)
-		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Find Platform with Index: %d"), platformIndex);
-			return;
-		}
-
-		std::vector<cl_platform_id> platforms(numPlatforms, nullptr);
-		err = clGetPlatformIDs(numPlatforms, platforms.data(), NULL);
-		if (err < 0)
-		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Identify a Platform!"));
-			return;
-		}
-
-		platform = platforms[platformIndex];
-		// ----------------------------------------------------------------------------------------
-
-
-		// Access A Device ------------------------------------------------------------------------
-		cl_uint numDevices = 0;
-		clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 0, NULL, &numDevices);
-		if (numDevices == 0)
-		{
-			UE_LOG(LogCLWorks, Warning, TEXT("Couldn't Find a GPU and Falling Back to CPU."));
-
-			err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, 1, &dev, NULL);
-			if (err < 0)
-			{
-				UE_LOG(LogCLWorks, Error, TEXT("Couldn't Access Any Devices!"));
-				return;
-			}
-		}
-
-		if (numDevices < deviceIndex)
-		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Find Device with Index: %d"), deviceIndex);
-			return;
-		}
+		mpCapabilities = DeviceCapabilities::Get(mpDevice);
+	}
 
-		std::vector<cl_device_id> devices(numDevices, nullptr);
-		err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, numDevices, devices.data(), NULL);
-		if (err < 0)
-		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Retrieve Devices!"));
-			return;
-		}
+	Device::Device(const DeviceDescription& description)
+		: mpDevice(description.Device),
+		mpCapabilities(description.Capabilities)
+	{
+	}
 
-		mpDevice = devices[deviceIndex];
-		// ----------------------------------------------------------------------------------------
+	Device::Device(cl_device_id subDevice,
+				   const std::shared_ptr<Device>& parent)
+		: mpDevice(subDevice),
+		mpCapabilities(DeviceCapabilities::Get(subDevice)),
+		mpParent(parent)
+	{
 	}
 
 	Device::~Device()
 	{
 		if (mpDevice)
 		{
+			if (mpParent)
+			{
+				DeviceCapabilities::Evict(mpDevice);
+				Instrumentation::Get().OnDeviceReleased(mpDevice);
+			}
+
 			clReleaseDevice(mpDevice);
 			mpDevice = nullptr;
 		}
@@ -79,11 +46,9 @@ namespace OpenCL
 
 	bool Device::AreImagesSupported() const
 	{
-		cl_bool image_support;
-		clGetDeviceInfo(mpDevice, CL_DEVICE_IMAGE_SUPPORT, sizeof(cl_bool), &image_support, NULL);
-		if (!image_support)
+		if (!mpCapabilities->bImageSupport)
 		{
-			UE_LOG(LogCLWorks, Log, TEXT("OpenCL Device Does Not Support Images!"));
+			CL_LOG(Log, "OpenCL Device Does Not Support Images!");
 			return false;
 		}
 		return true;
@@ -91,29 +56,13 @@ namespace OpenCL
 
 	SVMSupport Device::GetSVMSupported() const
 	{
-		cl_device_svm_capabilities capabilities;
-		clGetDeviceInfo(mpDevice, CL_DEVICE_SVM_CAPABILITIES, sizeof(cl_device_svm_capabilities), &capabilities, NULL);
-
-		bool bHasCoarseGrainSupport = capabilities & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER;
-		bool bHasFineGrainSupport = capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER;
-
-		if (!bHasCoarseGrainSupport && !bHasFineGrainSupport)
-		{
-			UE_LOG(LogCLWorks, Log, TEXT("OpenCL Device Does Not SVM!"));
-			return SVMSupport::None;
-		}
-		return bHasFineGrainSupport ? SVMSupport::Fine : SVMSupport::Coarse;
+		if (mpCapabilities->SVM == SVMSupport::None)
+			CL_LOG(Log, "OpenCL Device Does Not SVM!");
+		return mpCapabilities->SVM;
 	}
 
 	bool Device::IsExtensionSupported(const std::string& extension) const
 	{
-		char extensions[1024];
-		clGetDeviceInfo(mpDevice, CL_DEVICE_EXTENSIONS, sizeof(extensions), extensions, NULL);
-		if (!strstr(extensions, extension.c_str()))
-		{
-			std::string extenstionsionStr = extension;
-			return false;
-		}
-		return true;
+		return mpCapabilities->IsExtensionSupported(extension);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "Core/CLDeviceCapabilities.h"
+
+#include "Core/CLLog.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#ifndef CL_DEVICE_REGISTERS_PER_BLOCK_NV
+#define CL_DEVICE_REGISTERS_PER_BLOCK_NV 0x4002
+#endif
+
+namespace OpenCL
+{
+	namespace
+	{
+		// Current GPUs keep up to 2048 work items and 64K 32-bit registers per compute unit
+		constexpr size_t TypicalGPUResidentWorkItems = 2048;
+		constexpr uint64_t TypicalGPURegisterFileSize = 64 * 1024 * 4;
+
+		std::mutex CapabilitiesLock;
+		std::unordered_map<cl_device_id, DeviceCapabilitiesPtr> Capabilities;
+
+		std::string GetString(cl_device_id device,
+							  cl_device_info param)
+		{
+			size_t size = 0;
+			if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+				return {};
+
+			std::string value(size, '\0');
+			clGetDeviceInfo(device, param, size, value.data(), nullptr);
+			value.resize(size - 1);
+			return value;
+		}
+
+		template<typename T>
+		T GetValue(cl_device_id device,
+				   cl_device_info param)
+		{
+			T value = {};
+			clGetDeviceInfo(device, param, sizeof(T), &value, nullptr);
+			return value;
+		}
+
+		DeviceCapabilitiesPtr Capture(cl_device_id device)
+		{
+			std::shared_ptr<DeviceCapabilities> caps = std::make_shared<DeviceCapabilities>();
+			caps->Device = device;
+			caps->Type = GetValue<cl_device_type>(device, CL_DEVICE_TYPE);
+
+			caps->Name = GetString(device, CL_DEVICE_NAME);
+			caps->Vendor = GetString(device, CL_DEVICE_VENDOR);
+			caps->Version = GetString(device, CL_DEVICE_VERSION);
+			caps->DriverVersion = GetString(device, CL_DRIVER_VERSION);
+
+			std::istringstream extensions(GetString(device, CL_DEVICE_EXTENSIONS));
+			std::string extension;
+			while (extensions >> extension)
+				caps->Extensions.push_back(extension);
+			std::sort(caps->Extensions.begin(), caps->Extensions.end());
+
+			caps->ComputeUnits = GetValue<cl_uint>(device, CL_DEVICE_MAX_COMPUTE_UNITS);
+			caps->ClockMHz = GetValue<cl_uint>(device, CL_DEVICE_MAX_CLOCK_FREQUENCY);
+			caps->MaxWorkItemDimensions = GetValue<cl_uint>(device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS);
+			clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(caps->MaxWorkItemSizes), caps->MaxWorkItemSizes, nullptr);
+			caps->MaxWorkGroupSize = GetValue<size_t>(device, CL_DEVICE_MAX_WORK_GROUP_SIZE);
+			caps->MaxParameterSize = GetValue<size_t>(device, CL_DEVICE_MAX_PARAMETER_SIZE);
+
+			caps->GlobalMemSize = GetValue<cl_ulong>(device, CL_DEVICE_GLOBAL_MEM_SIZE);
+			caps->GlobalMemCacheSize = GetValue<cl_ulong>(device, CL_DEVICE_GLOBAL_MEM_CACHE_SIZE);
+			caps->LocalMemSize = GetValue<cl_ulong>(device, CL_DEVICE_LOCAL_MEM_SIZE);
+			caps->ConstantBufferSize = GetValue<cl_ulong>(device, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE);
+			caps->MaxAllocSize = GetValue<cl_ulong>(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE);
+
+			// CPUs run a group per hardware thread and spill private memory to the stack
+			caps->MaxResidentWorkItems = caps->MaxWorkGroupSize;
+			if (caps->Type & (CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_ACCELERATOR))
+			{
+				caps->MaxResidentWorkItems = std::max(caps->MaxWorkGroupSize, TypicalGPUResidentWorkItems);
+				caps->PrivateMemSize = TypicalGPURegisterFileSize;
+				if (caps->IsExtensionSupported("cl_nv_device_attribute_query"))
+				{
+					if (const cl_uint registers = GetValue<cl_uint>(device, CL_DEVICE_REGISTERS_PER_BLOCK_NV))
+						caps->PrivateMemSize = uint64_t(registers) * 4;
+				}
+			}
+
+			// Reported in bits
+			caps->BaseAddressAlignment = GetValue<cl_uint>(device, CL_DEVICE_MEM_BASE_ADDR_ALIGN) / 8;
+			caps->GlobalMemCacheLineSize = GetValue<cl_uint>(device, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE);
+
+			caps->bImageSupport = GetValue<cl_bool>(device, CL_DEVICE_IMAGE_SUPPORT) == CL_TRUE;
+			if (caps->bImageSupport)
+			{
+				caps->MaxImage2DWidth = GetValue<size_t>(device, CL_DEVICE_IMAGE2D_MAX_WIDTH);
+				caps->MaxImage2DHeight = GetValue<size_t>(device, CL_DEVICE_IMAGE2D_MAX_HEIGHT);
+				caps->MaxImage3DWidth = GetValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_WIDTH);
+				caps->MaxImage3DHeight = GetValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_HEIGHT);
+				caps->MaxImage3DDepth = GetValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_DEPTH);
+				caps->MaxImageArraySize = GetValue<size_t>(device, CL_DEVICE_IMAGE_MAX_ARRAY_SIZE);
+			}
+
+			const cl_device_svm_capabilities svm = GetValue<cl_device_svm_capabilities>(device, CL_DEVICE_SVM_CAPABILITIES);
+			if (svm & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)
+				caps->SVM = SVMSupport::Fine;
+			else if (svm & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+				caps->SVM = SVMSupport::Coarse;
+
+			// Deprecated in 2.0 but still the only portable hint for integrated parts
+			caps->bUnifiedMemory = GetValue<cl_bool>(device, CL_DEVICE_HOST_UNIFIED_MEMORY) == CL_TRUE;
+			caps->bHalfSupport = caps->IsExtensionSupported("cl_khr_fp16");
+			caps->bDoubleSupport = caps->IsExtensionSupported("cl_khr_fp64") || GetValue<cl_device_fp_config>(device, CL_DEVICE_DOUBLE_FP_CONFIG) != 0;
+
+			caps->PreferredVectorWidthChar = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_CHAR);
+			caps->PreferredVectorWidthShort = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_SHORT);
+			caps->PreferredVectorWidthInt = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_INT);
+			caps->PreferredVectorWidthLong = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_LONG);
+			caps->PreferredVectorWidthHalf = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_HALF);
+			caps->PreferredVectorWidthFloat = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT);
+			caps->PreferredVectorWidthDouble = GetValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_DOUBLE);
+
+			caps->PartitionMaxSubDevices = GetValue<cl_uint>(device, CL_DEVICE_PARTITION_MAX_SUB_DEVICES);
+			caps->PartitionAffinityDomains = GetValue<cl_device_affinity_domain>(device, CL_DEVICE_PARTITION_AFFINITY_DOMAIN);
+
+			size_t size = 0;
+			clGetDeviceInfo(device, CL_DEVICE_PARTITION_PROPERTIES, 0, nullptr, &size);
+			if (size >= sizeof(cl_device_partition_property))
+			{
+				caps->PartitionTypes.resize(size / sizeof(cl_device_partition_property));
+				clGetDeviceInfo(device, CL_DEVICE_PARTITION_PROPERTIES, size, caps->PartitionTypes.data(), nullptr);
+
+				// Devices that can't be partitioned report a single zero
+				caps->PartitionTypes.erase(std::remove(caps->PartitionTypes.begin(), caps->PartitionTypes.end(), 0), caps->PartitionTypes.end());
+			}
+
+			return caps;
+		}
+	}
+
+	bool DeviceCapabilities::IsExtensionSupported(const std::string& extension) const
+	{
+		return std::binary_search(Extensions.begin(), Extensions.end(), extension);
+	}
+
+	const std::vector<cl_image_format>& DeviceCapabilities::GetImageFormats() const
+	{
+		std::call_once(mImageFormatsOnce, [this]()
+		{
+			if (!bImageSupport)
+				return;
+
+			// Formats are only queryable through a context
+			cl_int err = 0;
+			cl_context context = clCreateContext(nullptr, 1, &Device, nullptr, nullptr, &err);
+			if (err < 0 || !context)
+			{
+				CL_LOG(Warning, "Couldn't Query Image Formats of %s: %d", Name.c_str(), err);
+				return;
+			}
+
+			cl_uint numFormats = 0;
+			clGetSupportedImageFormats(context, CL_MEM_READ_WRITE, CL_MEM_OBJECT_IMAGE2D, 0, nullptr, &numFormats);
+			if (numFormats > 0)
+			{
+				mImageFormats.resize(numFormats);
+				clGetSupportedImageFormats(context, CL_MEM_READ_WRITE, CL_MEM_OBJECT_IMAGE2D, numFormats, mImageFormats.data(), nullptr);
+			}
+			clReleaseContext(context);
+		});
+		return mImageFormats;
+	}
+
+	bool DeviceCapabilities::IsImageFormatSupported(cl_channel_order order,
+													cl_channel_type type) const
+	{
+		for (const cl_image_format& format : GetImageFormats())
+		{
+			if (format.image_channel_order == order && format.image_channel_data_type == type)
+				return true;
+		}
+		return false;
+	}
+
+	bool DeviceCapabilities::IsPartitionTypeSupported(cl_device_partition_property type) const
+	{
+		return std::find(PartitionTypes.begin(), PartitionTypes.end(), type) != PartitionTypes.end();
+	}
+
+	DeviceCapabilitiesPtr DeviceCapabilities::Get(cl_device_id device)
+	{
+		static const DeviceCapabilitiesPtr Empty = std::make_shared<const DeviceCapabilities>();
+		if (!device)
+			return Empty;
+
+		{
+			std::lock_guard<std::mutex> lock(CapabilitiesLock);
+			auto found = Capabilities.find(device);
+			if (found != Capabilities.end())
+				return found->second;
+		}
+
+		// Captured outside the lock, the first one stored wins a race
+		DeviceCapabilitiesPtr caps = Capture(device);
+
+		std::lock_guard<std::mutex> lock(CapabilitiesLock);
+		return Capabilities.emplace(device, std::move(caps)).first->second;
+	}
+
+	void DeviceCapabilities::Evict(cl_device_id device)
+	{
+		std::lock_guard<std::mutex> lock(CapabilitiesLock);
+		Capabilities.erase(device);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "Core/CLDeviceEnumerator.h"
+
+#include "Core/CLLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace OpenCL
+{
+	namespace
+	{
+		std::mutex EnumerationLock;
+		std::vector<DeviceDescription> Devices;
+		std::atomic<bool> bEnumerated = false;
+
+		std::string GetPlatformString(cl_platform_id platform,
+									  cl_platform_info param)
+		{
+			size_t size = 0;
+			if (clGetPlatformInfo(platform, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+				return {};
+
+			std::string value(size, '\0');
+			clGetPlatformInfo(platform, param, size, value.data(), nullptr);
+			value.resize(size - 1);
+			return value;
+		}
+
+		DeviceDescription Describe(cl_platform_id platform,
+								   uint32_t platformIndex,
+								   cl_device_id device,
+								   uint32_t deviceIndex)
+		{
+			DeviceDescription desc;
+			desc.PlatformIndex = platformIndex;
+			desc.DeviceIndex = deviceIndex;
+			desc.Platform = platform;
+			desc.Device = device;
+
+			desc.PlatformName = GetPlatformString(platform, CL_PLATFORM_NAME);
+			desc.Capabilities = DeviceCapabilities::Get(device);
+
+			return desc;
+		}
+
+		void Enumerate()
+		{
+			Devices.clear();
+
+			cl_uint numPlatforms = 0;
+			clGetPlatformIDs(0, nullptr, &numPlatforms);
+			if (numPlatforms == 0)
+			{
+				CL_LOG(Warning, "No OpenCL Platforms Found.");
+				return;
+			}
+
+			std::vector<cl_platform_id> platforms(numPlatforms, nullptr);
+			if (clGetPlatformIDs(numPlatforms, platforms.data(), nullptr) < 0)
+			{
+				CL_LOG(Error, "Couldn't Identify a Platform!");
+				return;
+			}
+
+			for (uint32_t platformIndex = 0; platformIndex < numPlatforms; ++platformIndex)
+			{
+				cl_platform_id platform = platforms[platformIndex];
+
+				// Devices are indexed among the GPUs, and among the CPUs on platforms without a GPU
+				for (cl_device_type type : { CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_CPU, CL_DEVICE_TYPE_ACCELERATOR })
+				{
+					cl_uint numDevices = 0;
+					if (clGetDeviceIDs(platform, type, 0, nullptr, &numDevices) < 0 || numDevices == 0)
+						continue;
+
+					std::vector<cl_device_id> devices(numDevices, nullptr);
+					if (clGetDeviceIDs(platform, type, numDevices, devices.data(), nullptr) < 0)
+					{
+						CL_LOG(Error, "Couldn't Retrieve Devices!");
+						continue;
+					}
+
+					for (uint32_t deviceIndex = 0; deviceIndex < numDevices; ++deviceIndex)
+						Devices.push_back(Describe(platform, platformIndex, devices[deviceIndex], deviceIndex));
+				}
+			}
+		}
+	}
+
+	const std::vector<DeviceDescription>& DeviceEnumerator::GetDevices()
+	{
+		std::lock_guard<std::mutex> lock(EnumerationLock);
+		if (!bEnumerated)
+		{
+			Enumerate();
+			bEnumerated = true;
+		}
+		return Devices;
+	}
+
+	bool DeviceEnumerator::IsEnumerated()
+	{
+		return bEnumerated.load(std::memory_order_acquire);
+	}
+
+	const DeviceDescription* DeviceEnumerator::GetDevice(uint32_t deviceIndex,
+														 uint32_t platformIndex)
+	{
+		const std::vector<DeviceDescription>& devices = GetDevices();
+
+		bool bPlatformFound = false;
+		bool bHasGPU = false;
+		for (const DeviceDescription& desc : devices)
+		{
+			if (desc.PlatformIndex != platformIndex)
+				continue;
+
+			bPlatformFound = true;
+			bHasGPU |= desc.IsGPU();
+		}
+
+		if (!bPlatformFound)
+		{
+			CL_LOG(Error, "Couldn't Find Platform with Index: %d", platformIndex);
+			return nullptr;
+		}
+
+		if (!bHasGPU)
+			CL_LOG(Warning, "Couldn't Find a GPU and Falling Back to CPU.");
+
+		const cl_device_type type = bHasGPU ? CL_DEVICE_TYPE_GPU : CL_DEVICE_TYPE_CPU;
+		for (const DeviceDescription& desc : devices)
+		{
+			if (desc.PlatformIndex == platformIndex && (desc.Capabilities->Type & type) && desc.DeviceIndex == deviceIndex)
+				return &desc;
+		}
+
+		CL_LOG(Error, "Couldn't Find Device with Index: %d", deviceIndex);
+		return nullptr;
+	}
+
+	const DeviceDescription* DeviceEnumerator::FindDevice(const std::string& nameFragment)
+	{
+		for (const DeviceDescription& desc : GetDevices())
+		{
+			if (desc.Capabilities->Name.find(nameFragment) != std::string::npos)
+				return &desc;
+		}
+		return nullptr;
+	}
+
+	double DeviceEnumerator::Score(const DeviceDescription& device,
+								   DeviceWorkload workload)
+	{
+		const DeviceCapabilities& caps = device.GetCapabilities();
+		if (workload == DeviceWorkload::Image && !caps.bImageSupport)
+			return 0.0;
+
+		// Lanes per compute unit aren't queryable, approximate them by device type
+		double lanes = 1.0;
+		if (device.IsGPU())
+			lanes = 64.0;
+		else if (caps.Type & CL_DEVICE_TYPE_ACCELERATOR)
+			lanes = 32.0;
+		else
+			lanes = std::max(caps.PreferredVectorWidthFloat, 1u);
+
+		const double throughput = double(caps.ComputeUnits) * double(std::max(caps.ClockMHz, 1u)) * lanes;
+
+		switch (workload)
+		{
+			case DeviceWorkload::Compute:
+				return throughput;
+			case DeviceWorkload::Memory:
+				// Dedicated memory outruns anything behind the host's bus
+				return (device.IsDiscrete() ? 4.0 : 1.0) * throughput;
+			case DeviceWorkload::HostShared:
+				// Transfers dominate small dispatches, zero-copy beats raw throughput
+				return (caps.bUnifiedMemory ? 8.0 : 1.0) * throughput;
+			case DeviceWorkload::Image:
+			case DeviceWorkload::General:
+			default:
+				return (device.IsDiscrete() ? 2.0 : 1.0) * throughput;
+		}
+	}
+
+	const DeviceDescription* DeviceEnumerator::SelectBest(DeviceWorkload workload,
+														  cl_device_type typeMask)
+	{
+		const DeviceDescription* best = nullptr;
+		double bestScore = 0.0;
+
+		// Devices are ordered by platform and index, so strict comparison keeps the first on ties
+		for (const DeviceDescription& desc : GetDevices())
+		{
+			if ((desc.Capabilities->Type & typeMask) == 0)
+				continue;
+
+			const double score = Score(desc, workload);
+			if (score > bestScore)
+			{
+				best = &desc;
+				bestScore = score;
+			}
+		}
+		return best;
+	}
+
+	void DeviceEnumerator::Dump()
+	{
+		const std::vector<DeviceDescription>& devices = GetDevices();
+		CL_LOG(Log, "OpenCL Devices: %d", static_cast<int32_t>(devices.size()));
+
+		for (const DeviceDescription& desc : devices)
+		{
+			const DeviceCapabilities& caps = desc.GetCapabilities();
+			const char* type = desc.IsGPU() ? (desc.IsDiscrete() ? "Discrete GPU" : "Integrated GPU") : desc.IsCPU() ? "CPU" : "Accelerator";
+
+			CL_LOG(Log, "  [Platform %u, Device %u] %s (%s) - %s", desc.PlatformIndex,
+																	desc.DeviceIndex,
+																	caps.Name.c_str(),
+																	desc.PlatformName.c_str(),
+																	type);
+			CL_LOG(Log, "    %u CUs @ %u MHz, %.2f GB Global, %llu KB Local, Images: %s, SVM: %s",
+				   caps.ComputeUnits,
+				   caps.ClockMHz,
+				   double(caps.GlobalMemSize) / double(1ull << 30),
+				   static_cast<unsigned long long>(caps.LocalMemSize / 1024),
+				   caps.bImageSupport ? "Yes" : "No",
+				   caps.SVM == SVMSupport::Fine ? "Fine" : caps.SVM == SVMSupport::Coarse ? "Coarse" : "None");
+			CL_LOG(Log, "    Scores - General: %.0f, Compute: %.0f, Memory: %.0f, Image: %.0f, HostShared: %.0f",
+				   Score(desc, DeviceWorkload::General),
+				   Score(desc, DeviceWorkload::Compute),
+				   Score(desc, DeviceWorkload::Memory),
+				   Score(desc, DeviceWorkload::Image),
+				   Score(desc, DeviceWorkload::HostShared));
+		}
+	}
+}
\ No newline at end of file
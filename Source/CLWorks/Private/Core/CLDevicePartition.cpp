@@ -0,0 +1,107 @@
+#include "Core/CLDevicePartition.h"
+
+#include "Core/CLLog.h"
+
+namespace OpenCL
+{
+	namespace
+	{
+		std::vector<DevicePtr> CreateSubDevices(const DevicePtr& parent,
+												const std::vector<cl_device_partition_property>& properties)
+		{
+			if (!parent || !parent->Get())
+				return {};
+
+			if (!parent->GetCapabilities().IsPartitionTypeSupported(properties[0]))
+			{
+				CL_LOG(Warning, "Device Doesn't Support Partition Type: 0x%x", static_cast<uint32_t>(properties[0]));
+				return {};
+			}
+
+			cl_uint numDevices = 0;
+			cl_int err = clCreateSubDevices(parent->Get(), properties.data(), 0, nullptr, &numDevices);
+			if (err < 0 || numDevices == 0)
+			{
+				CL_LOG(Error, "Couldn't Partition Device: %d", err);
+				return {};
+			}
+
+			std::vector<cl_device_id> subDevices(numDevices, nullptr);
+			err = clCreateSubDevices(parent->Get(), properties.data(), numDevices, subDevices.data(), nullptr);
+			if (err < 0)
+			{
+				CL_LOG(Error, "Couldn't Create Sub-Devices: %d", err);
+				return {};
+			}
+
+			std::vector<DevicePtr> devices;
+			devices.reserve(numDevices);
+			for (cl_device_id subDevice : subDevices)
+				devices.push_back(std::make_shared<Device>(subDevice, parent));
+			return devices;
+		}
+	}
+
+	std::vector<DevicePtr> CreateSubDevicesEqually(const DevicePtr& parent,
+												   uint32_t computeUnits)
+	{
+		return CreateSubDevices(parent,
+		{
+			CL_DEVICE_PARTITION_EQUALLY,
+			static_cast<cl_device_partition_property>(computeUnits),
+			0
+		});
+	}
+
+	std::vector<DevicePtr> CreateSubDevicesByCounts(const DevicePtr& parent,
+													const std::vector<uint32_t>& computeUnits)
+	{
+		std::vector<cl_device_partition_property> properties = { CL_DEVICE_PARTITION_BY_COUNTS };
+		for (uint32_t count : computeUnits)
+			properties.push_back(static_cast<cl_device_partition_property>(count));
+
+		properties.push_back(CL_DEVICE_PARTITION_BY_COUNTS_LIST_END);
+		properties.push_back(0);
+
+		return CreateSubDevices(parent, properties);
+	}
+
+	std::vector<DevicePtr> CreateSubDevicesByAffinity(const DevicePtr& parent,
+													  cl_device_affinity_domain domain)
+	{
+		if (parent && (parent->GetCapabilities().PartitionAffinityDomains & domain) == 0)
+		{
+			CL_LOG(Warning, "Device Doesn't Support Affinity Domain: 0x%x", static_cast<uint32_t>(domain));
+			return {};
+		}
+
+		return CreateSubDevices(parent,
+		{
+			CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN,
+			static_cast<cl_device_partition_property>(domain),
+			0
+		});
+	}
+
+	std::vector<DevicePartition> MakePartitions(const std::vector<DevicePtr>& subDevices)
+	{
+		std::vector<DevicePartition> partitions;
+		partitions.reserve(subDevices.size());
+
+		for (const DevicePtr& device : subDevices)
+		{
+			DevicePartition partition;
+			partition.Device = device;
+			partition.Context = MakeContext(device);
+			if (!partition.Context->Get())
+			{
+				CL_LOG(Error, "Couldn't Create Partition Context!");
+				continue;
+			}
+
+			partition.Queue = std::make_shared<CommandQueue>(partition.Context, device);
+			partitions.push_back(std::move(partition));
+		}
+		return partitions;
+	}
+}
\ No newline at end of file
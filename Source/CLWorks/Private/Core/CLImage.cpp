@@ -4,6 +4,10 @@
 
 #include "Core/CLCommandQueue.h"
 
+#include "Core/CLInstrumentation.h"
+
+#include "Utils/BlockCompressor.h"
+#include "Utils/FormatConverter.h"
 #include "Utils/MipGenerator.h"
 
 #include "Engine/Texture2D.h"
@@ -13,6 +17,7 @@
 
 #include "RHICommandList.h"
 #include "Render/UTextureUtils.h"
+#include "Render/CLTexturePool.h"
 #include "TextureResource.h"
 
 namespace OpenCL
@@ -35,9 +40,10 @@ namespace OpenCL
 		mHeight(height),
 		mDepthOrLayer(depthOrLayer)
 	{
-		if (device->AreImagesSupported())
+		const DeviceCapabilities& caps = device->GetCapabilities();
+		if (caps.bImageSupport)
 		{
-			if ((format & Format::HalfFloat) > 0 && !device->IsExtensionSupported("cl_khr_fp16"))
+			if ((format & Format::HalfFloat) > 0 && !caps.bHalfSupport)
 				return;
 
 			mpImage = CreateCLImage();
@@ -104,21 +110,23 @@ namespace OpenCL
 		if (!ReadFromCL(queue, &pixelData))
 			return nullptr;
 
-		const size_t dataSize = GetDataSize();
+		FCLTexturePoolKey key;
+		key.Width = mWidth;
+		key.Height = mHeight;
+		key.PixelFormat = pixelFormat;
+		key.NumMips = GetMipCount(genMips);
+		key.bSRGB = isSRGB;
 
-		UTexture2D* texture = NewObject<UTexture2D>(GetTransientPackage(),
-												    NAME_None,
-												    RF_Transient);
-		texture->SRGB = isSRGB;
+		bool isRecycled = false;
+		UTexture2D* texture = FCLTexturePool::Acquire(key, isRecycled);
+		if (!texture)
+		{
+			delete[] static_cast<uint8_t*>(pixelData);
+			return nullptr;
+		}
 
-		FTexturePlatformData* platformData = new FTexturePlatformData();
-		texture->SetPlatformData(platformData);
-		platformData->SizeX = mWidth;
-		platformData->SizeY = mHeight;
-		platformData->SetNumSlices(1);
-		platformData->PixelFormat = pixelFormat;
-		
-		if (async)
+		// Recycled textures already own a matching resource, update its regions in place.
+		if (async || isRecycled)
 		{
 			WriteToUTexture2D_Async(texture, pixelData, genMips, maxBytesPerUpload);
 		}
@@ -130,6 +138,125 @@ namespace OpenCL
 		return texture;
 	}
 
+	TObjectPtr<UTexture2D> Image::CreateCompressedUTexture2D(const OpenCL::CommandQueue& queue,
+															 Compression compression,
+															 bool isSRGB)
+	{
+		if (mType != Type::Texture2D)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Mismatching Image Type: %d"), mType);
+			return nullptr;
+		}
+
+		if (!mpImage)
+			return nullptr;
+
+		const EPixelFormat pixelFormat = Utils::CompressionToPixelFormat(compression);
+		if (pixelFormat == EPixelFormat::PF_Unknown)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Texture Compression: %d!"), compression);
+			return nullptr;
+		}
+
+		// Integer images can't be sampled as normalized floats by the encoder
+		if ((mFormat & (Format::UInt | Format::SInt)) > 0)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Compression Unsupported for Image Format: %d!"), mFormat);
+			return nullptr;
+		}
+
+		if (mWidth % 4 != 0 || mHeight % 4 != 0)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Compressed Texture Size Must Be a Multiple of 4: %d x %d!"), mWidth, mHeight);
+			return nullptr;
+		}
+
+		const std::shared_ptr<Context> context_ptr = mpContext.lock();
+		const std::shared_ptr<Device> device_ptr = mpDevice.lock();
+		if (!context_ptr || !device_ptr)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Image Context or Device!"));
+			return nullptr;
+		}
+
+		// Only floating point images hold linear color, 8-bit images are stored already encoded
+		const bool isFloatingPoint = (mFormat & (Format::HalfFloat | Format::Float)) > 0;
+
+		std::vector<uint8_t> blocks;
+		if (!BlockCompressor::Compress(blocks, context_ptr, device_ptr, queue, mpImage, mWidth, mHeight, compression, isSRGB && isFloatingPoint))
+			return nullptr;
+
+		FCLTexturePoolKey key;
+		key.Width = mWidth;
+		key.Height = mHeight;
+		key.PixelFormat = pixelFormat;
+		key.NumMips = 1;
+		key.bSRGB = isSRGB;
+
+		bool isRecycled = false;
+		UTexture2D* texture = FCLTexturePool::Acquire(key, isRecycled);
+		if (!texture)
+			return nullptr;
+
+		const size_t blockBytes = BlockCompressor::GetBlockBytes(compression);
+
+		uint8_t* srcData = new uint8_t[blocks.size()];
+		FMemory::Memcpy(srcData, blocks.data(), blocks.size());
+
+		WriteRawToUTexture2D(texture, srcData, blocks.size(), (mWidth / 4) * blockBytes, blockBytes, isRecycled);
+
+		return texture;
+	}
+
+	TObjectPtr<UTexture2D> Image::CreateConvertedUTexture2D(const OpenCL::CommandQueue& queue,
+															EPixelFormat pixelFormat,
+															bool isSRGB)
+	{
+		if (mType != Type::Texture2D)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Mismatching Image Type: %d"), mType);
+			return nullptr;
+		}
+
+		if (!mpImage)
+			return nullptr;
+
+		if (!CanConvertTo(pixelFormat))
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Unsupported Conversion from Image Format: %d to Texture Format: %d!"), mFormat, pixelFormat);
+			return nullptr;
+		}
+
+		const size_t bytesPerPixel = GPixelFormats[pixelFormat].BlockBytes;
+		const size_t dataSize = GetPixelCount() * bytesPerPixel;
+
+		uint8_t* pixelData = new uint8_t[dataSize];
+		if (!FetchConverted(queue, pixelFormat, isSRGB, pixelData))
+		{
+			delete[] pixelData;
+			return nullptr;
+		}
+
+		FCLTexturePoolKey key;
+		key.Width = mWidth;
+		key.Height = mHeight;
+		key.PixelFormat = pixelFormat;
+		key.NumMips = 1;
+		key.bSRGB = isSRGB;
+
+		bool isRecycled = false;
+		UTexture2D* texture = FCLTexturePool::Acquire(key, isRecycled);
+		if (!texture)
+		{
+			delete[] pixelData;
+			return nullptr;
+		}
+
+		WriteRawToUTexture2D(texture, pixelData, dataSize, mWidth * bytesPerPixel, bytesPerPixel, isRecycled);
+
+		return texture;
+	}
+
 	TObjectPtr<UTexture2DArray> Image::CreateUTexture2DArray(const OpenCL::CommandQueue& queue,
 															 bool isSRGB,
 															 bool genMips)
@@ -242,8 +369,30 @@ namespace OpenCL
 			return false;
 		}
 
+		const EPixelFormat pixelFormat = Utils::FormatToPixelFormat(mFormat);
+		const EPixelFormat outputFormat = output->GetFormat();
+
 		const size_t internal_dataSize = GetDataSize();
-		const size_t output_dataSize = output_width * output_height * GPixelFormats[output->GetFormat()].BlockBytes;
+		const size_t output_dataSize = output_width * output_height * GPixelFormats[outputFormat].BlockBytes;
+		if (internal_dataSize != output_dataSize && CanConvertTo(outputFormat))
+		{
+			// Convert on the device so only the render target's bytes are read back, formats of
+			// matching size keep going through the staging texture below.
+			const size_t bytesPerPixel = GPixelFormats[outputFormat].BlockBytes;
+
+			uint8_t* convertedData = new uint8_t[GetPixelCount() * bytesPerPixel];
+			if (!FetchConverted(queue, outputFormat, output->IsSRGB(), convertedData))
+			{
+				delete[] convertedData;
+				return false;
+			}
+
+			return UTextureUtils::WriteToRenderTarget(convertedData,
+													  mWidth * bytesPerPixel,
+													  output,
+													  onUploadComplete);
+		}
+
 		if (internal_dataSize != output_dataSize)
 		{
 			UE_LOG(LogCLWorks, Warning, TEXT("Mismatched Texture Format - Input Data Size: %d to Output Data Size: %d!"), internal_dataSize, output_dataSize);
@@ -254,15 +403,54 @@ namespace OpenCL
 		if (!ReadFromCL(queue, &pixelData))
 			return false;
 
+		if (pixelFormat == outputFormat)
+		{
+			// Matching formats, write the host pixels straight into the render target.
+			return UTextureUtils::WriteToRenderTarget(pixelData,
+													  mWidth * GetChannelDataSize(),
+													  output,
+													  onUploadComplete);
+		}
+
+		// Format conversion is required, stage through a pooled Texture2D and blit.
+		FCLTexturePoolKey key;
+		key.Width = mWidth;
+		key.Height = mHeight;
+		key.PixelFormat = pixelFormat;
+		key.NumMips = 1;
+		key.bSRGB = false;
+
+		bool isRecycled = false;
+		UTexture2D* texture = FCLTexturePool::Acquire(key, isRecycled);
+		if (!texture)
+		{
+			delete[] static_cast<uint8_t*>(pixelData);
+			return false;
+		}
+
+		if (isRecycled)
+			WriteToUTexture2D_Async(texture, pixelData, false, 64 * 2048);
+		else
+			WriteToUTexture2D(texture, pixelData, false);
 
-		// Create temporary Texture2D
-		TObjectPtr<UTexture2D> texture = CreateUTexture2D(queue, genMips);
+		// Keep the staging texture alive until the blit has executed
+		texture->AddToRoot();
 
+		const bool blitted = UTextureUtils::BlitTextureToRenderTarget(texture, output, FIntPoint::ZeroValue, [texture, onUploadComplete]()
+		{
+			texture->RemoveFromRoot();
+			FCLTexturePool::Release(texture);
 
-		// Blit Texture2D to RenderTarget2D
-		UTextureUtils::BlitTextureToRenderTarget(texture, output, FIntPoint::ZeroValue, onUploadComplete);
+			if (onUploadComplete)
+				onUploadComplete();
+		});
 
-		return true;
+		if (!blitted)
+		{
+			texture->RemoveFromRoot();
+			FCLTexturePool::Release(texture);
+		}
+		return blitted;
 	}
 
 	bool Image::UploadToUTexture2DArray(TObjectPtr<UTexture2DArray> output,
@@ -321,6 +509,31 @@ namespace OpenCL
 		return ReadFromCL(queue, &output, isBlocking);
 	}
 
+	bool Image::FetchConverted(const OpenCL::CommandQueue& queue,
+							   EPixelFormat pixelFormat,
+							   bool encodeSRGB,
+							   void* output) const
+	{
+		if (mType != Type::Texture2D || !CanConvertTo(pixelFormat))
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Unsupported Conversion from Image Format: %d to Texture Format: %d!"), mFormat, pixelFormat);
+			return false;
+		}
+
+		const std::shared_ptr<Context> context_ptr = mpContext.lock();
+		const std::shared_ptr<Device> device_ptr = mpDevice.lock();
+		if (!context_ptr || !device_ptr)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Image Context or Device!"));
+			return false;
+		}
+
+		// Only floating point images hold linear color, 8-bit images are stored already encoded
+		const bool isFloatingPoint = (mFormat & (Format::HalfFloat | Format::Float)) > 0;
+
+		return FormatConverter::Convert(output, context_ptr, device_ptr, queue, mpImage, mWidth, mHeight, pixelFormat, encodeSRGB && isFloatingPoint);
+	}
+
 	cl_mem Image::CreateCLImage()
 	{
 		const std::shared_ptr<Context> context_ptr = mpContext.lock();
@@ -496,6 +709,7 @@ namespace OpenCL
 		}
 
 		int32_t err = 0;
+		cl_event event = nullptr;
 		if (queue.Get())
 		{
 			err = clEnqueueReadImage(queue,
@@ -508,7 +722,10 @@ namespace OpenCL
 									 data,
 									 0, 
 									 nullptr, 
-									 nullptr);
+									 queue.IsProfiling() ? &event : nullptr);
+
+			if (err >= 0 && queue.IsProfiling())
+				Instrumentation::Get().OnTransferEnqueued(queue, event, TransferDirection::Readback, TransferCommand::Read, GetDataSize());
 		}
 		else
 		{
@@ -523,7 +740,10 @@ namespace OpenCL
 									 data,
 									 0,
 									 nullptr, 
-									 nullptr);
+									 localqueue.IsProfiling() ? &event : nullptr);
+
+			if (err >= 0 && localqueue.IsProfiling())
+				Instrumentation::Get().OnTransferEnqueued(localqueue, event, TransferDirection::Readback, TransferCommand::Read, GetDataSize());
 		}
 
 		if (err < 0)
@@ -534,6 +754,75 @@ namespace OpenCL
 		return true;
 	}
 
+	uint32_t Image::GetMipCount(bool genMips) const
+	{
+		if (!genMips)
+			return 1;
+
+		// Mirrors the reduction performed by the MipGenerator
+		uint32_t mipCount = 1;
+		size_t currentWidth = mWidth;
+		size_t currentHeight = mHeight;
+		while (currentWidth > 1 || currentHeight > 1)
+		{
+			currentWidth = std::max(static_cast<size_t>(1), static_cast<size_t>(std::roundf(currentWidth * 0.5f)));
+			currentHeight = std::max(static_cast<size_t>(1), static_cast<size_t>(std::roundf(currentHeight * 0.5f)));
+			++mipCount;
+		}
+		return mipCount;
+	}
+
+	bool Image::CanConvertTo(EPixelFormat pixelFormat) const
+	{
+		// Integer images can't be read as normalized floats by the conversion kernels
+		if (!mpImage || (mFormat & (Format::UInt | Format::SInt)) > 0)
+			return false;
+
+		return FormatConverter::IsSupported(pixelFormat);
+	}
+
+	void Image::WriteRawToUTexture2D(UTexture2D* texture,
+									 uint8_t* src,
+									 size_t dataSize,
+									 uint32_t rowPitch,
+									 uint32_t bytesPerBlock,
+									 bool isRecycled)
+	{
+		if (isRecycled)
+		{
+			// Single region upload, block compressed rows aren't addressable individually
+			FUpdateTextureRegion2D* region = new FUpdateTextureRegion2D(0, 0, 0, 0, mWidth, mHeight);
+			texture->UpdateTextureRegions(0,
+										  1,
+										  region,
+										  rowPitch,
+										  bytesPerBlock,
+										  src, [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+										  {
+												delete[] SrcData;
+												delete Regions;
+										  });
+			return;
+		}
+
+		FTexturePlatformData* platformData = texture->GetPlatformData();
+		FTexture2DMipMap* mip = new FTexture2DMipMap();
+		platformData->Mips.Add(mip);
+
+		mip->SizeX = mWidth;
+		mip->SizeY = mHeight;
+		mip->SizeZ = 1;
+
+		mip->BulkData.Lock(LOCK_READ_WRITE);
+		void* DestImageData = mip->BulkData.Realloc(dataSize);
+		FMemory::Memcpy(DestImageData, src, dataSize);
+		mip->BulkData.Unlock();
+
+		delete[] src;
+
+		texture->UpdateResource();
+	}
+
 	bool Image::GenerateMips2D(std::vector<Mip>& output,
 							   void* src)
 	{
@@ -546,7 +835,7 @@ namespace OpenCL
 		else if ((mFormat & Format::SInt) > 0)
 			MipGenerator::GenerateMipsInt32(output, static_cast<int32_t*>(src), mWidth, mHeight, mDepthOrLayer, channelCount);
 		else if ((mFormat & Format::HalfFloat) > 0)
-			MipGenerator::GenerateMipsFloat16(output, static_cast<FFloat16*>(src), mWidth, mHeight, mDepthOrLayer, channelCount);
+			MipGenerator::GenerateMipsFloat16(output, static_cast<uint16_t*>(src), mWidth, mHeight, mDepthOrLayer, channelCount);
 		else if ((mFormat & Format::Float) > 0)
 			MipGenerator::GenerateMipsFloat(output, static_cast<float*>(src), mWidth, mHeight, mDepthOrLayer, channelCount);
 		else
@@ -0,0 +1,65 @@
+#include "Core/CLInstrumentation.h"
+
+#include <atomic>
+
+namespace OpenCL
+{
+	static Instrumentation DefaultInstrumentation;
+	static std::atomic<Instrumentation*> InstalledInstrumentation = nullptr;
+
+	const size_t* Instrumentation::SelectLocalSize(const CommandQueue&,
+												   const Kernel&,
+												   size_t,
+												   const size_t*,
+												   size_t*,
+												   std::shared_ptr<void>&)
+	{
+		return nullptr;
+	}
+
+	void Instrumentation::OnDispatchRejected(const std::shared_ptr<void>&)
+	{
+	}
+
+	void Instrumentation::OnKernelEnqueued(const CommandQueue&,
+										   const Kernel&,
+										   cl_event event,
+										   size_t,
+										   const size_t*,
+										   const size_t*,
+										   const std::shared_ptr<void>&)
+	{
+		if (event)
+			clReleaseEvent(event);
+	}
+
+	void Instrumentation::OnTransferEnqueued(const CommandQueue&,
+											 cl_event event,
+											 TransferDirection,
+											 TransferCommand,
+											 uint64_t,
+											 MemoryStrategy)
+	{
+		if (event)
+			clReleaseEvent(event);
+	}
+
+	void Instrumentation::OnQueueReleased(const CommandQueue&)
+	{
+	}
+
+	void Instrumentation::OnDeviceReleased(cl_device_id)
+	{
+	}
+
+	Instrumentation& Instrumentation::Get()
+	{
+		Instrumentation* instrumentation = InstalledInstrumentation.load(std::memory_order_acquire);
+		return instrumentation ? *instrumentation : DefaultInstrumentation;
+	}
+
+	void Instrumentation::Set(Instrumentation* instrumentation)
+	{
+		InstalledInstrumentation.store(instrumentation, std::memory_order_release);
+	}
+}
@@ -1,9 +1,69 @@
 #include "Core/CLKernel.h"
 
-#include "CLWorksLog.h"
+#include "Core/CLLog.h"
+
+#include <cstring>
 
 namespace OpenCL
 {
+	namespace
+	{
+		// Size of a scalar or vector type as named by clGetKernelArgInfo, zero if unknown
+		size_t GetTypeSize(std::string typeName)
+		{
+			if (typeName.rfind("unsigned ", 0) == 0)
+				typeName = "u" + typeName.substr(9);
+
+			static const std::pair<const char*, size_t> Scalars[] =
+			{
+				{ "char", 1 }, { "uchar", 1 },
+				{ "short", 2 }, { "ushort", 2 },
+				{ "int", 4 }, { "uint", 4 },
+				{ "long", 8 }, { "ulong", 8 },
+				{ "half", 2 }, { "float", 4 }, { "double", 8 },
+			};
+
+			for (const auto& [name, size] : Scalars)
+			{
+				const size_t length = std::strlen(name);
+				if (typeName.compare(0, length, name) != 0)
+					continue;
+
+				const std::string width = typeName.substr(length);
+				if (width.empty())
+					return size;
+
+				// Three component vectors are padded to four
+				if (width == "3")
+					return size * 4;
+
+				if (width == "2" || width == "4" || width == "8" || width == "16")
+					return size * std::stoul(width);
+			}
+			return 0;
+		}
+
+		size_t GetArgumentSize(const Kernel::ArgumentInfo& arg)
+		{
+			if (arg.AddressQualifier == CL_KERNEL_ARG_ADDRESS_LOCAL)
+				return 0;
+
+			// Buffers, images and pipes are bound by their memory object
+			if (arg.AddressQualifier == CL_KERNEL_ARG_ADDRESS_GLOBAL ||
+				arg.AddressQualifier == CL_KERNEL_ARG_ADDRESS_CONSTANT ||
+				arg.TypeName.rfind("image", 0) == 0 ||
+				arg.TypeName.rfind("pipe", 0) == 0)
+			{
+				return sizeof(cl_mem);
+			}
+
+			if (arg.TypeName == "sampler_t")
+				return sizeof(cl_sampler);
+
+			return GetTypeSize(arg.TypeName);
+		}
+	}
+
 	Kernel::Kernel()
 		: mpKernel(nullptr),
 		mIsValid(false)
@@ -16,6 +76,10 @@ namespace OpenCL
 		mIsValid(true)
 	{
 		Initialize(program.Get(), kernalName);
+
+		const DevicePtr device_ptr = program.GetDevicePtr();
+		if (mIsValid && device_ptr)
+			QueryInfo(device_ptr->Get(), program.GetSourceHash());
 	}
 
 	Kernel::~Kernel()
@@ -27,21 +91,189 @@ namespace OpenCL
 		}
 	}
 
+	int32_t Kernel::GetArgumentIndex(const std::string& name) const
+	{
+		if (!mpInfo)
+			return -1;
+
+		for (size_t i = 0; i < mpInfo->Arguments.size(); ++i)
+		{
+			if (mpInfo->Arguments[i].Name == name)
+				return static_cast<int32_t>(i);
+		}
+		return -1;
+	}
+
 	bool Kernel::SetArgument(cl_uint arg_index, size_t arg_size, const void* arg_value)
 	{
 		if (!mIsValid)
 			return false;
 
-		cl_int err = clSetKernelArg(mpKernel, arg_index, arg_size, arg_value);
-		if (err < 0)
+		if (arg_index >= mArguments.size())
+		{
+			CL_LOG(Error, "Couldn't Create Kernel Argument!: %d", CL_INVALID_ARG_INDEX);
+			mIsValid = false;
+			return false;
+		}
+
+		// Caught here rather than at the flush so the failing call is the one reporting it
+		const size_t expectedSize = mpInfo && arg_index < mpInfo->Arguments.size() ? mpInfo->Arguments[arg_index].Size : 0;
+		if (arg_value && expectedSize != 0 && arg_size != expectedSize)
+		{
+			CL_LOG(Error, "Couldn't Create Kernel Argument!: %d", CL_INVALID_ARG_SIZE);
+			mIsValid = false;
+			return false;
+		}
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(arg_value);
+		const size_t byteCount = arg_value ? arg_size : 0;
+
+		ArgumentValue& cached = mArguments[arg_index];
+		if (cached.bSet && !cached.bSVM && cached.Size == arg_size && cached.Bytes.size() == byteCount &&
+			(byteCount == 0 || std::memcmp(cached.Bytes.data(), bytes, byteCount) == 0))
+		{
+			return true;
+		}
+
+		cached.Bytes.assign(bytes, bytes + byteCount);
+		cached.Size = arg_size;
+		cached.bSVM = false;
+		cached.bSet = true;
+		cached.bDirty = true;
+		++mArgumentVersion;
+		return true;
+	}
+
+	bool Kernel::SetArgumentSVMPointer(cl_uint arg_index, const void* pointer)
+	{
+		if (!mIsValid)
+			return false;
+
+		if (arg_index >= mArguments.size())
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Create Kernel Argument!: %d"), err);
+			CL_LOG(Error, "Couldn't Create Kernel Argument!: %d", CL_INVALID_ARG_INDEX);
 			mIsValid = false;
 			return false;
 		}
+
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pointer);
+
+		ArgumentValue& cached = mArguments[arg_index];
+		if (cached.bSet && cached.bSVM && std::memcmp(cached.Bytes.data(), bytes, sizeof(pointer)) == 0)
+			return true;
+
+		cached.Bytes.assign(bytes, bytes + sizeof(pointer));
+		cached.Size = sizeof(pointer);
+		cached.bSVM = true;
+		cached.bSet = true;
+		cached.bDirty = true;
+		++mArgumentVersion;
 		return true;
 	}
 
+	bool Kernel::FlushArguments() const
+	{
+		if (!mIsValid)
+			return false;
+
+		for (cl_uint i = 0; i < static_cast<cl_uint>(mArguments.size()); ++i)
+		{
+			ArgumentValue& arg = mArguments[i];
+			if (!arg.bDirty)
+				continue;
+
+			cl_int err = 0;
+			if (arg.bSVM)
+			{
+				const void* pointer = nullptr;
+				std::memcpy(&pointer, arg.Bytes.data(), sizeof(pointer));
+				err = clSetKernelArgSVMPointer(mpKernel, i, pointer);
+			}
+			else
+			{
+				err = clSetKernelArg(mpKernel, i, arg.Size, arg.Bytes.empty() ? nullptr : arg.Bytes.data());
+			}
+
+			if (err < 0)
+			{
+				CL_LOG(Error, "Couldn't Create Kernel Argument!: %d", err);
+				return false;
+			}
+			arg.bDirty = false;
+		}
+		return true;
+	}
+
+	void Kernel::MarkArgumentDirty(cl_uint arg_index) const
+	{
+		if (arg_index < mArguments.size() && mArguments[arg_index].bSet)
+			mArguments[arg_index].bDirty = true;
+	}
+
+	bool Kernel::IsArgumentDirty(cl_uint arg_index) const
+	{
+		return arg_index < mArguments.size() && mArguments[arg_index].bDirty;
+	}
+
+	bool Kernel::GetArgumentValue(cl_uint arg_index,
+								  const void*& value,
+								  size_t& size,
+								  bool& bSVM) const
+	{
+		if (arg_index >= mArguments.size() || !mArguments[arg_index].bSet)
+			return false;
+
+		const ArgumentValue& arg = mArguments[arg_index];
+		bSVM = arg.bSVM;
+		size = arg.Size;
+
+		if (arg.bSVM)
+			std::memcpy(&value, arg.Bytes.data(), sizeof(value));
+		else
+			value = arg.Bytes.empty() ? nullptr : arg.Bytes.data();
+		return true;
+	}
+
+	bool Kernel::FindLocalSize(cl_device_id device,
+							   uint32_t sizeClass,
+							   size_t* output) const
+	{
+		for (const CachedLocalSize& cached : mLocalSizes)
+		{
+			if (cached.Device == device && cached.SizeClass == sizeClass)
+			{
+				std::memcpy(output, cached.Size, sizeof(cached.Size));
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Kernel::CacheLocalSize(cl_device_id device,
+								uint32_t sizeClass,
+								const size_t* localSize) const
+	{
+		for (CachedLocalSize& cached : mLocalSizes)
+		{
+			if (cached.Device == device && cached.SizeClass == sizeClass)
+			{
+				std::memcpy(cached.Size, localSize, sizeof(cached.Size));
+				return;
+			}
+		}
+
+		CachedLocalSize& cached = mLocalSizes.emplace_back();
+		cached.Device = device;
+		cached.SizeClass = sizeClass;
+		std::memcpy(cached.Size, localSize, sizeof(cached.Size));
+	}
+
+	bool Kernel::ReportUnknownArgument(const std::string& name)
+	{
+		CL_LOG(Error, "Couldn't Find Kernel Argument: %s", name.c_str());
+		return false;
+	}
+
 	void Kernel::Initialize(cl_program program,
 							const std::string& kernalName)
 	{
@@ -50,9 +282,63 @@ namespace OpenCL
 		cl_kernel kernel = clCreateKernel(program, kernalName.c_str(), &err);
 		if (err < 0)
 		{
-			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Create A Kernel!: %d"), err);
+			CL_LOG(Error, "Couldn't Create A Kernel!: %d", err);
 			mIsValid = false;
 		}
 		mpKernel = kernel;
+
+		if (mIsValid)
+		{
+			cl_uint numArgs = 0;
+			clGetKernelInfo(mpKernel, CL_KERNEL_NUM_ARGS, sizeof(numArgs), &numArgs, nullptr);
+			mArguments.resize(numArgs);
+		}
+	}
+
+	void Kernel::QueryInfo(cl_device_id device,
+						   uint64_t programHash)
+	{
+		std::shared_ptr<KernelInfo> info = std::make_shared<KernelInfo>();
+		info->Name = mName;
+		info->ProgramHash = programHash;
+
+		clGetKernelWorkGroupInfo(mpKernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(info->WorkGroupSize), &info->WorkGroupSize, nullptr);
+		clGetKernelWorkGroupInfo(mpKernel, device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(info->PreferredWorkGroupMultiple), &info->PreferredWorkGroupMultiple, nullptr);
+		clGetKernelWorkGroupInfo(mpKernel, device, CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(info->CompileWorkGroupSize), &info->CompileWorkGroupSize, nullptr);
+		clGetKernelWorkGroupInfo(mpKernel, device, CL_KERNEL_PRIVATE_MEM_SIZE, sizeof(info->PrivateMemSize), &info->PrivateMemSize, nullptr);
+		clGetKernelWorkGroupInfo(mpKernel, device, CL_KERNEL_LOCAL_MEM_SIZE, sizeof(info->LocalMemSize), &info->LocalMemSize, nullptr);
+
+		cl_uint numArgs = 0;
+		clGetKernelInfo(mpKernel, CL_KERNEL_NUM_ARGS, sizeof(numArgs), &numArgs, nullptr);
+
+		info->Arguments.resize(numArgs);
+		for (cl_uint i = 0; i < numArgs; ++i)
+		{
+			ArgumentInfo& arg = info->Arguments[i];
+
+			clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_ADDRESS_QUALIFIER, sizeof(arg.AddressQualifier), &arg.AddressQualifier, nullptr);
+			clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_ACCESS_QUALIFIER, sizeof(arg.AccessQualifier), &arg.AccessQualifier, nullptr);
+			clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_TYPE_QUALIFIER, sizeof(arg.TypeQualifier), &arg.TypeQualifier, nullptr);
+
+			size_t nameSize = 0;
+			if (clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_NAME, 0, nullptr, &nameSize) == CL_SUCCESS && nameSize > 0)
+			{
+				arg.Name.resize(nameSize);
+				clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_NAME, nameSize, arg.Name.data(), nullptr);
+				arg.Name.resize(nameSize - 1);
+			}
+
+			size_t typeSize = 0;
+			if (clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_TYPE_NAME, 0, nullptr, &typeSize) == CL_SUCCESS && typeSize > 0)
+			{
+				arg.TypeName.resize(typeSize);
+				clGetKernelArgInfo(mpKernel, i, CL_KERNEL_ARG_TYPE_NAME, typeSize, arg.TypeName.data(), nullptr);
+				arg.TypeName.resize(typeSize - 1);
+			}
+
+			arg.Size = GetArgumentSize(arg);
+		}
+
+		mpInfo = std::move(info);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "Core/CLLog.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#if CLWORKS_WITH_UNREAL
+	#include "CLWorksLog.h"
+#endif
+
+namespace OpenCL
+{
+	static std::mutex SinkMutex;
+	static LogSink Sink;
+
+	static void DefaultSink(LogLevel level, 
+							const char* message)
+	{
+	#if CLWORKS_WITH_UNREAL
+		switch (level)
+		{
+			case LogLevel::Verbose:
+				UE_LOG(LogCLWorks, Verbose, TEXT("%s"), UTF8_TO_TCHAR(message));
+				break;
+			case LogLevel::Log:
+				UE_LOG(LogCLWorks, Log, TEXT("%s"), UTF8_TO_TCHAR(message));
+				break;
+			case LogLevel::Warning:
+				UE_LOG(LogCLWorks, Warning, TEXT("%s"), UTF8_TO_TCHAR(message));
+				break;
+			case LogLevel::Error:
+				UE_LOG(LogCLWorks, Error, TEXT("%s"), UTF8_TO_TCHAR(message));
+				break;
+		}
+	#else
+		static const char* LevelNames[] = { "Verbose", "Log", "Warning", "Error" };
+		std::fprintf(stderr, "CLWorks %s: %s\n", LevelNames[static_cast<uint8_t>(level)], message);
+	#endif
+	}
+
+	void SetLogSink(LogSink sink)
+	{
+		const std::scoped_lock lock(SinkMutex);
+		Sink = std::move(sink);
+	}
+
+	void LogMessage(LogLevel level, 
+					const char* format, 
+					...)
+	{
+		va_list args;
+		va_start(args, format);
+
+		va_list sizeArgs;
+		va_copy(sizeArgs, args);
+		const int length = std::vsnprintf(nullptr, 0, format, sizeArgs);
+		va_end(sizeArgs);
+
+		std::vector<char> message(length > 0 ? length + 1 : 1, '\0');
+		if (length > 0)
+			std::vsnprintf(message.data(), message.size(), format, args);
+		va_end(args);
+
+		const std::scoped_lock lock(SinkMutex);
+		if (Sink)
+			Sink(level, message.data());
+		else
+			DefaultSink(level, message.data());
+	}
+}
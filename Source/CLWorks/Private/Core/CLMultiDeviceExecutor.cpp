@@ -0,0 +1,340 @@
+#include "Core/CLMultiDeviceExecutor.h"
+
+#include "Core/CLDeviceEnumerator.h"
+#include "Core/CLInstrumentation.h"
+#include "Core/CLLog.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace OpenCL
+{
+	namespace
+	{
+		// Every device keeps a sliver of the range so its throughput keeps being measured
+		constexpr double MinimumShare = 0.02;
+
+		double GetInitialThroughput(const DevicePtr& device)
+		{
+			for (const DeviceDescription& desc : DeviceEnumerator::GetDevices())
+			{
+				if (desc.Device == device->Get())
+					return DeviceEnumerator::Score(desc, DeviceWorkload::Compute);
+			}
+
+			// Sub-devices aren't enumerated
+			const DeviceCapabilities& caps = device->GetCapabilities();
+			return double(std::max(caps.ComputeUnits, 1u)) * double(std::max(caps.ClockMHz, 1u));
+		}
+	}
+
+	MultiDeviceExecutor::MultiDeviceExecutor(const ContextPtr& context,
+											 const std::vector<DevicePtr>& devices)
+		: mpContext(context)
+	{
+		if (!context || !context->Get())
+		{
+			CL_LOG(Error, "Multi-Device Executor Requires a Valid Context!");
+			return;
+		}
+
+		for (const DevicePtr& device : devices)
+		{
+			if (!device || !device->Get())
+				continue;
+
+			// Timings of the split come from the devices' own profiling
+			DeviceState state;
+			state.Device = device;
+			state.Queue = std::make_unique<CommandQueue>(context, device, true);
+			state.Seed = GetInitialThroughput(device);
+
+			if (!state.Queue->IsValid())
+			{
+				CL_LOG(Error, "Couldn't Create Queue for Multi-Device Executor!");
+				continue;
+			}
+			mDevices.push_back(std::move(state));
+		}
+	}
+
+	MultiDeviceExecutor::~MultiDeviceExecutor()
+	{
+		WaitForFinish();
+	}
+
+	double MultiDeviceExecutor::GetSplitRatio(size_t deviceIndex) const
+	{
+		// Measured and estimated throughputs aren't comparable, only use measurements once all have one
+		const bool bMeasured = std::all_of(mDevices.begin(), mDevices.end(), [](const DeviceState& state) { return state.Throughput > 0.0; });
+
+		double total = 0.0;
+		for (const DeviceState& state : mDevices)
+			total += bMeasured ? state.Throughput : state.Seed;
+
+		if (total <= 0.0)
+			return 1.0 / mDevices.size();
+
+		const DeviceState& state = mDevices[deviceIndex];
+		return (bMeasured ? state.Throughput : state.Seed) / total;
+	}
+
+	void MultiDeviceExecutor::SetSplitRatios(const std::vector<double>& ratios)
+	{
+		for (size_t i = 0; i < mDevices.size() && i < ratios.size(); ++i)
+		{
+			mDevices[i].Seed = std::max(ratios[i], 0.0);
+			mDevices[i].Throughput = 0.0;
+		}
+	}
+
+	bool MultiDeviceExecutor::EnqueueRange(Kernel& kernel,
+										   size_t work_dim,
+										   const size_t* global_work_size,
+										   const size_t* local_work_size,
+										   const std::vector<PartitionedArgument>& partitioned)
+	{
+		if (!IsValid() || work_dim == 0 || work_dim > 3)
+			return false;
+
+		if (!kernel.FlushArguments())
+			return false;
+
+		const size_t splitDim = work_dim - 1;
+		const size_t total = global_work_size[splitDim];
+		const size_t granularity = GetGranularity(work_dim, local_work_size, partitioned);
+
+		// Slice boundaries from the clamped ratios in whole granules, the last one may be partial
+		std::vector<double> shares(mDevices.size());
+		double shareTotal = 0.0;
+		for (size_t i = 0; i < mDevices.size(); ++i)
+		{
+			shares[i] = std::max(GetSplitRatio(i), MinimumShare);
+			shareTotal += shares[i];
+		}
+
+		const size_t granules = (total + granularity - 1) / granularity;
+
+		// Every device gets a granule when the range allows so it's timed and its ratio updates,
+		// the remaining granules are split by the shares
+		const size_t reserved = granules >= mDevices.size() ? 1 : 0;
+		const size_t distributed = granules - reserved * mDevices.size();
+
+		std::vector<size_t> bounds(mDevices.size() + 1, 0);
+		double cumulative = 0.0;
+		for (size_t i = 0; i + 1 < mDevices.size(); ++i)
+		{
+			cumulative += shares[i] / shareTotal;
+			const size_t granule = (i + 1) * reserved + std::min(static_cast<size_t>(cumulative * distributed), distributed);
+			bounds[i + 1] = std::min(std::max(granule * granularity, bounds[i]), total);
+		}
+		bounds[mDevices.size()] = total;
+
+		Instrumentation& instrumentation = Instrumentation::Get();
+
+		bool bSuccess = true;
+		for (size_t i = 0; i < mDevices.size(); ++i)
+		{
+			const size_t begin = bounds[i];
+			const size_t count = bounds[i + 1] - begin;
+			if (count == 0)
+				continue;
+
+			DeviceState& state = mDevices[i];
+			cl_command_queue queue = state.Queue->Get();
+
+			size_t offset[3] = {};
+			size_t global[3] = {};
+			std::copy(global_work_size, global_work_size + work_dim, global);
+			offset[splitDim] = begin;
+			global[splitDim] = count;
+
+			PendingPart part;
+			part.DeviceIndex = i;
+			part.WorkItems = count;
+			for (size_t d = 0; d < work_dim; ++d)
+			{
+				if (d != splitDim)
+					part.WorkItems *= global[d];
+			}
+
+			// Bind this device's slices -----------------------------------------------------------
+			// A slice that can't be bound would leave the kernel on the previous device's slice
+			// or the whole buffer, the device's part is skipped instead
+			bool bBound = true;
+			std::vector<cl_mem> subBuffers;
+			std::vector<const void*> svmPointers;
+			std::vector<size_t> svmSizes;
+			for (const PartitionedArgument& arg : partitioned)
+			{
+				const size_t origin = begin * arg.BytesPerSlice;
+				const size_t size = std::min(count * arg.BytesPerSlice, arg.Buffer->Size() - std::min(origin, arg.Buffer->Size()));
+				if (size == 0)
+				{
+					CL_LOG(Error, "Partitioned Argument %u Is Too Small for Device %d's Slice!", arg.ArgIndex, static_cast<int32_t>(i));
+					bBound = false;
+					break;
+				}
+
+				if (arg.Buffer->IsSVM())
+				{
+					const void* pointer = static_cast<const uint8_t*>(arg.Buffer->GetSVMPointer()) + origin;
+					cl_int err = clSetKernelArgSVMPointer(kernel.Get(), arg.ArgIndex, pointer);
+					if (err < 0)
+					{
+						CL_LOG(Error, "Couldn't Bind SVM Slice for Argument %u: %d", arg.ArgIndex, err);
+						bBound = false;
+						break;
+					}
+
+					svmPointers.push_back(pointer);
+					svmSizes.push_back(size);
+					continue;
+				}
+
+				cl_buffer_region region = { origin, size };
+				cl_int err = 0;
+				cl_mem subBuffer = clCreateSubBuffer(arg.Buffer->Get(), 0, CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
+				if (err < 0)
+				{
+					CL_LOG(Error, "Couldn't Create Sub-Buffer for Argument %u: %d", arg.ArgIndex, err);
+					bBound = false;
+					break;
+				}
+				subBuffers.push_back(subBuffer);
+
+				err = clSetKernelArg(kernel.Get(), arg.ArgIndex, sizeof(cl_mem), &subBuffer);
+				if (err < 0)
+				{
+					CL_LOG(Error, "Couldn't Bind Sub-Buffer for Argument %u: %d", arg.ArgIndex, err);
+					bBound = false;
+					break;
+				}
+			}
+
+			if (!bBound)
+			{
+				for (cl_mem subBuffer : subBuffers)
+					clReleaseMemObject(subBuffer);
+				bSuccess = false;
+				continue;
+			}
+			// -------------------------------------------------------------------------------------
+
+			// Move the slices next to the device before it runs
+			if (!subBuffers.empty())
+				clEnqueueMigrateMemObjects(queue, static_cast<cl_uint>(subBuffers.size()), subBuffers.data(), 0, 0, nullptr, &part.FirstEvent);
+
+			if (!svmPointers.empty())
+			{
+				cl_event svmEvent = nullptr;
+				clEnqueueSVMMigrateMem(queue, static_cast<cl_uint>(svmPointers.size()), svmPointers.data(), svmSizes.data(), 0, 0, nullptr, &svmEvent);
+
+				if (!part.FirstEvent)
+					part.FirstEvent = svmEvent;
+				else if (svmEvent)
+					clReleaseEvent(svmEvent);
+			}
+
+			cl_int err = clEnqueueNDRangeKernel(queue,
+												kernel.Get(),
+												static_cast<cl_uint>(work_dim),
+												offset,
+												global,
+												local_work_size,
+												0,
+												nullptr,
+												&part.KernelEvent);
+
+			// Enqueued commands hold their own references
+			for (cl_mem subBuffer : subBuffers)
+				clReleaseMemObject(subBuffer);
+
+			if (err < 0)
+			{
+				CL_LOG(Error, "Couldn't Enqueue the Kernel on Device %d: %d", static_cast<int32_t>(i), err);
+				if (part.FirstEvent)
+					clReleaseEvent(part.FirstEvent);
+				bSuccess = false;
+				continue;
+			}
+
+			clRetainEvent(part.KernelEvent);
+			instrumentation.OnKernelEnqueued(*state.Queue, kernel, part.KernelEvent, work_dim, global, local_work_size, nullptr);
+
+			if (!part.FirstEvent)
+			{
+				clRetainEvent(part.KernelEvent);
+				part.FirstEvent = part.KernelEvent;
+			}
+			mPending.push_back(part);
+		}
+
+		// Leave the kernel bound to the whole buffers for regular dispatches, rebinding them on
+		// the next flush since the slices were bound behind the argument cache's back
+		for (const PartitionedArgument& arg : partitioned)
+		{
+			kernel.SetArgument(arg.ArgIndex, *arg.Buffer);
+			kernel.MarkArgumentDirty(arg.ArgIndex);
+		}
+
+		for (const DeviceState& state : mDevices)
+			clFlush(state.Queue->Get());
+
+		return bSuccess;
+	}
+
+	void MultiDeviceExecutor::WaitForFinish()
+	{
+		for (const DeviceState& state : mDevices)
+			state.Queue->WaitForFinish();
+
+		for (const PendingPart& part : mPending)
+		{
+			UpdateThroughput(part);
+
+			clReleaseEvent(part.FirstEvent);
+			clReleaseEvent(part.KernelEvent);
+		}
+		mPending.clear();
+	}
+
+	size_t MultiDeviceExecutor::GetGranularity(size_t work_dim,
+											   const size_t* local_work_size,
+											   const std::vector<PartitionedArgument>& partitioned) const
+	{
+		size_t granularity = local_work_size ? std::max<size_t>(local_work_size[work_dim - 1], 1) : 1;
+
+		// Sub-buffer origins must meet the strictest base address alignment of the context's devices
+		size_t alignment = 1;
+		for (const DeviceState& state : mDevices)
+			alignment = std::max<size_t>(alignment, state.Device->GetCapabilities().BaseAddressAlignment);
+
+		for (const PartitionedArgument& arg : partitioned)
+		{
+			if (arg.Buffer->IsSVM() || arg.BytesPerSlice == 0)
+				continue;
+
+			const size_t slices = alignment / std::gcd(alignment, arg.BytesPerSlice);
+			granularity = std::lcm(granularity, slices);
+		}
+		return granularity;
+	}
+
+	void MultiDeviceExecutor::UpdateThroughput(const PendingPart& part)
+	{
+		cl_ulong start = 0;
+		cl_ulong end = 0;
+		if (clGetEventProfilingInfo(part.FirstEvent, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start, nullptr) != CL_SUCCESS ||
+			clGetEventProfilingInfo(part.KernelEvent, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end, nullptr) != CL_SUCCESS ||
+			end <= start)
+		{
+			return;
+		}
+
+		const double measured = part.WorkItems / ((end - start) * 1e-9);
+
+		DeviceState& state = mDevices[part.DeviceIndex];
+		state.Throughput = state.Throughput > 0.0 ? mSmoothing * measured + (1.0 - mSmoothing) * state.Throughput : measured;
+	}
+}
\ No newline at end of file
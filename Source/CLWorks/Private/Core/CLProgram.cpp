@@ -1,12 +1,30 @@
 #include "Core/CLProgram.h"
 
-#include "CLWorksLog.h"
+#include "Core/CLLog.h"
 
 #include <sstream>
+#include <cstring>
 #include <fstream>
 
 namespace OpenCL
 {
+	namespace
+	{
+		// Keep argument names and types queryable for the kernel info
+		constexpr const char* BuildOptions = "-cl-kernel-arg-info";
+
+		// FNV-1a, persisted keys need the same hash on every run and platform
+		uint64_t HashBytes(const char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= static_cast<uint8_t>(data[i]);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+	}
+
 	Program::Program()
 		: mpProgram(nullptr),
 		mpContext(),
@@ -31,6 +49,12 @@ namespace OpenCL
 		}
 	}
 
+	uint64_t Program::HashSource(const std::string& source)
+	{
+		const uint64_t hash = HashBytes(source.data(), source.size());
+		return HashBytes(BuildOptions, std::strlen(BuildOptions), hash);
+	}
+
 	bool Program::ReadFromFile(const std::filesystem::path& file,
 							   std::string* errMsg)
 	{
@@ -63,14 +87,14 @@ namespace OpenCL
 		const std::shared_ptr<Context> context_ptr = mpContext.lock();
 		if (!context_ptr)
 		{
-			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Program Context!"));
+			CL_LOG(Warning, "Invalid Program Context!");
 			return false;
 		}
 
 		const std::shared_ptr<Device> device_ptr = mpDevice.lock();
 		if (!device_ptr)
 		{
-			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Program Device!"));
+			CL_LOG(Warning, "Invalid Program Device!");
 			return false;
 		}
 
@@ -96,12 +120,12 @@ namespace OpenCL
 			if (errMsg)
 				*errMsg = "Couldn't Create the Program!";
 			else
-				UE_LOG(LogCLWorks, Error, TEXT("Couldn't Create the Program!"));
+				CL_LOG(Error, "Couldn't Create the Program!");
 			return false;
 		}
 		free(program_buffer);
 
-		err = clBuildProgram(program, 0, NULL, NULL, NULL, NULL);
+		err = clBuildProgram(program, 0, NULL, BuildOptions, NULL, NULL);
 		if (err < 0) 
 		{
 			/* Find size of log and print to std output */
@@ -128,7 +152,7 @@ namespace OpenCL
 			}
 			else
 			{
-				UE_LOG(LogCLWorks, Error, TEXT("Program Error: %s"), *FString(program_log));
+				CL_LOG(Error, "Program Error: %s", program_log);
 			}
 
 			free(program_log);
@@ -136,6 +160,7 @@ namespace OpenCL
 		}
 
 		mpProgram = program;
+		mSourceHash = HashSource(programString);
 		return true;
 	}
 
@@ -148,7 +173,7 @@ namespace OpenCL
 			if (errMsg)
 				*errMsg = "File Couldn't Be Found At: " + file.string();
 			else
-				UE_LOG(LogCLWorks, Error, TEXT("File Couldn't Be Found At: %s"), *FString(file.c_str()));
+				CL_LOG(Error, "File Couldn't Be Found At: %s", file.string().c_str());
 			return "";
 		}
 
@@ -161,7 +186,7 @@ namespace OpenCL
 			if (errMsg)
 				*errMsg = "Could Not Open File: " + file.string();
 			else
-				UE_LOG(LogCLWorks, Error, TEXT("Could Not Open File: %s"), *FString(file.c_str()));
+				CL_LOG(Error, "Could Not Open File: %s", file.string().c_str());
 			return "";
 		}
 
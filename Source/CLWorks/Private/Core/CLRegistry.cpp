@@ -0,0 +1,203 @@
+#include "Core/CLRegistry.h"
+
+#include "Core/CLLog.h"
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace OpenCL
+{
+	namespace
+	{
+		struct SharedDevice
+		{
+			DevicePtr mpDevice;
+			ContextPtr mpContext;
+		};
+
+		struct CachedQueue
+		{
+			std::weak_ptr<Context> mpContext;
+			std::shared_ptr<CommandQueue> mpQueue;
+		};
+
+		struct CachedProgram
+		{
+			std::weak_ptr<Context> mpContext;
+			std::shared_ptr<Program> mpProgram;
+		};
+
+		std::mutex RegistryMutex;
+		std::map<cl_device_id, SharedDevice> Devices;
+		std::map<std::tuple<cl_context, cl_device_id, std::thread::id>, CachedQueue> Queues;
+		// Keyed by name and source hash, a name reused with another source compiles that source
+		std::map<std::tuple<cl_context, cl_device_id, std::string, uint64_t>, CachedProgram> Programs;
+
+		// Drops entries of destroyed contexts, their handles may be reused
+		template<typename MapType>
+		void PruneExpired(MapType& map)
+		{
+			for (auto itr = map.begin(); itr != map.end();)
+			{
+				if (itr->second.mpContext.expired())
+					itr = map.erase(itr);
+				else
+					++itr;
+			}
+		}
+
+		SharedDevice& FindOrAddDevice(const DevicePtr& device)
+		{
+			SharedDevice& shared = Devices[device->Get()];
+			if (!shared.mpDevice)
+				shared.mpDevice = device;
+			return shared;
+		}
+
+		// Drops a thread's queues once it exits, constructed on the thread's first queue request
+		struct ThreadQueues
+		{
+			~ThreadQueues()
+			{
+				const std::thread::id thread = std::this_thread::get_id();
+
+				// Released outside the lock, a queue may be waited on while released
+				std::vector<std::shared_ptr<CommandQueue>> released;
+				{
+					const std::scoped_lock lock(RegistryMutex);
+					for (auto itr = Queues.begin(); itr != Queues.end();)
+					{
+						if (std::get<2>(itr->first) == thread)
+						{
+							released.push_back(std::move(itr->second.mpQueue));
+							itr = Queues.erase(itr);
+						}
+						else
+						{
+							++itr;
+						}
+					}
+				}
+			}
+		};
+	}
+
+	DevicePtr Registry::GetDevice(uint32_t deviceIndex,
+								  uint32_t platformIndex)
+	{
+		const DeviceDescription* description = DeviceEnumerator::GetDevice(deviceIndex, platformIndex);
+		if (!description)
+			return nullptr;
+
+		const std::scoped_lock lock(RegistryMutex);
+
+		SharedDevice& shared = Devices[description->Device];
+		if (!shared.mpDevice)
+			shared.mpDevice = std::make_shared<Device>(*description);
+		return shared.mpDevice;
+	}
+
+	ContextPtr Registry::GetContext(const DevicePtr& device)
+	{
+		if (!device || !device->Get())
+			return nullptr;
+
+		const std::scoped_lock lock(RegistryMutex);
+
+		SharedDevice& shared = FindOrAddDevice(device);
+		if (!shared.mpContext)
+		{
+			shared.mpContext = MakeContext(shared.mpDevice);
+			if (!shared.mpContext->Get())
+			{
+				CL_LOG(Error, "Couldn't Create Shared Context!");
+				shared.mpContext.reset();
+			}
+		}
+		return shared.mpContext;
+	}
+
+	std::shared_ptr<CommandQueue> Registry::GetQueue(const DevicePtr& device)
+	{
+		return GetQueue(GetContext(device), device);
+	}
+
+	std::shared_ptr<CommandQueue> Registry::GetQueue(const ContextPtr& context,
+													 const DevicePtr& device)
+	{
+		if (!context || !device)
+			return nullptr;
+
+		static thread_local ThreadQueues threadQueues;
+
+		const std::scoped_lock lock(RegistryMutex);
+
+		PruneExpired(Queues);
+
+		const auto key = std::make_tuple(context->Get(), device->Get(), std::this_thread::get_id());
+
+		auto found = Queues.find(key);
+		if (found != Queues.end())
+			return found->second.mpQueue;
+
+		std::shared_ptr<CommandQueue> queue = std::make_shared<CommandQueue>(context, device);
+		if (!queue->IsValid())
+			return nullptr;
+
+		Queues.emplace(key, CachedQueue{ context, queue });
+		return queue;
+	}
+
+	std::shared_ptr<Program> Registry::GetProgram(const std::string& name,
+												  const char* source,
+												  const ContextPtr& context,
+												  const DevicePtr& device,
+												  std::string* errMsg)
+	{
+		if (!context || !device)
+			return nullptr;
+
+		const std::string programSource(source ? source : "");
+		const auto key = std::make_tuple(context->Get(), device->Get(), name, Program::HashSource(programSource));
+
+		{
+			const std::scoped_lock lock(RegistryMutex);
+
+			PruneExpired(Programs);
+
+			auto found = Programs.find(key);
+			if (found != Programs.end())
+				return found->second.mpProgram;
+		}
+
+		// Compiled outside the lock, the first one stored wins a race
+		std::shared_ptr<Program> program = std::make_shared<Program>(context, device);
+		if (!program->ReadFromString(programSource, errMsg))
+			return nullptr;
+
+		const std::scoped_lock lock(RegistryMutex);
+		return Programs.emplace(key, CachedProgram{ context, program }).first->second.mpProgram;
+	}
+
+	void Registry::ReleaseQueues()
+	{
+		// Released outside the lock, a queue may be waited on while released
+		std::map<std::tuple<cl_context, cl_device_id, std::thread::id>, CachedQueue> released;
+		{
+			const std::scoped_lock lock(RegistryMutex);
+			released.swap(Queues);
+		}
+	}
+
+	void Registry::Reset()
+	{
+		const std::scoped_lock lock(RegistryMutex);
+
+		Programs.clear();
+		Queues.clear();
+		Devices.clear();
+	}
+}
\ No newline at end of file
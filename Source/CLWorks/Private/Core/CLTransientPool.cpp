@@ -0,0 +1,176 @@
+#include "Core/CLTransientPool.h"
+
+#include "Core/CLLog.h"
+
+#include <algorithm>
+
+namespace OpenCL
+{
+	namespace
+	{
+		size_t GetChannelCount(cl_channel_order order)
+		{
+			switch (order)
+			{
+			case CL_R:
+			case CL_A:
+				return 1;
+			case CL_RG:
+				return 2;
+			default:
+				return 4;
+			}
+		}
+
+		size_t GetChannelSize(cl_channel_type type)
+		{
+			switch (type)
+			{
+			case CL_UNORM_INT8:
+			case CL_SNORM_INT8:
+			case CL_SIGNED_INT8:
+			case CL_UNSIGNED_INT8:
+				return 1;
+			case CL_HALF_FLOAT:
+			case CL_UNORM_INT16:
+			case CL_SNORM_INT16:
+			case CL_SIGNED_INT16:
+			case CL_UNSIGNED_INT16:
+				return 2;
+			default:
+				return 4;
+			}
+		}
+	}
+
+	bool TransientDesc::CanHold(const TransientDesc& other) const
+	{
+		if (Kind != other.Kind)
+			return false;
+
+		if (Kind == Type::Buffer)
+			return Size >= other.Size;
+
+		return Width == other.Width &&
+			   Height == other.Height &&
+			   Format.image_channel_order == other.Format.image_channel_order &&
+			   Format.image_channel_data_type == other.Format.image_channel_data_type;
+	}
+
+	size_t TransientDesc::GetBytes() const
+	{
+		if (Kind == Type::Buffer)
+			return Size;
+		return Width * Height * GetChannelCount(Format.image_channel_order) * GetChannelSize(Format.image_channel_data_type);
+	}
+
+	TransientPool::TransientPool(const ContextPtr& context)
+		: mpContext(context)
+	{
+	}
+
+	TransientPool::~TransientPool()
+	{
+		Clear();
+	}
+
+	void TransientPool::BeginFrame()
+	{
+		++mFrame;
+		for (Allocation& allocation : mAllocations)
+			allocation.BusyUntilPass = -1;
+	}
+
+	TransientAllocation TransientPool::Allocate(const TransientDesc& desc,
+												uint32_t firstPass,
+												uint32_t lastPass)
+	{
+		// Best fit among the allocations free by the first pass
+		Allocation* best = nullptr;
+		for (Allocation& allocation : mAllocations)
+		{
+			if (allocation.BusyUntilPass >= static_cast<int32_t>(firstPass) || !allocation.Desc.CanHold(desc))
+				continue;
+
+			if (!best || allocation.Desc.GetBytes() < best->Desc.GetBytes())
+				best = &allocation;
+		}
+
+		TransientAllocation result;
+		if (best)
+		{
+			result.Memory = best->Memory;
+			result.PreviousLastPass = best->BusyUntilPass;
+
+			best->BusyUntilPass = static_cast<int32_t>(lastPass);
+			best->LastUsedFrame = mFrame;
+			return result;
+		}
+
+		if (!mpContext || !mpContext->Get())
+			return result;
+
+		cl_int err = 0;
+		cl_mem memory = nullptr;
+		if (desc.Kind == TransientDesc::Type::Buffer)
+		{
+			memory = clCreateBuffer(mpContext->Get(), CL_MEM_READ_WRITE, std::max<size_t>(desc.Size, 1), nullptr, &err);
+		}
+		else
+		{
+			cl_image_desc imageDesc = {};
+			imageDesc.image_type = CL_MEM_OBJECT_IMAGE2D;
+			imageDesc.image_width = desc.Width;
+			imageDesc.image_height = desc.Height;
+
+			memory = clCreateImage(mpContext->Get(), CL_MEM_READ_WRITE, &desc.Format, &imageDesc, nullptr, &err);
+		}
+
+		if (err < 0 || !memory)
+		{
+			CL_LOG(Error, "Couldn't Allocate Transient Memory: %d", err);
+			return result;
+		}
+
+		Allocation allocation;
+		allocation.Memory = memory;
+		allocation.Desc = desc;
+		allocation.LastUsedFrame = mFrame;
+		allocation.BusyUntilPass = static_cast<int32_t>(lastPass);
+		mAllocations.push_back(allocation);
+
+		result.Memory = memory;
+		return result;
+	}
+
+	void TransientPool::EndFrame(uint32_t framesBeforeRelease)
+	{
+		for (auto itr = mAllocations.begin(); itr != mAllocations.end();)
+		{
+			if (mFrame - itr->LastUsedFrame >= framesBeforeRelease)
+			{
+				clReleaseMemObject(itr->Memory);
+				itr = mAllocations.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+
+	void TransientPool::Clear()
+	{
+		for (Allocation& allocation : mAllocations)
+			clReleaseMemObject(allocation.Memory);
+		mAllocations.clear();
+	}
+
+	size_t TransientPool::GetAllocatedBytes() const
+	{
+		size_t bytes = 0;
+		for (const Allocation& allocation : mAllocations)
+			bytes += allocation.Desc.GetBytes();
+		return bytes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "Core/CLTypedKernel.h"
+
+#include "Core/CLLog.h"
+
+namespace OpenCL
+{
+	namespace Detail
+	{
+		namespace
+		{
+			bool IsPointer(const Kernel::ArgumentInfo& info)
+			{
+				return info.AddressQualifier == CL_KERNEL_ARG_ADDRESS_GLOBAL ||
+					   info.AddressQualifier == CL_KERNEL_ARG_ADDRESS_CONSTANT;
+			}
+
+			bool MatchesArgument(const Kernel::ArgumentInfo& info,
+								 const SignatureArgument& argument)
+			{
+				switch (argument.Kind)
+				{
+				case ArgumentKind::Value:
+					return info.AddressQualifier == CL_KERNEL_ARG_ADDRESS_PRIVATE &&
+						   (info.Size == 0 || info.Size == argument.Size);
+				case ArgumentKind::MemoryObject:
+				case ArgumentKind::SVMPointer:
+					return IsPointer(info);
+				case ArgumentKind::Sampler:
+					return info.TypeName == "sampler_t";
+				case ArgumentKind::Local:
+					return info.AddressQualifier == CL_KERNEL_ARG_ADDRESS_LOCAL;
+				}
+				return false;
+			}
+		}
+
+		bool CheckSignature(const Kernel& kernel,
+							const SignatureArgument* arguments,
+							size_t count)
+		{
+			const std::shared_ptr<const Kernel::KernelInfo>& info = kernel.GetInfo();
+			if (!info)
+				return true;
+
+			if (info->Arguments.size() != count)
+			{
+				CL_LOG(Error, "Kernel %s Takes %d Arguments, Signature Has %d", 
+					   kernel.GetName().c_str(), static_cast<int32_t>(info->Arguments.size()), static_cast<int32_t>(count));
+				return false;
+			}
+
+			bool bMatches = true;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Kernel::ArgumentInfo& arg = info->Arguments[i];
+
+				// Qualifiers and types are only known for programs built with -cl-kernel-arg-info
+				if (arg.TypeName.empty())
+					continue;
+
+				if (!MatchesArgument(arg, arguments[i]))
+				{
+					CL_LOG(Error, "Kernel %s Argument %d (%s %s) Doesn't Match the Signature", 
+						   kernel.GetName().c_str(), static_cast<int32_t>(i), arg.TypeName.c_str(), arg.Name.c_str());
+					bMatches = false;
+				}
+			}
+			return bMatches;
+		}
+	}
+}
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "Objects/CLContextObject.h"
 
+#include "Core/CLRegistry.h"
+
 void UCLContextObject::Initialize(uint32_t deviceIndex, 
 								  uint32_t platformIndex)
 {
-	mpDevice = OpenCL::MakeDevice(deviceIndex, platformIndex);
-	mpContext = OpenCL::MakeContext(mpDevice);
+	// Context objects of one device share its context, so their resources interoperate
+	mpDevice = OpenCL::Registry::GetDevice(deviceIndex, platformIndex);
+	mpContext = OpenCL::Registry::GetContext(mpDevice);
 }
 
 bool UCLContextObject::IsValidDevice() const
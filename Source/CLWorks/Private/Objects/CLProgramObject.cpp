@@ -1,5 +1,9 @@
 #include "Objects/CLProgramObject.h"
 
+#include "CLWorksLog.h"
+
+#include "Core/CLRegistry.h"
+
 void UCLProgramObject::Initialize(const TObjectPtr<UCLContextObject>& context,
 								  const TObjectPtr<UCLProgramAsset>& program, 
 								  const FString& kernelName)
@@ -7,11 +11,17 @@ void UCLProgramObject::Initialize(const TObjectPtr<UCLContextObject>& context,
 	ProgramAsset = program;
 	Name = kernelName;
 
-	mpProgram = std::make_unique<OpenCL::Program>(context->GetContext(), context->GetDevice());
-
+	// Objects of the same asset share one compiled program per context and device
+	const std::string programName(TCHAR_TO_UTF8(*program->GetPathName()));
 	const std::string programString(TCHAR_TO_UTF8(*program->SourceCode));
-	if (!mpProgram->ReadFromString(programString))
+
+	std::string errMsg;
+	mpProgram = OpenCL::Registry::GetProgram(programName, programString.c_str(), context->GetContext(), context->GetDevice(), &errMsg);
+	if (!mpProgram)
+	{
+		UE_LOG(LogCLWorks, Error, TEXT("Failed Building Program %s: %s"), *program->GetPathName(), UTF8_TO_TCHAR(errMsg.c_str()));
 		return;
+	}
 	
 	const std::string name(TCHAR_TO_UTF8(*kernelName));
 	mpKernel = std::make_unique<OpenCL::Kernel>(*mpProgram, name);
@@ -83,3 +93,37 @@ bool UCLProgramObject::SetImageArg(int32 index, UCLImageObject* image)
 }
 
 
+
+
+int32 UCLProgramObject::FindArgumentIndex(const FString& argumentName) const
+{
+	if (mpKernel)
+		return mpKernel->GetArgumentIndex(std::string(TCHAR_TO_UTF8(*argumentName)));
+	return -1;
+}
+
+FCLKernelInfo UCLProgramObject::GetKernelInfo() const
+{
+	FCLKernelInfo result;
+	if (!mpKernel || !mpKernel->GetInfo())
+		return result;
+
+	const OpenCL::Kernel::KernelInfo& info = *mpKernel->GetInfo();
+
+	result.WorkGroupSize = info.WorkGroupSize;
+	result.PreferredWorkGroupMultiple = info.PreferredWorkGroupMultiple;
+	result.CompileWorkGroupSize = FIntVector(info.CompileWorkGroupSize[0], 
+											 info.CompileWorkGroupSize[1], 
+											 info.CompileWorkGroupSize[2]);
+	result.PrivateMemSize = info.PrivateMemSize;
+	result.LocalMemSize = info.LocalMemSize;
+
+	for (const OpenCL::Kernel::ArgumentInfo& arg : info.Arguments)
+	{
+		FCLKernelArgumentInfo& argument = result.Arguments.AddDefaulted_GetRef();
+		argument.Name = FString(arg.Name.c_str());
+		argument.TypeName = FString(arg.TypeName.c_str());
+		argument.Size = static_cast<int32>(arg.Size);
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,459 @@
+#include "Profiler/CLKernelAnalysis.h"
+
+#include "CLWorksLog.h"
+
+#include "Core/CLBuffer.h"
+#include "Core/CLContext.h"
+#include "Core/CLDeviceCapabilities.h"
+#include "Core/CLRegistry.h"
+
+#include "Utils/BuiltinPrograms.h"
+
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	FAutoConsoleCommand DumpAnalysisCommand(
+		TEXT("CLWorks.Analysis.Dump"),
+		TEXT("Logs the occupancy and roofline analysis of all profiled kernels."),
+		FConsoleCommandDelegate::CreateStatic(&FCLKernelAnalysis::Dump));
+
+	FAutoConsoleCommand MeasurePeaksCommand(
+		TEXT("CLWorks.Analysis.MeasurePeaks"),
+		TEXT("Measures the bandwidth and FLOP/s peaks of the default device."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FCLDevicePeaks peaks;
+			FCLKernelAnalysis::MeasurePeaks(OpenCL::Registry::GetDevice(), peaks);
+		}));
+
+	FAutoConsoleCommand ResetAnalysisCommand(
+		TEXT("CLWorks.Analysis.Reset"),
+		TEXT("Clears the accumulated kernel analysis."),
+		FConsoleCommandDelegate::CreateStatic(&FCLKernelAnalysis::Reset));
+
+	const char* PeakProgramSource = R"CLC(
+__kernel void peak_copy(__global const float4* src, __global float4* dst)
+{
+	const size_t i = get_global_id(0);
+	dst[i] = src[i];
+}
+
+// 4 independent chains hide the FMA latency, 2 x 4 x 256 ops per work item
+__kernel void peak_fma(__global float* dst, float a, float b)
+{
+	float x0 = (float)get_global_id(0);
+	float x1 = x0 + 1.0f;
+	float x2 = x0 + 2.0f;
+	float x3 = x0 + 3.0f;
+
+	#pragma unroll 16
+	for (int i = 0; i < 256; ++i)
+	{
+		x0 = mad(x0, a, b);
+		x1 = mad(x1, a, b);
+		x2 = mad(x2, a, b);
+		x3 = mad(x3, a, b);
+	}
+
+	dst[get_global_id(0)] = x0 + x1 + x2 + x3;
+}
+)CLC";
+
+	constexpr double PeakFmaOpsPerWorkItem = 2.0 * 4.0 * 256.0;
+
+	constexpr size_t PeakCopyBytes = 64 * 1024 * 1024;
+
+	constexpr int32 PeakRepetitions = 5;
+
+	struct FDeviceAccumulator
+	{
+		uint64 TotalNs = 0;
+		uint64 WorkItems = 0;
+	};
+
+	struct FKernelAccumulator
+	{
+		uint64 Dispatches = 0;
+		uint64 TotalNs = 0;
+		uint64 WorkItems = 0;
+
+		double OccupancySum = 0.0;
+		double WaveEfficiencySum = 0.0;
+
+		// A kernel may be dispatched on several devices, each compared against its own peaks
+		TMap<cl_device_id, FDeviceAccumulator> Devices;
+	};
+
+	// Written by the profiler tick, queried from any thread
+	FCriticalSection AnalysisLock;
+	TMap<FName, FKernelAccumulator> Accumulators;
+	TMap<FName, FCLKernelCost> KernelCosts;
+	TMap<cl_device_id, FCLDevicePeaks> DevicePeaks;
+
+	// Read from the shared capabilities each time, they're evicted with their sub-devices
+	FCLHardwareMetrics GetDeviceMetrics(cl_device_id device)
+	{
+		FCLHardwareMetrics metrics;
+		const OpenCL::DeviceCapabilitiesPtr caps = OpenCL::DeviceCapabilities::Get(device);
+		metrics.MaxComputeUnits = caps->ComputeUnits;
+		metrics.MaxWorkGroupSize = caps->MaxWorkGroupSize;
+		metrics.GlobalMemSize = caps->GlobalMemSize;
+		metrics.LocalMemSize = caps->LocalMemSize;
+		metrics.MaxResidentWorkItems = caps->MaxResidentWorkItems;
+		metrics.PrivateMemSize = caps->PrivateMemSize;
+		return metrics;
+	}
+
+	uint64 GetResidentWorkItems(const FCLHardwareMetrics& metrics)
+	{
+		return metrics.MaxResidentWorkItems > 0 ? metrics.MaxResidentWorkItems : metrics.MaxWorkGroupSize;
+	}
+
+	uint64 GetResidentGroups(const FCLHardwareMetrics& metrics,
+							 const OpenCL::Kernel::KernelInfo& info,
+							 uint64 localWorkSize)
+	{
+		if (localWorkSize == 0)
+			return 0;
+
+		uint64 groups = GetResidentWorkItems(metrics) / localWorkSize;
+		if (info.LocalMemSize > 0)
+			groups = FMath::Min<uint64>(groups, metrics.LocalMemSize / info.LocalMemSize);
+		if (info.PrivateMemSize > 0 && metrics.PrivateMemSize > 0)
+			groups = FMath::Min<uint64>(groups, metrics.PrivateMemSize / (info.PrivateMemSize * localWorkSize));
+		return groups;
+	}
+
+	FCLKernelAnalysisResult BuildResult(FName name, 
+										const FKernelAccumulator& accumulator)
+	{
+		FCLKernelAnalysisResult result;
+		result.Name = name;
+		result.Dispatches = accumulator.Dispatches;
+		if (accumulator.Dispatches == 0)
+			return result;
+
+		result.AverageMs = accumulator.TotalNs * 1e-6 / accumulator.Dispatches;
+		result.Occupancy = accumulator.OccupancySum / accumulator.Dispatches;
+		result.WaveEfficiency = accumulator.WaveEfficiencySum / accumulator.Dispatches;
+
+		const FCLKernelCost* cost = KernelCosts.Find(name);
+		if (!cost || accumulator.TotalNs == 0)
+			return result;
+
+		result.bHasCost = true;
+
+		// Bytes per nanosecond is GB/s
+		const double totalNs = static_cast<double>(accumulator.TotalNs);
+		const double bytes = cost->BytesPerWorkItem * accumulator.WorkItems;
+		const double ops = cost->OpsPerWorkItem * accumulator.WorkItems;
+
+		result.AchievedGBps = bytes / totalNs;
+		result.AchievedGFlops = ops / totalNs;
+		result.ArithmeticIntensity = bytes > 0.0 ? ops / bytes : 0.0;
+
+		// Peak bytes and ops over the time spent on devices with measured peaks
+		double peakBytes = 0.0;
+		double peakOps = 0.0;
+		uint64 measuredWorkItems = 0;
+		for (const TPair<cl_device_id, FDeviceAccumulator>& device : accumulator.Devices)
+		{
+			const FCLDevicePeaks* peaks = DevicePeaks.Find(device.Key);
+			if (!peaks || !peaks->IsValid())
+				continue;
+
+			peakBytes += peaks->BandwidthGBps * device.Value.TotalNs;
+			peakOps += peaks->GFlops * device.Value.TotalNs;
+			measuredWorkItems += device.Value.WorkItems;
+		}
+
+		if (peakBytes > 0.0 && peakOps > 0.0)
+		{
+			result.BandwidthUtilization = cost->BytesPerWorkItem * measuredWorkItems / peakBytes;
+			result.ComputeUtilization = cost->OpsPerWorkItem * measuredWorkItems / peakOps;
+			result.bMemoryBound = result.ArithmeticIntensity < peakOps / peakBytes;
+		}
+		else
+		{
+			result.bMemoryBound = bytes > 0.0 && ops == 0.0;
+		}
+		return result;
+	}
+
+	cl_command_queue CreateProfilingQueue(cl_context context, 
+										  cl_device_id device)
+	{
+		int32_t err = 0;
+	#ifdef CL_VERSION_2_0
+		cl_queue_properties props[3] =
+		{
+			CL_QUEUE_PROPERTIES,
+			CL_QUEUE_PROFILING_ENABLE,
+			0
+		};
+		cl_command_queue queue = clCreateCommandQueueWithProperties(context, device, props, &err);
+	#else
+		cl_command_queue queue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+	#endif
+		return err < 0 ? nullptr : queue;
+	}
+
+	// Best device time of a few repetitions, the first run is a warm up
+	uint64 TimeKernel(cl_command_queue queue, 
+					  const OpenCL::Kernel& kernel, 
+					  size_t globalWorkSize)
+	{
+		if (!kernel.FlushArguments())
+			return 0;
+
+		uint64 best = MAX_uint64;
+		for (int32 i = 0; i <= PeakRepetitions; ++i)
+		{
+			cl_event event = nullptr;
+			cl_int err = clEnqueueNDRangeKernel(queue, kernel.Get(), 1, nullptr, &globalWorkSize, nullptr, 0, nullptr, &event);
+			if (err < 0)
+			{
+				UE_LOG(LogCLWorks, Error, TEXT("Couldn't Enqueue Peak Benchmark %s: %d"), *FString(kernel.GetName().c_str()), err);
+				return 0;
+			}
+
+			clWaitForEvents(1, &event);
+
+			cl_ulong start = 0;
+			cl_ulong end = 0;
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, nullptr);
+			clReleaseEvent(event);
+
+			if (i > 0 && end > start)
+				best = FMath::Min<uint64>(best, end - start);
+		}
+		return best != MAX_uint64 ? best : 0;
+	}
+}
+
+void FCLKernelAnalysis::DeclareKernelCost(FName kernelName,
+										  const FCLKernelCost& cost)
+{
+	FScopeLock lock(&AnalysisLock);
+
+	KernelCosts.Add(kernelName, cost);
+}
+
+bool FCLKernelAnalysis::MeasurePeaks(const OpenCL::DevicePtr& device,
+									 FCLDevicePeaks& output)
+{
+	if (!device || !device->Get())
+		return false;
+
+	OpenCL::ContextPtr context = OpenCL::Registry::GetContext(device);
+
+	std::shared_ptr<OpenCL::Program> program = BuiltinPrograms::Get("PeakBenchmarks", PeakProgramSource, context, device);
+	if (!program)
+		return false;
+
+	cl_command_queue queue = CreateProfilingQueue(context->Get(), device->Get());
+	if (!queue)
+	{
+		UE_LOG(LogCLWorks, Error, TEXT("Failed Peak Benchmark Queue Creation!"));
+		return false;
+	}
+
+	const FCLHardwareMetrics metrics = GetDeviceMetrics(device->Get());
+
+	FCLDevicePeaks peaks;
+
+	// Bandwidth --------------------------------------------------------------
+	{
+		OpenCL::Buffer src(device, context, nullptr, PeakCopyBytes, OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+		OpenCL::Buffer dst(device, context, nullptr, PeakCopyBytes, OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+
+		OpenCL::Kernel kernel(*program, "peak_copy");
+		const bool argsSet = kernel.IsValid() &&
+							 src.IsValid() && dst.IsValid() &&
+							 kernel.SetArgument<OpenCL::Buffer>(0, src) &&
+							 kernel.SetArgument<OpenCL::Buffer>(1, dst);
+		if (argsSet)
+		{
+			// Each float4 is read once and written once
+			const uint64 ns = TimeKernel(queue, kernel, PeakCopyBytes / (4 * sizeof(float)));
+			if (ns > 0)
+				peaks.BandwidthGBps = 2.0 * PeakCopyBytes / ns;
+		}
+	}
+	// ------------------------------------------------------------------------
+
+	// Compute ----------------------------------------------------------------
+	{
+		const size_t workItems = FMath::Max<size_t>(metrics.MaxComputeUnits, 1) * FMath::Max<size_t>(metrics.MaxWorkGroupSize, 64) * 16;
+
+		OpenCL::Buffer dst(device, context, nullptr, workItems * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+
+		// Values close to one keep the chains finite without denormals
+		const float a = 0.999f;
+		const float b = 0.001f;
+
+		OpenCL::Kernel kernel(*program, "peak_fma");
+		const bool argsSet = kernel.IsValid() &&
+							 dst.IsValid() &&
+							 kernel.SetArgument<OpenCL::Buffer>(0, dst) &&
+							 kernel.SetArgument(1, a) &&
+							 kernel.SetArgument(2, b);
+		if (argsSet)
+		{
+			const uint64 ns = TimeKernel(queue, kernel, workItems);
+			if (ns > 0)
+				peaks.GFlops = PeakFmaOpsPerWorkItem * workItems / ns;
+		}
+	}
+	// ------------------------------------------------------------------------
+
+	clReleaseCommandQueue(queue);
+
+	if (!peaks.IsValid())
+	{
+		UE_LOG(LogCLWorks, Warning, TEXT("Failed Measuring Device Peaks!"));
+		return false;
+	}
+
+	UE_LOG(LogCLWorks, Log, TEXT("Device Peaks: %.1f GB/s, %.1f GFLOP/s (Ridge Point: %.2f Ops/Byte)"), peaks.BandwidthGBps, peaks.GFlops, peaks.GetRidgePoint());
+
+	{
+		FScopeLock lock(&AnalysisLock);
+		DevicePeaks.Add(device->Get(), peaks);
+	}
+
+	output = peaks;
+	return true;
+}
+
+bool FCLKernelAnalysis::GetPeaks(cl_device_id device,
+								 FCLDevicePeaks& output)
+{
+	FScopeLock lock(&AnalysisLock);
+
+	const FCLDevicePeaks* peaks = DevicePeaks.Find(device);
+	if (!peaks)
+		return false;
+
+	output = *peaks;
+	return true;
+}
+
+double FCLKernelAnalysis::GetTheoreticalOccupancy(const FCLHardwareMetrics& metrics,
+												  const OpenCL::Kernel::KernelInfo& info,
+												  uint64 localWorkSize)
+{
+	const uint64 residentWorkItems = GetResidentWorkItems(metrics);
+	if (localWorkSize == 0 || residentWorkItems == 0)
+		return 0.0;
+
+	const uint64 residentGroups = GetResidentGroups(metrics, info, localWorkSize);
+	return FMath::Min(1.0, double(residentGroups * localWorkSize) / double(residentWorkItems));
+}
+
+bool FCLKernelAnalysis::GetKernelAnalysis(FName kernelName,
+										  FCLKernelAnalysisResult& output)
+{
+	FScopeLock lock(&AnalysisLock);
+
+	const FKernelAccumulator* accumulator = Accumulators.Find(kernelName);
+	if (!accumulator)
+		return false;
+
+	output = BuildResult(kernelName, *accumulator);
+	return true;
+}
+
+TArray<FCLKernelAnalysisResult> FCLKernelAnalysis::GetAllKernelAnalysis()
+{
+	FScopeLock lock(&AnalysisLock);
+
+	TArray<FCLKernelAnalysisResult> result;
+	result.Reserve(Accumulators.Num());
+	for (const TPair<FName, FKernelAccumulator>& entry : Accumulators)
+		result.Add(BuildResult(entry.Key, entry.Value));
+	return result;
+}
+
+void FCLKernelAnalysis::Dump()
+{
+	TArray<FCLKernelAnalysisResult> results = GetAllKernelAnalysis();
+	if (results.Num() == 0)
+	{
+		UE_LOG(LogCLWorks, Log, TEXT("No Profiled Kernels To Analyze (Is CLWorks.Profiling Enabled?)"));
+		return;
+	}
+
+	results.Sort([](const FCLKernelAnalysisResult& a, const FCLKernelAnalysisResult& b)
+	{
+		return a.AverageMs * a.Dispatches > b.AverageMs * b.Dispatches;
+	});
+
+	UE_LOG(LogCLWorks, Log, TEXT("%-32s %10s %10s %9s %7s %10s %10s %9s %7s %7s %s"),
+		   TEXT("Kernel"), TEXT("Dispatches"), TEXT("Avg (ms)"), TEXT("Occupancy"), TEXT("Waves"),
+		   TEXT("GB/s"), TEXT("GFLOP/s"), TEXT("Ops/Byte"), TEXT("% BW"), TEXT("% FLOP"), TEXT("Bound"));
+
+	for (const FCLKernelAnalysisResult& result : results)
+	{
+		const TCHAR* bound = !result.bHasCost ? TEXT("-") : (result.bMemoryBound ? TEXT("Memory") : TEXT("Compute"));
+
+		UE_LOG(LogCLWorks, Log, TEXT("%-32s %10llu %10.3f %8.0f%% %6.0f%% %10.1f %10.1f %9.2f %6.0f%% %6.0f%% %s"),
+			   *result.Name.ToString(), result.Dispatches, result.AverageMs, result.Occupancy * 100.0, result.WaveEfficiency * 100.0,
+			   result.AchievedGBps, result.AchievedGFlops, result.ArithmeticIntensity,
+			   result.BandwidthUtilization * 100.0, result.ComputeUtilization * 100.0, bound);
+	}
+}
+
+void FCLKernelAnalysis::Reset()
+{
+	FScopeLock lock(&AnalysisLock);
+
+	Accumulators.Empty();
+}
+
+void FCLKernelAnalysis::Process(const TArray<FKernelProfile>& kernels)
+{
+	if (kernels.Num() == 0)
+		return;
+
+	FScopeLock lock(&AnalysisLock);
+
+	for (const FKernelProfile& profile : kernels)
+	{
+		if (!profile.mpInfo || !profile.mpDevice)
+			continue;
+
+		const OpenCL::Kernel::KernelInfo& info = *profile.mpInfo;
+		const FCLHardwareMetrics metrics = GetDeviceMetrics(profile.mpDevice);
+
+		// Driver chosen sizes aren't reported, assume the kernel's largest group
+		uint64 localWorkSize = profile.mLocalWorkSize;
+		if (localWorkSize == 0)
+			localWorkSize = FMath::Min<uint64>(FMath::Max<uint64>(info.WorkGroupSize, 1), profile.mGlobalWorkSize);
+
+		double waveEfficiency = 0.0;
+		const uint64 residentGroups = GetResidentGroups(metrics, info, localWorkSize);
+		const uint64 slots = residentGroups * metrics.MaxComputeUnits;
+		if (slots > 0 && localWorkSize > 0)
+		{
+			const uint64 groups = FMath::DivideAndRoundUp(profile.mGlobalWorkSize, localWorkSize);
+			const uint64 waves = FMath::DivideAndRoundUp(groups, slots);
+			waveEfficiency = double(groups) / double(waves * slots);
+		}
+
+		const uint64 durationNs = (profile.mEndTimeNs > profile.mStartTimeNs) ? profile.mEndTimeNs - profile.mStartTimeNs : 0;
+
+		FKernelAccumulator& accumulator = Accumulators.FindOrAdd(FName(info.Name.c_str()));
+		++accumulator.Dispatches;
+		accumulator.TotalNs += durationNs;
+		accumulator.WorkItems += profile.mGlobalWorkSize;
+		accumulator.OccupancySum += GetTheoreticalOccupancy(metrics, info, localWorkSize);
+		accumulator.WaveEfficiencySum += waveEfficiency;
+
+		FDeviceAccumulator& device = accumulator.Devices.FindOrAdd(profile.mpDevice);
+		device.TotalNs += durationNs;
+		device.WorkItems += profile.mGlobalWorkSize;
+	}
+}
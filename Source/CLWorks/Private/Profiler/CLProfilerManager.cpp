@@ -2,24 +2,149 @@
 
 #include "CLWorksLog.h"
 
+#include "Core/CLDeviceEnumerator.h"
+#include "Core/CLRegistry.h"
+#include "Profiler/CLKernelAnalysis.h"
 #include "Profiler/CLStats.h"
+#include "Profiler/CLTraceExporter.h"
+
+#include "Utils/MpscRing.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+	void OnProfilingChanged(IConsoleVariable* variable);
+
+	TAutoConsoleVariable<bool> CVarCLWorksProfiling(
+		TEXT("CLWorks.Profiling"),
+		WITH_EDITOR,
+		TEXT("Creates profiling enabled command queues and records kernel and transfer timings.\n")
+		TEXT("Toggling it recreates the shared queues, other queues keep the setting they were created with.\n")
+		TEXT("Can also be enabled with -CLProfile."),
+		FConsoleVariableDelegate::CreateStatic(&OnProfilingChanged),
+		ECVF_Default);
+
+	FCLOnProfilingChanged ProfilingChangedDelegate;
+
+	void OnProfilingChanged(IConsoleVariable* variable)
+	{
+		// Set is reported even if the value didn't change
+		static bool bWasEnabled = WITH_EDITOR;
+		const bool bEnabled = variable->GetBool();
+		if (bEnabled == bWasEnabled)
+			return;
+		bWasEnabled = bEnabled;
+
+		// Queues only enable profiling on creation
+		OpenCL::Registry::ReleaseQueues();
+
+		ProfilingChangedDelegate.Broadcast(FCLProfilerManager::IsProfilingEnabled());
+	}
+
+	constexpr size_t ProfileRingCapacity = 4096;
+
+	// Dispatches kept per kernel for the rolling window stats
+	constexpr int32 KernelHistoryWindow = 256;
+
+	// Filled by the runtime's callback threads, drained by the profiler tick
+	TMpscRing<FKernelProfile, ProfileRingCapacity> CompletedRing;
+	TMpscRing<FTransferProfile, ProfileRingCapacity> CompletedTransferRing;
+
+	struct FKernelHistory
+	{
+		TArray<float> Samples;
+		int32 NextSample = 0;
+
+		bool bDirty = false;
+
+		FCLKernelStats Stats;
+
+	#if STATS
+		TStatId AverageStatId;
+		TStatId P95StatId;
+	#endif
+	};
+
+	// Written by the profiler tick, queried from any thread
+	FCriticalSection HistoryLock;
+	TMap<FName, FKernelHistory> KernelHistories;
+
+	struct FTransferAggregate
+	{
+		FCLTransferStats Directions[static_cast<uint8>(ECLTransferDirection::COUNT)];
+	};
+
+	// Written by the profiler tick, queried from any thread
+	FCriticalSection TransferLock;
+	FTransferAggregate StrategyTransfers[static_cast<uint8>(OpenCL::MemoryStrategy::COUNT)];
+
+	// Added on a queue's first profiled transfer and removed on its release
+	TMap<uint64, FTransferAggregate> QueueTransfers;
+
+	double GetPercentile(const TArray<float>& sortedSamples, double percentile)
+	{
+		if (sortedSamples.Num() == 0)
+			return 0.0;
+
+		// Nearest-rank
+		const int32 rank = FMath::CeilToInt32(percentile * sortedSamples.Num());
+		return sortedSamples[FMath::Clamp(rank - 1, 0, sortedSamples.Num() - 1)];
+	}
+}
 
 FCLHardwareMetrics FCLProfilerManager::HardwareMetrics = {};
 
-TArray<FKernelProfile> FCLProfilerManager::ActiveKernels = {};
-TArray<FKernelProfile> FCLProfilerManager::CompletedKernels = {};
+std::atomic<int32> FCLProfilerManager::InFlightKernels = 0;
+std::atomic<uint32> FCLProfilerManager::DroppedKernelProfiles = 0;
+std::atomic<uint32> FCLProfilerManager::DroppedTransferProfiles = 0;
+
+bool FCLProfilerManager::IsProfilingEnabled()
+{
+	static const bool bCommandLineProfiling = FParse::Param(FCommandLine::Get(), TEXT("CLProfile"));
+	return bCommandLineProfiling || CVarCLWorksProfiling.GetValueOnAnyThread();
+}
+
+FCLOnProfilingChanged& FCLProfilerManager::OnProfilingChanged()
+{
+	return ProfilingChangedDelegate;
+}
 
-std::mutex mProfileMutex = {};
+const std::string& FKernelProfile::GetName() const
+{
+	static const std::string Unknown = "Unknown";
+	return mpInfo ? mpInfo->Name : Unknown;
+}
 
 FCLProfilerManager::FCLProfilerManager()
 {
-	// Profile default hardware statistics
-	OpenCL::Device device;
+}
 
-	clGetDeviceInfo(device.Get(), CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(HardwareMetrics.MaxComputeUnits), &HardwareMetrics.MaxComputeUnits, nullptr);
-	clGetDeviceInfo(device.Get(), CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(HardwareMetrics.MaxWorkGroupSize), &HardwareMetrics.MaxWorkGroupSize, nullptr);
-	clGetDeviceInfo(device.Get(), CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(HardwareMetrics.GlobalMemSize), &HardwareMetrics.GlobalMemSize, nullptr);
-	clGetDeviceInfo(device.Get(), CL_DEVICE_LOCAL_MEM_SIZE, sizeof(HardwareMetrics.LocalMemSize), &HardwareMetrics.LocalMemSize, nullptr);
+FCLProfilerManager::~FCLProfilerManager()
+{
+}
+
+void FCLProfilerManager::UpdateHardwareMetrics()
+{
+	// Don't stall the game thread on the ICDs loading
+	if (mbHasHardwareMetrics || !OpenCL::DeviceEnumerator::IsEnumerated())
+		return;
+
+	mbHasHardwareMetrics = true;
+
+	// Profile default hardware statistics from the cached enumeration
+	if (const OpenCL::DeviceDescription* device = OpenCL::DeviceEnumerator::GetDevice())
+	{
+		const OpenCL::DeviceCapabilities& caps = device->GetCapabilities();
+		HardwareMetrics.MaxComputeUnits = caps.ComputeUnits;
+		HardwareMetrics.MaxWorkGroupSize = caps.MaxWorkGroupSize;
+		HardwareMetrics.GlobalMemSize = caps.GlobalMemSize;
+		HardwareMetrics.LocalMemSize = caps.LocalMemSize;
+		HardwareMetrics.MaxResidentWorkItems = caps.MaxResidentWorkItems;
+		HardwareMetrics.PrivateMemSize = caps.PrivateMemSize;
+	}
 
 	SET_DWORD_STAT(STAT_OpenCL_TotalComputeUnits, HardwareMetrics.MaxComputeUnits);
 	SET_DWORD_STAT(STAT_OpenCL_TotalWorkgroups, HardwareMetrics.MaxWorkGroupSize);
@@ -28,14 +153,11 @@ FCLProfilerManager::FCLProfilerManager()
 	SET_MEMORY_STAT(STAT_OpenCL_HardwareLocalMemory, HardwareMetrics.LocalMemSize);
 }
 
-FCLProfilerManager::~FCLProfilerManager()
-{
-}
-
 
 void FCLProfilerManager::Tick(float DeltaTime)
 {
-	PollEvents();
+	UpdateHardwareMetrics();
+	DrainCompleted();
 	UpdateStats();
 }
 
@@ -51,73 +173,338 @@ void FCLProfilerManager::EnqueueProfiledKernel(const OpenCL::CommandQueue& queue
 											   const size_t* global_work_size,
 											   const size_t* local_work_size)
 {
-	const std::scoped_lock lock(mProfileMutex);
+	if (!event.Get())
+		return;
+
+	FKernelProfile* profile = new FKernelProfile();
+	profile->mpInfo = kernel.GetInfo();
+	profile->mpQueue = queue.Get();
+	profile->mpDevice = queue.GetDeviceId();
+	profile->mEnqueueCycles = FPlatformTime::Cycles64();
+
+	profile->mGlobalWorkSize = 1;
+	profile->mLocalWorkSize = local_work_size ? 1 : 0;
+	for (size_t i = 0; i < work_dim; ++i)
+	{
+		profile->mGlobalWorkSize *= global_work_size[i];
+		if (local_work_size)
+			profile->mLocalWorkSize *= local_work_size[i];
+	}
+
+	InFlightKernels.fetch_add(1, std::memory_order_relaxed);
 
-	FKernelProfile Profile;
-	Profile.mName = kernel.GetName();
-	Profile.mEvent = event.Get();
-	
-	OpenCL::DevicePtr device_ptr = queue.GetDevicePtr();
-	if (!device_ptr)
+	cl_int err = clSetEventCallback(event.Get(), CL_COMPLETE, &FCLProfilerManager::OnKernelComplete, profile);
+	if (err < 0)
 	{
-		UE_LOG(LogCLWorks, Warning, TEXT("Failed To Enqueue Kernel: %s"), *FString(kernel.GetName().c_str()));
+		InFlightKernels.fetch_sub(1, std::memory_order_relaxed);
+		clReleaseEvent(event.Get());
+		delete profile;
+	}
+}
+
+void CL_CALLBACK FCLProfilerManager::OnKernelComplete(cl_event event, cl_int status, void* userData)
+{
+	FKernelProfile* profile = static_cast<FKernelProfile*>(userData);
+
+	// Queues created without profiling leave the timings at zero
+	if (status == CL_COMPLETE)
+	{
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &profile->mQueuedTimeNs, nullptr);
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &profile->mStartTimeNs, nullptr);
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &profile->mEndTimeNs, nullptr);
+	}
+	clReleaseEvent(event);
+
+	if (!CompletedRing.TryPush(std::move(*profile)))
+		DroppedKernelProfiles.fetch_add(1, std::memory_order_relaxed);
+
+	InFlightKernels.fetch_sub(1, std::memory_order_relaxed);
+
+	delete profile;
+}
+
+void FCLProfilerManager::EnqueueProfiledTransfer(const OpenCL::CommandQueue& queue,
+												 cl_event event,
+												 ECLTransferDirection direction,
+												 ECLTransferCommand command,
+												 uint64_t bytes,
+												 OpenCL::MemoryStrategy strategy)
+{
+	if (!event)
 		return;
+
+	{
+		FScopeLock lock(&TransferLock);
+		QueueTransfers.FindOrAdd(queue.GetId());
+	}
+
+	FTransferProfile* profile = new FTransferProfile();
+	profile->mpQueue = queue.Get();
+	profile->mQueueId = queue.GetId();
+	profile->mpDevice = queue.GetDeviceId();
+	profile->mEnqueueCycles = FPlatformTime::Cycles64();
+	profile->mDirection = direction;
+	profile->mCommand = command;
+	profile->mStrategy = strategy;
+	profile->mBytes = bytes;
+
+	cl_int err = clSetEventCallback(event, CL_COMPLETE, &FCLProfilerManager::OnTransferComplete, profile);
+	if (err < 0)
+	{
+		clReleaseEvent(event);
+		delete profile;
+	}
+}
+
+void CL_CALLBACK FCLProfilerManager::OnTransferComplete(cl_event event, cl_int status, void* userData)
+{
+	FTransferProfile* profile = static_cast<FTransferProfile*>(userData);
+
+	if (status == CL_COMPLETE)
+	{
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &profile->mQueuedTimeNs, nullptr);
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &profile->mStartTimeNs, nullptr);
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &profile->mEndTimeNs, nullptr);
 	}
+	clReleaseEvent(event);
+
+	if (!CompletedTransferRing.TryPush(std::move(*profile)))
+		DroppedTransferProfiles.fetch_add(1, std::memory_order_relaxed);
+
+	delete profile;
+}
+
+FCLTransferStats FCLProfilerManager::GetTransferStats(OpenCL::MemoryStrategy strategy,
+													  ECLTransferDirection direction)
+{
+	if (strategy >= OpenCL::MemoryStrategy::COUNT || direction >= ECLTransferDirection::COUNT)
+		return {};
+
+	FScopeLock lock(&TransferLock);
+
+	return StrategyTransfers[static_cast<uint8>(strategy)].Directions[static_cast<uint8>(direction)];
+}
+
+FCLTransferStats FCLProfilerManager::GetQueueTransferStats(const OpenCL::CommandQueue& queue,
+														   ECLTransferDirection direction)
+{
+	if (direction >= ECLTransferDirection::COUNT)
+		return {};
+
+	FScopeLock lock(&TransferLock);
+
+	const FTransferAggregate* aggregate = QueueTransfers.Find(queue.GetId());
+	return aggregate ? aggregate->Directions[static_cast<uint8>(direction)] : FCLTransferStats();
+}
+
+void FCLProfilerManager::ReleaseQueueStats(const OpenCL::CommandQueue& queue)
+{
+	FScopeLock lock(&TransferLock);
+
+	QueueTransfers.Remove(queue.GetId());
+}
+
+void FCLProfilerManager::ResetTransferStats()
+{
+	FScopeLock lock(&TransferLock);
 
-	clGetKernelWorkGroupInfo(kernel, *device_ptr, CL_KERNEL_WORK_GROUP_SIZE, sizeof(Profile.KernelWorkGroupSize), &Profile.KernelWorkGroupSize, nullptr);
-	clGetKernelWorkGroupInfo(kernel, *device_ptr, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(Profile.PreferredWorkGroupMultiple), &Profile.PreferredWorkGroupMultiple, nullptr);
-	clGetKernelWorkGroupInfo(kernel, *device_ptr, CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(Profile.CompiledWorkGroupSize), &Profile.CompiledWorkGroupSize, nullptr);
-	clGetKernelWorkGroupInfo(kernel, *device_ptr, CL_KERNEL_PRIVATE_MEM_SIZE, sizeof(Profile.PrivateMemSize), &Profile.PrivateMemSize, nullptr);
-	clGetKernelWorkGroupInfo(kernel, *device_ptr, CL_KERNEL_LOCAL_MEM_SIZE, sizeof(Profile.LocalMemSizeUsed), &Profile.LocalMemSizeUsed, nullptr);
+	for (FTransferAggregate& aggregate : StrategyTransfers)
+		aggregate = {};
 
-	ActiveKernels.Add(Profile);
+	// Live queues keep their entries
+	for (TPair<uint64, FTransferAggregate>& entry : QueueTransfers)
+		entry.Value = {};
 }
 
-void FCLProfilerManager::PollEvents()
+void FCLProfilerManager::UpdateTransferStats()
 {
-	const std::scoped_lock lock(mProfileMutex);
+	FCLTransferStats frame[static_cast<uint8>(ECLTransferDirection::COUNT)];
 
-	for (int32 i = ActiveKernels.Num() - 1; i >= 0; --i)
 	{
-		cl_int eventStatus;
-		clGetEventInfo(ActiveKernels[i].mEvent, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(eventStatus), &eventStatus, nullptr);
+		FScopeLock lock(&TransferLock);
 
-		if (eventStatus == CL_COMPLETE)
+		for (const FTransferProfile& Profile : CompletedTransfers)
 		{
-			clGetEventProfilingInfo(ActiveKernels[i].mEvent, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &ActiveKernels[i].mStartTimeNs, nullptr);
-			clGetEventProfilingInfo(ActiveKernels[i].mEvent, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &ActiveKernels[i].mEndTimeNs, nullptr);
+			const uint8 direction = static_cast<uint8>(Profile.mDirection);
+
+			// Transfers completing after their queue's release have no entry
+			FTransferAggregate* queueAggregate = QueueTransfers.Find(Profile.mQueueId);
+
+			FCLTransferStats* targets[] =
+			{
+				&frame[direction],
+				&StrategyTransfers[static_cast<uint8>(Profile.mStrategy)].Directions[direction],
+				queueAggregate ? &queueAggregate->Directions[direction] : nullptr
+			};
 
-			clReleaseEvent(ActiveKernels[i].mEvent);
-			CompletedKernels.Add(ActiveKernels[i]);
-			ActiveKernels.RemoveAt(i);
+			for (FCLTransferStats* target : targets)
+			{
+				if (!target)
+					continue;
+
+				++target->Count;
+				target->Bytes += Profile.mBytes;
+				target->DeviceTimeNs += Profile.GetDurationNs();
+			}
 		}
 	}
+
+	const FCLTransferStats& upload = frame[static_cast<uint8>(ECLTransferDirection::Upload)];
+	const FCLTransferStats& readback = frame[static_cast<uint8>(ECLTransferDirection::Readback)];
+
+	SET_DWORD_STAT(STAT_OpenCL_Transfers, upload.Count + readback.Count);
+	SET_FLOAT_STAT(STAT_OpenCL_UploadMB, upload.Bytes / (1024.0 * 1024.0));
+	SET_FLOAT_STAT(STAT_OpenCL_ReadbackMB, readback.Bytes / (1024.0 * 1024.0));
+	SET_FLOAT_STAT(STAT_OpenCL_UploadGBps, upload.GetGBps());
+	SET_FLOAT_STAT(STAT_OpenCL_ReadbackGBps, readback.GetGBps());
+
+	CompletedTransfers.Reset();
+}
+
+void FCLProfilerManager::DrainCompleted()
+{
+	FKernelProfile profile;
+	while (CompletedRing.TryPop(profile))
+		CompletedKernels.Add(MoveTemp(profile));
+
+	FTransferProfile transfer;
+	while (CompletedTransferRing.TryPop(transfer))
+		CompletedTransfers.Add(transfer);
+
+	FCLTraceExporter::Process(CompletedKernels, CompletedTransfers);
+
+	const uint32 droppedKernels = DroppedKernelProfiles.exchange(0, std::memory_order_relaxed);
+	if (droppedKernels > 0)
+		UE_LOG(LogCLWorks, Verbose, TEXT("Dropped %u Kernel Profiles, Profile Ring Full!"), droppedKernels);
+
+	const uint32 droppedTransfers = DroppedTransferProfiles.exchange(0, std::memory_order_relaxed);
+	if (droppedTransfers > 0)
+		UE_LOG(LogCLWorks, Verbose, TEXT("Dropped %u Transfer Profiles, Profile Ring Full!"), droppedTransfers);
+}
+
+bool FCLProfilerManager::GetKernelStats(FName kernelName,
+										FCLKernelStats& output)
+{
+	FScopeLock lock(&HistoryLock);
+
+	const FKernelHistory* history = KernelHistories.Find(kernelName);
+	if (!history)
+		return false;
+
+	output = history->Stats;
+	return true;
+}
+
+TArray<FCLKernelStats> FCLProfilerManager::GetAllKernelStats()
+{
+	FScopeLock lock(&HistoryLock);
+
+	TArray<FCLKernelStats> result;
+	result.Reserve(KernelHistories.Num());
+	for (const TPair<FName, FKernelHistory>& entry : KernelHistories)
+		result.Add(entry.Value.Stats);
+	return result;
+}
+
+void FCLProfilerManager::ResetKernelStats()
+{
+	FScopeLock lock(&HistoryLock);
+
+	KernelHistories.Empty();
+}
+
+void FCLProfilerManager::UpdateKernelHistories()
+{
+	FScopeLock lock(&HistoryLock);
+
+	for (const FKernelProfile& Profile : CompletedKernels)
+	{
+		const FName kernelName(Profile.GetName().c_str());
+
+		FKernelHistory* history = KernelHistories.Find(kernelName);
+		if (!history)
+		{
+			history = &KernelHistories.Add(kernelName);
+			history->Samples.Reserve(KernelHistoryWindow);
+			history->Stats.Name = kernelName;
+
+		#if STATS
+			const FString statName = kernelName.ToString();
+			history->AverageStatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_OpenCL>(statName + TEXT(" Avg (ms)"));
+			history->P95StatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_OpenCL>(statName + TEXT(" P95 (ms)"));
+		#endif
+		}
+
+		const float duration = Profile.GetDurationMs();
+		if (history->Samples.Num() < KernelHistoryWindow)
+		{
+			history->Samples.Add(duration);
+		}
+		else
+		{
+			history->Samples[history->NextSample] = duration;
+		}
+		history->NextSample = (history->NextSample + 1) % KernelHistoryWindow;
+
+		++history->Stats.TotalCount;
+		history->bDirty = true;
+	}
+
+	TArray<float> sorted;
+	for (TPair<FName, FKernelHistory>& entry : KernelHistories)
+	{
+		FKernelHistory& history = entry.Value;
+		if (!history.bDirty)
+			continue;
+
+		history.bDirty = false;
+
+		sorted = history.Samples;
+		sorted.Sort();
+
+		FCLKernelStats& stats = history.Stats;
+		stats.Count = sorted.Num();
+		stats.TotalMs = 0.0;
+		for (float sample : sorted)
+			stats.TotalMs += sample;
+
+		stats.MinMs = sorted[0];
+		stats.MaxMs = sorted.Last();
+		stats.P50Ms = GetPercentile(sorted, 0.50);
+		stats.P95Ms = GetPercentile(sorted, 0.95);
+		stats.P99Ms = GetPercentile(sorted, 0.99);
+
+	#if STATS
+		SET_FLOAT_STAT_FName(history.AverageStatId.GetName(), stats.GetAverageMs());
+		SET_FLOAT_STAT_FName(history.P95StatId.GetName(), stats.P95Ms);
+	#endif
+	}
 }
 
 void FCLProfilerManager::UpdateStats()
 {
-	const std::scoped_lock lock(mProfileMutex);
+	SET_DWORD_STAT(STAT_OpenCL_ActiveKernels, InFlightKernels.load(std::memory_order_relaxed));
 
-	SET_DWORD_STAT(STAT_OpenCL_ActiveKernels, ActiveKernels.Num());
+	UpdateTransferStats();
 
 	if (CompletedKernels.Num() > 0)
 	{
 		float TotalTime_ms = 0.0f;
-		int32 TotalGroups = 0;
-
 		for (const FKernelProfile& Profile : CompletedKernels)
-		{
 			TotalTime_ms += Profile.GetDurationMs();
-			TotalGroups += Profile.GetWorkGroupCount();
-		}
 
 		SET_FLOAT_STAT(STAT_OpenCL_KernelTime, TotalTime_ms);
+		SET_DWORD_STAT(STAT_OpenCL_KernelDispatches, CompletedKernels.Num());
+
+		UpdateKernelHistories();
 
-		CompletedKernels.Empty();
+		FCLKernelAnalysis::Process(CompletedKernels);
+
+		CompletedKernels.Reset();
 	}
 	else
 	{
 		SET_FLOAT_STAT(STAT_OpenCL_KernelTime, 0.0f);
+		SET_DWORD_STAT(STAT_OpenCL_KernelDispatches, 0);
 	}
 }
-
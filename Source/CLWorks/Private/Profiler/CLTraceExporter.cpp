@@ -0,0 +1,344 @@
+#include "Profiler/CLTraceExporter.h"
+
+#include "CLWorksLog.h"
+
+#include "Profiler/CLProfilerManager.h"
+
+#include "GpuProfilerTrace.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+
+UE_TRACE_CHANNEL_DEFINE(CLWorksChannel);
+
+namespace
+{
+	// Device and host clocks drift apart, re-correlate periodically
+	constexpr double ClockSyncIntervalSeconds = 1.0;
+
+	TAutoConsoleVariable<int32> CVarCLWorksTraceGPUIndex(
+		TEXT("CLWorks.Trace.GPUIndex"),
+		1,
+		TEXT("Unreal Insights GPU track the OpenCL timing events are emitted on.\n")
+		TEXT("Defaults to the second, which the RHI leaves unused on single GPU systems."),
+		ECVF_Default);
+
+	uint64 ToMicroseconds(uint64 cycles)
+	{
+		return static_cast<uint64>(FPlatformTime::ToSeconds64(cycles) * 1e6);
+	}
+
+	FAutoConsoleCommand StartTraceCommand(
+		TEXT("CLWorks.Trace.Start"),
+		TEXT("Starts capturing OpenCL device activity into a Chrome trace. Optional argument: output file path."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FCLTraceExporter::StartCapture(Args.Num() > 0 ? Args[0] : FString());
+		}));
+
+	FAutoConsoleCommand StopTraceCommand(
+		TEXT("CLWorks.Trace.Stop"),
+		TEXT("Stops capturing OpenCL device activity and writes the Chrome trace."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FCLTraceExporter::StopCapture();
+		}));
+
+	const TCHAR* GetTransferName(const FTransferProfile& profile)
+	{
+		const bool isUpload = profile.mDirection == ECLTransferDirection::Upload;
+		switch (profile.mCommand)
+		{
+			case ECLTransferCommand::Read:
+				return TEXT("Read");
+			case ECLTransferCommand::Write:
+				return TEXT("Write");
+			case ECLTransferCommand::Map:
+				return isUpload ? TEXT("Map (Upload)") : TEXT("Map (Readback)");
+			case ECLTransferCommand::Unmap:
+				return isUpload ? TEXT("Unmap (Upload)") : TEXT("Unmap (Readback)");
+			default:
+				return TEXT("Transfer");
+		}
+	}
+}
+
+FCriticalSection FCLTraceExporter::ClockSyncLock;
+TMap<cl_device_id, FCLTraceExporter::FClockSync> FCLTraceExporter::ClockSyncs = {};
+
+bool FCLTraceExporter::bCapturing = false;
+FString FCLTraceExporter::CapturePath = {};
+uint64 FCLTraceExporter::CaptureStartCycles = 0;
+TArray<FString> FCLTraceExporter::CaptureEvents = {};
+TMap<cl_command_queue, int32> FCLTraceExporter::CaptureQueues = {};
+
+void FCLTraceExporter::StartCapture(const FString& filePath)
+{
+	check(IsInGameThread());
+
+	CapturePath = filePath;
+	if (CapturePath.IsEmpty())
+	{
+		CapturePath = FPaths::Combine(FPaths::ProfilingDir(), 
+									  TEXT("CLWorks"), 
+									  FString::Printf(TEXT("CLTrace_%s.json"), *FDateTime::Now().ToString()));
+	}
+
+	CaptureEvents.Reset();
+	CaptureQueues.Reset();
+	CaptureStartCycles = FPlatformTime::Cycles64();
+	bCapturing = true;
+
+	UE_LOG(LogCLWorks, Log, TEXT("Started OpenCL Trace Capture: %s"), *CapturePath);
+}
+
+bool FCLTraceExporter::StopCapture()
+{
+	check(IsInGameThread());
+
+	if (!bCapturing)
+		return false;
+
+	bCapturing = false;
+
+	FString json = TEXT("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (const TPair<cl_command_queue, int32>& queue : CaptureQueues)
+	{
+		json += FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CL Queue %d\"}},\n"), queue.Value, queue.Value);
+	}
+	json += FString::Join(CaptureEvents, TEXT(",\n"));
+	json += TEXT("\n]}");
+
+	CaptureEvents.Empty();
+	CaptureQueues.Empty();
+
+	if (!FFileHelper::SaveStringToFile(json, *CapturePath))
+	{
+		UE_LOG(LogCLWorks, Error, TEXT("Failed Writing OpenCL Trace: %s"), *CapturePath);
+		return false;
+	}
+
+	UE_LOG(LogCLWorks, Log, TEXT("Wrote OpenCL Trace: %s"), *CapturePath);
+	return true;
+}
+
+bool FCLTraceExporter::IsCapturing()
+{
+	return bCapturing;
+}
+
+void FCLTraceExporter::Process(const TArray<FKernelProfile>& kernels,
+							   const TArray<FTransferProfile>& transfers)
+{
+	const bool bTracing = UE_TRACE_CHANNELEXPR_IS_ENABLED(CLWorksChannel);
+	if (!bCapturing && !bTracing)
+		return;
+
+	TMap<cl_device_id, FTimingFrame> timingFrames;
+
+	for (const FKernelProfile& profile : kernels)
+	{
+		if (profile.mEndTimeNs == 0)
+			continue;
+
+		const FString name(profile.GetName().c_str());
+		if (bTracing)
+			AddTimingEvent(FName(*name), profile.mpDevice, profile.mStartTimeNs, profile.mEndTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles, timingFrames);
+
+		if (bCapturing)
+		{
+			Emit(*name,
+				 TEXT("Kernel"),
+				 profile.mpQueue,
+				 DeviceToCycles(profile.mpDevice, profile.mStartTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles),
+				 DeviceToCycles(profile.mpDevice, profile.mEndTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles),
+				 0);
+		}
+	}
+
+	for (const FTransferProfile& profile : transfers)
+	{
+		if (profile.mEndTimeNs == 0)
+			continue;
+
+		const TCHAR* name = GetTransferName(profile);
+		if (bTracing)
+			AddTimingEvent(FName(name), profile.mpDevice, profile.mStartTimeNs, profile.mEndTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles, timingFrames);
+
+		if (bCapturing)
+		{
+			Emit(name,
+				 TEXT("Transfer"),
+				 profile.mpQueue,
+				 DeviceToCycles(profile.mpDevice, profile.mStartTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles),
+				 DeviceToCycles(profile.mpDevice, profile.mEndTimeNs, profile.mQueuedTimeNs, profile.mEnqueueCycles),
+				 profile.mBytes);
+		}
+	}
+
+	if (timingFrames.Num() > 0)
+	{
+		TArray<FTimingFrame> frames;
+		timingFrames.GenerateValueArray(frames);
+		EmitTimingEvents(MoveTemp(frames));
+	}
+}
+
+void FCLTraceExporter::ReleaseDevice(cl_device_id device)
+{
+	FScopeLock lock(&ClockSyncLock);
+
+	ClockSyncs.Remove(device);
+}
+
+bool FCLTraceExporter::SyncClock(cl_device_id device,
+								 FClockSync& output)
+{
+	FScopeLock lock(&ClockSyncLock);
+
+	FClockSync& sync = ClockSyncs.FindOrAdd(device);
+	if (sync.bSupported)
+	{
+		const double now = FPlatformTime::Seconds();
+		if (sync.HostCycles == 0 || now - sync.LastSyncSeconds > ClockSyncIntervalSeconds)
+		{
+			// Bracket the query and take the midpoint as the host time of the device sample
+			cl_ulong deviceTimestamp = 0;
+			cl_ulong hostTimestamp = 0;
+
+			const uint64 before = FPlatformTime::Cycles64();
+			const cl_int err = clGetDeviceAndHostTimer(device, &deviceTimestamp, &hostTimestamp);
+			const uint64 after = FPlatformTime::Cycles64();
+
+			if (err == CL_SUCCESS)
+			{
+				sync.DeviceNs = deviceTimestamp;
+				sync.HostCycles = before + (after - before) / 2;
+				sync.LastSyncSeconds = now;
+			}
+			else
+			{
+				sync.bSupported = false;
+			}
+		}
+	}
+
+	output = sync;
+	return sync.bSupported;
+}
+
+uint64 FCLTraceExporter::DeviceToCycles(cl_device_id device,
+										uint64 deviceNs,
+										uint64 queuedNs,
+										uint64 enqueueCycles)
+{
+	const double cyclesPerNs = 1e-9 / FPlatformTime::GetSecondsPerCycle64();
+
+	FClockSync sync;
+	if (SyncClock(device, sync))
+		return sync.HostCycles + static_cast<int64>((static_cast<double>(deviceNs) - static_cast<double>(sync.DeviceNs)) * cyclesPerNs);
+
+	// The command was queued at roughly the host time of its enqueue
+	return enqueueCycles + static_cast<int64>((static_cast<double>(deviceNs) - static_cast<double>(queuedNs)) * cyclesPerNs);
+}
+
+void FCLTraceExporter::AddTimingEvent(FName name,
+									  cl_device_id device,
+									  uint64 startNs,
+									  uint64 endNs,
+									  uint64 queuedNs,
+									  uint64 enqueueCycles,
+									  TMap<cl_device_id, FTimingFrame>& timingFrames)
+{
+	FTimingFrame* frame = timingFrames.Find(device);
+	if (!frame)
+	{
+		frame = &timingFrames.Add(device);
+
+		// Devices without a host timer correlate the first command's queued time with its enqueue
+		FClockSync sync;
+		const bool bSynced = SyncClock(device, sync);
+		frame->CalibrationDeviceNs = bSynced ? sync.DeviceNs : queuedNs;
+		frame->CalibrationHostCycles = bSynced ? sync.HostCycles : enqueueCycles;
+	}
+
+	frame->Events.Add({ name, startNs, endNs });
+}
+
+void FCLTraceExporter::Emit(const TCHAR* name,
+							const TCHAR* category,
+							cl_command_queue queue,
+							uint64 startCycles,
+							uint64 endCycles,
+							uint64 bytes)
+{
+	if (startCycles < CaptureStartCycles)
+		return;
+
+	int32* queueIndex = CaptureQueues.Find(queue);
+	if (!queueIndex)
+		queueIndex = &CaptureQueues.Add(queue, CaptureQueues.Num());
+
+	const double startUs = FPlatformTime::ToSeconds64(startCycles - CaptureStartCycles) * 1e6;
+	const double durationUs = FPlatformTime::ToSeconds64(endCycles > startCycles ? endCycles - startCycles : 0) * 1e6;
+
+	CaptureEvents.Add(FString::Printf(TEXT("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%llu}}"),
+									  name, 
+									  category, 
+									  *queueIndex, 
+									  startUs, 
+									  durationUs, 
+									  bytes));
+}
+
+void FCLTraceExporter::EmitTimingEvents(TArray<FTimingFrame>&& timingFrames)
+{
+	for (FTimingFrame& frame : timingFrames)
+	{
+		frame.Events.Sort([](const FTimingEvent& a, const FTimingEvent& b)
+		{
+			return a.StartNs < b.StartNs;
+		});
+	}
+
+	const uint32 gpuIndex = static_cast<uint32>(FMath::Max(CVarCLWorksTraceGPUIndex.GetValueOnGameThread(), 0));
+
+	// The GPU trace records one frame at a time from the thread the RHI profiles on
+	ENQUEUE_RENDER_COMMAND(CLWorksTimingEvents)([timingFrames = MoveTemp(timingFrames), gpuIndex](FRHICommandListImmediate& RHICmdList)
+	{
+		RHICmdList.EnqueueLambda([timingFrames, gpuIndex](FRHICommandListImmediate&)
+		{
+			for (const FTimingFrame& frame : timingFrames)
+			{
+				// Events stay in device time, Insights maps them onto the host timeline through the calibration
+				FGPUTimingCalibrationTimestamp calibration;
+				calibration.GPUMicroseconds = frame.CalibrationDeviceNs / 1000;
+				calibration.CPUMicroseconds = ToMicroseconds(frame.CalibrationHostCycles);
+
+				FGpuProfilerTrace::BeginFrame(calibration);
+
+				// The track shows one command at a time, commands overlapping from other queues are clipped
+				uint64 lastEndUs = 0;
+				for (const FTimingEvent& event : frame.Events)
+				{
+					const uint64 startUs = FMath::Max(event.StartNs / 1000, lastEndUs);
+					const uint64 endUs = event.EndNs / 1000;
+					if (endUs <= startUs)
+						continue;
+
+					FGpuProfilerTrace::SpecifyEventByName(event.Name);
+					FGpuProfilerTrace::BeginEventByName(event.Name, GFrameNumberRenderThread, startUs);
+					FGpuProfilerTrace::EndEvent(endUs);
+
+					lastEndUs = endUs;
+				}
+
+				FGpuProfilerTrace::EndFrame(gpuIndex);
+			}
+		});
+	});
+}
@@ -0,0 +1,442 @@
+#include "Profiler/CLWorkGroupTuner.h"
+
+#include "CLWorksLog.h"
+
+#include "Core/CLDeviceCapabilities.h"
+
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarCLWorksAutoTune(
+		TEXT("CLWorks.AutoTune"),
+		true,
+		TEXT("Tunes the local work size of dispatches that don't specify one.\n")
+		TEXT("Trials and lookups only run on profiling queues, a kernel reuses its tuned sizes on all queues."),
+		ECVF_Default);
+
+	FAutoConsoleCommand ResetAutoTuneCommand(
+		TEXT("CLWorks.AutoTune.Reset"),
+		TEXT("Drops all tuned local work sizes, including the persisted ones."),
+		FConsoleCommandDelegate::CreateStatic(&FCLWorkGroupTuner::Reset));
+
+	// Samples per candidate, the median is kept to ignore outliers
+	constexpr int32 SamplesPerCandidate = 3;
+
+	constexpr int32 MaxCandidates = 12;
+
+	struct FEntry
+	{
+		// A zero size is the driver's choice
+		TArray<FIntVector> Candidates;
+		TArray<TArray<uint64>> Samples;
+
+		int32 NextTrial = 0;
+		int32 PendingTrials = 0;
+
+		bool bTuned = false;
+		FIntVector Best = FIntVector::ZeroValue;
+	};
+
+	FRWLock TunerLock;
+	// Keyed by kernel name, program source hash, device name and size class, kernels rebuilt
+	// from the same source share their entry with the persisted sizes
+	TMap<FString, FEntry> Entries;
+
+	bool bLoaded = false;
+	bool bDirty = false;
+	TMap<FString, FIntVector> PersistedSizes;
+
+	FString GetTuningFile()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CLWorks"), TEXT("WorkGroupTuning.json"));
+	}
+
+	// Buckets each dimension by its power of two so similar dispatches share a tuning
+	uint32 GetSizeClass(size_t work_dim, const size_t* global_work_size)
+	{
+		uint32 sizeClass = static_cast<uint32>(work_dim);
+		for (size_t i = 0; i < work_dim; ++i)
+			sizeClass |= FMath::CeilLogTwo64(global_work_size[i]) << (8 + i * 8);
+		return sizeClass;
+	}
+
+	FString GetEntryKey(const OpenCL::Kernel::KernelInfo& info, 
+						cl_device_id device, 
+						uint32 sizeClass)
+	{
+		const OpenCL::DeviceCapabilitiesPtr caps = OpenCL::DeviceCapabilities::Get(device);
+		return FString::Printf(TEXT("%s|%016llx|%s|%08x"), UTF8_TO_TCHAR(info.Name.c_str()),
+														   static_cast<unsigned long long>(info.ProgramHash),
+														   UTF8_TO_TCHAR(caps->Name.c_str()),
+														   sizeClass);
+	}
+
+	void LoadPersisted()
+	{
+		bLoaded = true;
+
+		FString json;
+		if (!FFileHelper::LoadFileToString(json, *GetTuningFile()))
+			return;
+
+		TSharedPtr<FJsonObject> root;
+		TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+		if (!FJsonSerializer::Deserialize(reader, root) || !root.IsValid())
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Work Group Tuning File: %s"), *GetTuningFile());
+			return;
+		}
+
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& entry : root->Values)
+		{
+			const TArray<TSharedPtr<FJsonValue>>* size = nullptr;
+			if (!entry.Value->TryGetArray(size) || size->Num() != 3)
+				continue;
+
+			PersistedSizes.Add(entry.Key, FIntVector((*size)[0]->AsNumber(), (*size)[1]->AsNumber(), (*size)[2]->AsNumber()));
+		}
+	}
+
+	void AddPowerOfTwoSizes(TArray<size_t>& output, size_t limit)
+	{
+		for (size_t size = 1; size <= limit; size <<= 1)
+			output.Add(size);
+	}
+
+	void BuildCandidates(FEntry& entry,
+						 const OpenCL::Kernel::KernelInfo& info,
+						 const OpenCL::DeviceCapabilities& device,
+						 size_t work_dim,
+						 const size_t* global_work_size)
+	{
+		entry.Candidates.Add(FIntVector::ZeroValue);
+
+		const size_t maxSize = info.WorkGroupSize;
+		const size_t multiple = FMath::Max<size_t>(info.PreferredWorkGroupMultiple, 1);
+
+		TArray<size_t> sizesX;
+		TArray<size_t> sizesY;
+		AddPowerOfTwoSizes(sizesX, FMath::Min(maxSize, device.MaxWorkItemSizes[0]));
+		if (work_dim > 1)
+			AddPowerOfTwoSizes(sizesY, FMath::Min(maxSize, device.MaxWorkItemSizes[1]));
+		else
+			sizesY.Add(1);
+
+		// Largest groups first, they're usually the fastest and get trialed before the list is capped
+		for (int32 x = sizesX.Num() - 1; x >= 0; --x)
+		{
+			for (int32 y = sizesY.Num() - 1; y >= 0; --y)
+			{
+				const size_t sizeX = sizesX[x];
+				const size_t sizeY = sizesY[y];
+				const size_t total = sizeX * sizeY;
+
+				if (total > maxSize || total % multiple != 0)
+					continue;
+
+				// Uniform work-groups must divide the global size
+				if (global_work_size[0] % sizeX != 0 || (work_dim > 1 && global_work_size[1] % sizeY != 0))
+					continue;
+
+				entry.Candidates.Add(FIntVector(sizeX, sizeY, 1));
+				if (entry.Candidates.Num() >= MaxCandidates)
+					break;
+			}
+
+			if (entry.Candidates.Num() >= MaxCandidates)
+				break;
+		}
+
+		entry.Samples.SetNum(entry.Candidates.Num());
+	}
+
+	uint64 GetMedian(TArray<uint64> samples)
+	{
+		samples.Sort();
+		return samples[samples.Num() / 2];
+	}
+
+	void FinishTuning(const FString& key, FEntry& entry)
+	{
+		uint64 bestTime = MAX_uint64;
+		for (int32 i = 0; i < entry.Candidates.Num(); ++i)
+		{
+			if (entry.Samples[i].Num() == 0)
+				continue;
+
+			const uint64 median = GetMedian(entry.Samples[i]);
+			if (median < bestTime)
+			{
+				bestTime = median;
+				entry.Best = entry.Candidates[i];
+			}
+		}
+
+		entry.bTuned = true;
+		entry.Samples.Empty();
+
+		PersistedSizes.Add(key, entry.Best);
+		bDirty = true;
+
+		UE_LOG(LogCLWorks, Log, TEXT("Tuned Work Group Size: %s -> %d x %d x %d"), *key, entry.Best.X, entry.Best.Y, entry.Best.Z);
+
+		AsyncTask(ENamedThreads::GameThread, []()
+		{
+			FCLWorkGroupTuner::Save();
+		});
+	}
+
+	// Size classes share a size between global sizes, it only applies where it divides them
+	bool DividesGlobalSize(const FIntVector& size, size_t work_dim, const size_t* global_work_size)
+	{
+		const int32 sizes[3] = { size.X, size.Y, size.Z };
+		for (size_t i = 0; i < work_dim; ++i)
+		{
+			if (sizes[i] <= 0 || global_work_size[i] % sizes[i] != 0)
+				return false;
+		}
+		return true;
+	}
+
+	const size_t* ToLocalSize(const FIntVector& size, size_t work_dim, const size_t* global_work_size, size_t* output)
+	{
+		if (size == FIntVector::ZeroValue || !DividesGlobalSize(size, work_dim, global_work_size))
+			return nullptr;
+
+		output[0] = size.X;
+		output[1] = size.Y;
+		output[2] = size.Z;
+		return output;
+	}
+
+	struct FTrialRecord
+	{
+		FCLWorkGroupTuner::FTrial Trial;
+	};
+
+	void CL_CALLBACK OnTrialComplete(cl_event event, cl_int status, void* userData)
+	{
+		FTrialRecord* record = static_cast<FTrialRecord*>(userData);
+
+		cl_ulong start = 0;
+		cl_ulong end = 0;
+		const bool isTimed = status == CL_COMPLETE &&
+							 clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr) == CL_SUCCESS &&
+							 clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, nullptr) == CL_SUCCESS;
+		clReleaseEvent(event);
+
+		{
+			FWriteScopeLock lock(TunerLock);
+
+			const FCLWorkGroupTuner::FTrial& trial = record->Trial;
+			FEntry* entry = Entries.Find(trial.mKey);
+			if (entry && !entry->bTuned)
+			{
+				if (isTimed && end > start)
+					entry->Samples[trial.mCandidate].Add(end - start);
+
+				--entry->PendingTrials;
+				if (entry->PendingTrials == 0 && entry->NextTrial >= entry->Candidates.Num() * SamplesPerCandidate)
+					FinishTuning(trial.mKey, *entry);
+			}
+		}
+
+		delete record;
+	}
+}
+
+bool FCLWorkGroupTuner::IsEnabled()
+{
+	return CVarCLWorksAutoTune.GetValueOnAnyThread();
+}
+
+const size_t* FCLWorkGroupTuner::SelectLocalSize(const OpenCL::CommandQueue& queue,
+												 const OpenCL::Kernel& kernel,
+												 size_t work_dim,
+												 const size_t* global_work_size,
+												 size_t* output,
+												 FTrial& trial)
+{
+	const std::shared_ptr<const OpenCL::Kernel::KernelInfo>& info = kernel.GetInfo();
+	if (!info || work_dim == 0 || work_dim > 3)
+		return nullptr;
+
+	// Kernels declaring reqd_work_group_size must be dispatched with it
+	if (info->CompileWorkGroupSize[0] != 0)
+		return nullptr;
+
+	// Tuned kernels skip the shared lookup
+	const uint32 sizeClass = GetSizeClass(work_dim, global_work_size);
+	size_t cached[3] = {};
+	if (kernel.FindLocalSize(queue.GetDeviceId(), sizeClass, cached))
+		return ToLocalSize(FIntVector(cached[0], cached[1], cached[2]), work_dim, global_work_size, output);
+
+	// Trials are only timed on profiling queues, others don't pay for the lookup
+	if (!queue.IsProfiling())
+		return nullptr;
+
+	const FString key = GetEntryKey(*info, queue.GetDeviceId(), sizeClass);
+
+	auto UseTunedSize = [&](const FIntVector& best)
+	{
+		const size_t size[3] = { static_cast<size_t>(best.X), static_cast<size_t>(best.Y), static_cast<size_t>(best.Z) };
+		kernel.CacheLocalSize(queue.GetDeviceId(), sizeClass, size);
+		return ToLocalSize(best, work_dim, global_work_size, output);
+	};
+
+	{
+		FReadScopeLock lock(TunerLock);
+
+		const FEntry* entry = Entries.Find(key);
+		if (entry && entry->bTuned)
+			return UseTunedSize(entry->Best);
+	}
+
+	FWriteScopeLock lock(TunerLock);
+
+	if (!bLoaded)
+		LoadPersisted();
+
+	FEntry* entry = Entries.Find(key);
+	if (!entry)
+	{
+		entry = &Entries.Add(key);
+
+		if (const FIntVector* persisted = PersistedSizes.Find(key))
+		{
+			entry->bTuned = true;
+			entry->Best = *persisted;
+		}
+		else
+		{
+			BuildCandidates(*entry, *info, *OpenCL::DeviceCapabilities::Get(queue.GetDeviceId()), work_dim, global_work_size);
+
+			// Nothing to choose from
+			if (entry->Candidates.Num() <= 1)
+				entry->bTuned = true;
+		}
+	}
+
+	if (entry->bTuned)
+		return UseTunedSize(entry->Best);
+
+	// Rejected candidates aren't trialed again. Candidates were built for the first global size of
+	// the class, those not dividing this dispatch's size skip their trial so tuning keeps moving
+	auto IsSkipped = [&](int32 trialIndex)
+	{
+		const FIntVector& size = entry->Candidates[trialIndex % entry->Candidates.Num()];
+		return size.X < 0 || (size != FIntVector::ZeroValue && !DividesGlobalSize(size, work_dim, global_work_size));
+	};
+
+	const int32 trialCount = entry->Candidates.Num() * SamplesPerCandidate;
+	while (entry->NextTrial < trialCount && IsSkipped(entry->NextTrial))
+		++entry->NextTrial;
+
+	if (entry->NextTrial >= trialCount)
+	{
+		if (entry->PendingTrials == 0)
+			FinishTuning(key, *entry);
+		return nullptr;
+	}
+
+	const int32 candidate = entry->NextTrial % entry->Candidates.Num();
+	const FIntVector& size = entry->Candidates[candidate];
+
+	++entry->NextTrial;
+	++entry->PendingTrials;
+
+	trial.mKey = key;
+	trial.mCandidate = candidate;
+
+	return ToLocalSize(size, work_dim, global_work_size, output);
+}
+
+void FCLWorkGroupTuner::RecordTrial(const FTrial& trial, 
+									cl_event event)
+{
+	if (!trial.IsActive())
+		return;
+
+	if (event && clRetainEvent(event) == CL_SUCCESS)
+	{
+		FTrialRecord* record = new FTrialRecord{ trial };
+		if (clSetEventCallback(event, CL_COMPLETE, &OnTrialComplete, record) == CL_SUCCESS)
+			return;
+
+		clReleaseEvent(event);
+		delete record;
+	}
+
+	RejectTrial(trial);
+}
+
+void FCLWorkGroupTuner::RejectTrial(const FTrial& trial)
+{
+	if (!trial.IsActive())
+		return;
+
+	FWriteScopeLock lock(TunerLock);
+
+	FEntry* entry = Entries.Find(trial.mKey);
+	if (!entry || entry->bTuned)
+		return;
+
+	// Without samples the candidate is never chosen
+	entry->Samples[trial.mCandidate].Empty();
+	entry->Candidates[trial.mCandidate] = FIntVector(-1);
+
+	--entry->PendingTrials;
+	if (entry->PendingTrials == 0 && entry->NextTrial >= entry->Candidates.Num() * SamplesPerCandidate)
+		FinishTuning(trial.mKey, *entry);
+}
+
+void FCLWorkGroupTuner::Save()
+{
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+
+	{
+		FWriteScopeLock lock(TunerLock);
+
+		if (!bDirty)
+			return;
+		bDirty = false;
+
+		for (const TPair<FString, FIntVector>& entry : PersistedSizes)
+		{
+			TArray<TSharedPtr<FJsonValue>> size;
+			size.Add(MakeShared<FJsonValueNumber>(entry.Value.X));
+			size.Add(MakeShared<FJsonValueNumber>(entry.Value.Y));
+			size.Add(MakeShared<FJsonValueNumber>(entry.Value.Z));
+			root->SetArrayField(entry.Key, size);
+		}
+	}
+
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+
+	if (!FFileHelper::SaveStringToFile(json, *GetTuningFile()))
+		UE_LOG(LogCLWorks, Warning, TEXT("Failed Writing Work Group Tuning File: %s"), *GetTuningFile());
+}
+
+void FCLWorkGroupTuner::Reset()
+{
+	FWriteScopeLock lock(TunerLock);
+
+	Entries.Empty();
+	PersistedSizes.Empty();
+	bDirty = false;
+	bLoaded = true;
+
+	IFileManager::Get().Delete(*GetTuningFile(), false, false, true);
+}
@@ -0,0 +1,70 @@
+#include "Profiler/CLWorksInstrumentation.h"
+
+#include "Profiler/CLProfilerManager.h"
+#include "Profiler/CLTraceExporter.h"
+#include "Profiler/CLWorkGroupTuner.h"
+
+bool FCLWorksInstrumentation::IsProfilingEnabled() const
+{
+	return FCLProfilerManager::IsProfilingEnabled();
+}
+
+const size_t* FCLWorksInstrumentation::SelectLocalSize(const OpenCL::CommandQueue& queue,
+													   const OpenCL::Kernel& kernel,
+													   size_t work_dim,
+													   const size_t* global_work_size,
+													   size_t* output,
+													   std::shared_ptr<void>& dispatchData)
+{
+	if (!FCLWorkGroupTuner::IsEnabled())
+		return nullptr;
+
+	FCLWorkGroupTuner::FTrial trial;
+	const size_t* localSize = FCLWorkGroupTuner::SelectLocalSize(queue, kernel, work_dim, global_work_size, output, trial);
+
+	if (trial.IsActive())
+		dispatchData = std::make_shared<FCLWorkGroupTuner::FTrial>(MoveTemp(trial));
+	return localSize;
+}
+
+void FCLWorksInstrumentation::OnDispatchRejected(const std::shared_ptr<void>& dispatchData)
+{
+	if (dispatchData)
+		FCLWorkGroupTuner::RejectTrial(*std::static_pointer_cast<FCLWorkGroupTuner::FTrial>(dispatchData));
+}
+
+void FCLWorksInstrumentation::OnKernelEnqueued(const OpenCL::CommandQueue& queue,
+											   const OpenCL::Kernel& kernel,
+											   cl_event event,
+											   size_t work_dim,
+											   const size_t* global_work_size,
+											   const size_t* local_work_size,
+											   const std::shared_ptr<void>& dispatchData)
+{
+	// The tuner retains its own reference of the event
+	if (dispatchData)
+		FCLWorkGroupTuner::RecordTrial(*std::static_pointer_cast<FCLWorkGroupTuner::FTrial>(dispatchData), event);
+
+	if (event)
+		FCLProfilerManager::EnqueueProfiledKernel(queue, kernel, event, work_dim, global_work_size, local_work_size);
+}
+
+void FCLWorksInstrumentation::OnTransferEnqueued(const OpenCL::CommandQueue& queue,
+												 cl_event event,
+												 OpenCL::TransferDirection direction,
+												 OpenCL::TransferCommand command,
+												 uint64_t bytes,
+												 OpenCL::MemoryStrategy strategy)
+{
+	FCLProfilerManager::EnqueueProfiledTransfer(queue, event, direction, command, bytes, strategy);
+}
+
+void FCLWorksInstrumentation::OnQueueReleased(const OpenCL::CommandQueue& queue)
+{
+	FCLProfilerManager::ReleaseQueueStats(queue);
+}
+
+void FCLWorksInstrumentation::OnDeviceReleased(cl_device_id device)
+{
+	FCLTraceExporter::ReleaseDevice(device);
+}
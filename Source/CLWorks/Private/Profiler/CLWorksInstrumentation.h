@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Core/CLInstrumentation.h"
+
+/// <summary>
+/// Connects the core's dispatches and transfers to the profiler and the work-group tuner.
+/// </summary>
+class FCLWorksInstrumentation : public OpenCL::Instrumentation
+{
+public:
+	virtual bool IsProfilingEnabled() const override;
+
+	virtual const size_t* SelectLocalSize(const OpenCL::CommandQueue& queue,
+										  const OpenCL::Kernel& kernel,
+										  size_t work_dim,
+										  const size_t* global_work_size,
+										  size_t* output,
+										  std::shared_ptr<void>& dispatchData) override;
+
+	virtual void OnDispatchRejected(const std::shared_ptr<void>& dispatchData) override;
+
+	virtual void OnKernelEnqueued(const OpenCL::CommandQueue& queue,
+								  const OpenCL::Kernel& kernel,
+								  cl_event event,
+								  size_t work_dim,
+								  const size_t* global_work_size,
+								  const size_t* local_work_size,
+								  const std::shared_ptr<void>& dispatchData) override;
+
+	virtual void OnTransferEnqueued(const OpenCL::CommandQueue& queue,
+									cl_event event,
+									OpenCL::TransferDirection direction,
+									OpenCL::TransferCommand command,
+									uint64_t bytes,
+									OpenCL::MemoryStrategy strategy) override;
+
+	virtual void OnQueueReleased(const OpenCL::CommandQueue& queue) override;
+
+	virtual void OnDeviceReleased(cl_device_id device) override;
+};
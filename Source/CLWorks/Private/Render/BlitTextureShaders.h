@@ -30,8 +30,10 @@ public:
 	using FPermutationDomain = TShaderPermutationDomain<FChannelFormatPermutation>;
 
 	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntPoint, SourceOffset)
+		SHADER_PARAMETER(FIntPoint, DestOffset)
 		SHADER_PARAMETER(FIntPoint, Resolution)
-		SHADER_PARAMETER_SAMPLER(SamplerState, Sampler)
+		SHADER_PARAMETER(FIntVector4, Swizzle)
 
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, Input)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D, Output)
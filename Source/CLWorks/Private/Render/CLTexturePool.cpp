@@ -0,0 +1,147 @@
+#include "Render/CLTexturePool.h"
+
+#include "CLWorksLog.h"
+
+#include "TextureResource.h"
+
+FCLTexturePool* FCLTexturePool::Instance = nullptr;
+
+FCLTexturePool::FCLTexturePool()
+{
+	check(Instance == nullptr);
+	Instance = this;
+}
+
+FCLTexturePool::~FCLTexturePool()
+{
+	if (Instance == this)
+		Instance = nullptr;
+}
+
+void FCLTexturePool::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (TPair<FCLTexturePoolKey, TArray<TObjectPtr<UTexture2D>>>& entry : FreeTextures)
+		Collector.AddReferencedObjects(entry.Value);
+}
+
+UTexture2D* FCLTexturePool::Acquire(const FCLTexturePoolKey& key,
+									bool& isRecycled)
+{
+	check(IsInGameThread());
+
+	isRecycled = false;
+
+	if (key.Width <= 0 || key.Height <= 0 || key.NumMips <= 0 || key.PixelFormat == PF_Unknown)
+	{
+		UE_LOG(LogCLWorks, Warning, TEXT("Invalid Pooled Texture Request: %d x %d (Format: %d, Mips: %d)"), key.Width, key.Height, key.PixelFormat, key.NumMips);
+		return nullptr;
+	}
+
+	if (!Instance)
+		return CreateTexture(key);
+
+	if (TArray<TObjectPtr<UTexture2D>>* freeList = Instance->FreeTextures.Find(key))
+	{
+		while (freeList->Num() > 0)
+		{
+			UTexture2D* texture = freeList->Pop();
+			if (IsValid(texture) && texture->GetResource())
+			{
+				Instance->HandedOutTextures.Add(FObjectKey(texture), FObjectKey());
+
+				isRecycled = true;
+				return texture;
+			}
+		}
+	}
+
+	UTexture2D* texture = CreateTexture(key);
+	if (texture)
+		Instance->HandedOutTextures.Add(FObjectKey(texture), FObjectKey());
+	return texture;
+}
+
+void FCLTexturePool::SetOwner(UTexture2D* texture,
+							  const UObject* owner)
+{
+	check(IsInGameThread());
+
+	if (!Instance || !texture)
+		return;
+
+	// Owned textures keep their owner until they're released
+	FObjectKey* currentOwner = Instance->HandedOutTextures.Find(FObjectKey(texture));
+	if (currentOwner && *currentOwner == FObjectKey())
+		*currentOwner = FObjectKey(owner);
+}
+
+void FCLTexturePool::Release(UTexture2D* texture,
+							 const UObject* owner)
+{
+	check(IsInGameThread());
+
+	if (!Instance || !IsValid(texture))
+		return;
+
+	// Already released or handed out to someone else since
+	const FObjectKey* currentOwner = Instance->HandedOutTextures.Find(FObjectKey(texture));
+	if (!currentOwner || *currentOwner != FObjectKey(owner))
+		return;
+
+	Instance->HandedOutTextures.Remove(FObjectKey(texture));
+
+	// Pool is saturated for this description, let the GC reclaim it.
+	TArray<TObjectPtr<UTexture2D>>& freeList = Instance->FreeTextures.FindOrAdd(GetKey(texture));
+	if (freeList.Num() >= MaxFreeTexturesPerKey)
+		return;
+
+	freeList.Add(texture);
+}
+
+void FCLTexturePool::Trim()
+{
+	if (!Instance)
+		return;
+
+	Instance->FreeTextures.Empty();
+
+	// Handed out textures that were never released and got collected
+	for (auto itr = Instance->HandedOutTextures.CreateIterator(); itr; ++itr)
+	{
+		if (!itr.Key().ResolveObjectPtr())
+			itr.RemoveCurrent();
+	}
+}
+
+UTexture2D* FCLTexturePool::CreateTexture(const FCLTexturePoolKey& key)
+{
+	UTexture2D* texture = NewObject<UTexture2D>(GetTransientPackage(),
+												NAME_None,
+												RF_Transient);
+	texture->SRGB = key.bSRGB;
+
+	FTexturePlatformData* platformData = new FTexturePlatformData();
+	texture->SetPlatformData(platformData);
+	platformData->SizeX = key.Width;
+	platformData->SizeY = key.Height;
+	platformData->SetNumSlices(1);
+	platformData->PixelFormat = key.PixelFormat;
+
+	return texture;
+}
+
+FCLTexturePoolKey FCLTexturePool::GetKey(const UTexture2D* texture)
+{
+	FCLTexturePoolKey key;
+
+	const FTexturePlatformData* platformData = texture->GetPlatformData();
+	if (platformData)
+	{
+		key.Width = platformData->SizeX;
+		key.Height = platformData->SizeY;
+		key.PixelFormat = platformData->PixelFormat;
+		key.NumMips = platformData->Mips.Num();
+	}
+	key.bSRGB = texture->SRGB;
+	return key;
+}
@@ -5,96 +5,187 @@
 
 #include "Render/BlitTextureShaders.h"
 #include "TextureResource.h"
-#include "RHIStaticStates.h"
 #include "Async/Async.h"
 
 namespace UTextureUtils
 {
-	bool BlitTextureToRenderTarget(const TObjectPtr<UTexture2D> source, 
-								   TObjectPtr<UTextureRenderTarget2D>& output, 
-								   FIntPoint subRect,
-								   const std::function<void()>& onWriteComplete)
+	static FBlitTextureShadersCS::ECopyChannelFormat GetCopyChannelFormat(EPixelFormat pixelFormat)
+	{
+		switch (pixelFormat)
+		{
+			case EPixelFormat::PF_R8:
+			case EPixelFormat::PF_R16F:
+			case EPixelFormat::PF_R32_FLOAT:
+				return FBlitTextureShadersCS::ECopyChannelFormat::Float;
+			case EPixelFormat::PF_R8G8:
+			case EPixelFormat::PF_G16R16F:
+			case EPixelFormat::PF_G32R32F:
+				return FBlitTextureShadersCS::ECopyChannelFormat::Float2;
+			case EPixelFormat::PF_R8G8B8A8:
+			case EPixelFormat::PF_FloatRGBA:
+			case EPixelFormat::PF_A32B32G32R32F:
+				return FBlitTextureShadersCS::ECopyChannelFormat::Float4;
+
+			case EPixelFormat::PF_R32_UINT:
+				return FBlitTextureShadersCS::ECopyChannelFormat::UInt;
+			case EPixelFormat::PF_R32G32_UINT:
+				return FBlitTextureShadersCS::ECopyChannelFormat::UInt2;
+			case EPixelFormat::PF_R32G32B32A32_UINT:
+				return FBlitTextureShadersCS::ECopyChannelFormat::UInt4;
+
+			case EPixelFormat::PF_R32_SINT:
+				return FBlitTextureShadersCS::ECopyChannelFormat::SInt;
+			default:
+				return FBlitTextureShadersCS::ECopyChannelFormat::MAX;
+		}
+	}
+
+	bool FBlitBatch::Add(const FBlitRequest& request,
+						 const std::function<void()>& onWriteComplete)
 	{
-		if (!source || !output)
+		if (!request.Source || !request.Output)
 			return false;
-		
-		ENQUEUE_RENDER_COMMAND(CopyTextureCommand)([source, output, subRect, onWriteComplete](FRHICommandListImmediate& RHICmdList)
+
+		const FBlitTextureShadersCS::ECopyChannelFormat format = GetCopyChannelFormat(request.Source->GetPixelFormat());
+		if (format == FBlitTextureShadersCS::ECopyChannelFormat::MAX)
+			return false;
+
+		if (!request.Source->GetResource() || !request.Output->GameThread_GetRenderTargetResource())
+			return false;
+
+		const FIntPoint sourceSize(request.Source->GetSizeX(), request.Source->GetSizeY());
+		const FIntPoint outputSize(request.Output->GetSurfaceWidth(), request.Output->GetSurfaceHeight());
+
+		// Clip the copied region against both textures
+		FIntPoint size = request.Size != FIntPoint::ZeroValue ? request.Size : sourceSize;
+		size = size.ComponentMin(sourceSize - request.SourceOffset);
+		size = size.ComponentMin(outputSize - request.DestOffset);
+		if (size.X <= 0 || size.Y <= 0 || request.SourceOffset.GetMin() < 0 || request.DestOffset.GetMin() < 0)
+			return false;
+
+		FQueuedBlit& blit = mRequests.AddDefaulted_GetRef();
+		blit.Source = request.Source;
+		blit.Output = request.Output;
+		blit.SourceOffset = request.SourceOffset;
+		blit.DestOffset = request.DestOffset;
+		blit.Size = size;
+		blit.Swizzle = request.Swizzle;
+		blit.ChannelFormat = static_cast<uint8>(format);
+
+		if (onWriteComplete)
+			mCallbacks.Add(onWriteComplete);
+
+		return true;
+	}
+
+	bool FBlitBatch::Submit(const std::function<void()>& onBatchComplete)
+	{
+		struct FResolvedBlit
 		{
-			FBlitTextureShadersCS::ECopyChannelFormat format = FBlitTextureShadersCS::ECopyChannelFormat::MAX;
+			FTextureResource* Source = nullptr;
+			FTextureRenderTargetResource* Output = nullptr;
 
-			switch (source->GetPixelFormat())
-			{
-				case EPixelFormat::PF_R8:
-				case EPixelFormat::PF_R16F:
-				case EPixelFormat::PF_R32_FLOAT:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::Float;
-					break;
-				case EPixelFormat::PF_R8G8:
-				case EPixelFormat::PF_G16R16F:
-				case EPixelFormat::PF_G32R32F:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::Float2;
-					break;
-				case EPixelFormat::PF_R8G8B8A8:
-				case EPixelFormat::PF_FloatRGBA:
-				case EPixelFormat::PF_A32B32G32R32F:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::Float4;
-					break;
-
-				case EPixelFormat::PF_R32_UINT:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::UInt;
-					break;
-				case EPixelFormat::PF_R32G32_UINT:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::UInt2;
-					break;
-				case EPixelFormat::PF_R32G32B32A32_UINT:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::UInt4;
-					break;
-
-				case EPixelFormat::PF_R32_SINT:
-					format = FBlitTextureShadersCS::ECopyChannelFormat::SInt;
-					break;
-			}
+			FIntPoint SourceOffset;
+			FIntPoint DestOffset;
+			FIntPoint Size;
+			FIntVector4 Swizzle;
+			uint8 ChannelFormat = 0;
+		};
 
-			if (format == FBlitTextureShadersCS::ECopyChannelFormat::MAX)
-				return;
+		// Resources released after this point are released by render commands enqueued after the batch
+		TArray<FResolvedBlit> requests;
+		requests.Reserve(mRequests.Num());
+		for (const FQueuedBlit& blit : mRequests)
+		{
+			UTexture2D* source = blit.Source.Get();
+			UTextureRenderTarget2D* output = blit.Output.Get();
+			if (!source || !output)
+				continue;
 
+			FTextureResource* sourceResource = source->GetResource();
+			FTextureRenderTargetResource* outputResource = output->GameThread_GetRenderTargetResource();
+			if (!sourceResource || !outputResource)
+				continue;
 
-			FRDGBuilder GraphBuilder(RHICmdList);
+			requests.Add({ sourceResource, outputResource, blit.SourceOffset, blit.DestOffset, blit.Size, blit.Swizzle, blit.ChannelFormat });
+		}
+		mRequests.Reset();
+
+		if (onBatchComplete)
+			mCallbacks.Add(onBatchComplete);
+
+		if (requests.IsEmpty())
+		{
+			// Callbacks still run so their owners can clean up
+			for (const std::function<void()>& callback : mCallbacks)
+				callback();
+			mCallbacks.Reset();
+			return false;
+		}
 
-			TRefCountPtr<IPooledRenderTarget> sourceRT = CreateRenderTarget(source->GetResource()->TextureRHI, TEXT("Source"));
-			FRDGTextureRef source_rdg = GraphBuilder.RegisterExternalTexture(sourceRT);
+		ENQUEUE_RENDER_COMMAND(CopyTextureBatchCommand)([requests = MoveTemp(requests), callbacks = MoveTemp(mCallbacks)](FRHICommandListImmediate& RHICmdList)
+		{
+			FRDGBuilder GraphBuilder(RHICmdList);
 
-			TRefCountPtr<IPooledRenderTarget> outputRT = CreateRenderTarget(output->GetRenderTargetResource()->GetRenderTargetTexture(), TEXT("Output"));
-			FRDGTextureRef output_rdg = GraphBuilder.RegisterExternalTexture(outputRT);
+			// Register each texture once, tiles from the same source or into the same atlas share the registration
+			TMap<FRHITexture*, FRDGTextureRef> registeredTextures;
+			TMap<FRHITexture*, FRDGTextureUAVRef> registeredUAVs;
 
-			FBlitTextureShadersCS::FParameters* parameters = GraphBuilder.AllocParameters<FBlitTextureShadersCS::FParameters>();
-			parameters->Input = source_rdg;
-			parameters->Sampler = TStaticSamplerState<SF_Point, AM_Wrap, AM_Wrap>::GetRHI();
-			parameters->Output = GraphBuilder.CreateUAV(output_rdg);
+			const auto RegisterTexture = [&](FRHITexture* texture, const TCHAR* name) -> FRDGTextureRef
+			{
+				if (FRDGTextureRef* found = registeredTextures.Find(texture))
+					return *found;
 
-			FBlitTextureShadersCS::FPermutationDomain Permutation;
-			Permutation.Set<FBlitTextureShadersCS::FChannelFormatPermutation>(format);
+				TRefCountPtr<IPooledRenderTarget> pooledRT = CreateRenderTarget(texture, name);
+				FRDGTextureRef rdgTexture = GraphBuilder.RegisterExternalTexture(pooledRT);
+				registeredTextures.Add(texture, rdgTexture);
+				return rdgTexture;
+			};
 
 			const FGlobalShaderMap* globalShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
-			auto blitShader = globalShaderMap->GetShader<FBlitTextureShadersCS>(Permutation);
 
+			for (const FResolvedBlit& blit : requests)
+			{
+				FRHITexture* sourceRHI = blit.Source->TextureRHI;
+				FRHITexture* outputRHI = blit.Output->GetRenderTargetTexture();
+				if (!sourceRHI || !outputRHI)
+					continue;
+
+				FRDGTextureRef source_rdg = RegisterTexture(sourceRHI, TEXT("Source"));
+				FRDGTextureRef output_rdg = RegisterTexture(outputRHI, TEXT("Output"));
+
+				FRDGTextureUAVRef* output_uav = registeredUAVs.Find(outputRHI);
+				if (!output_uav)
+					output_uav = &registeredUAVs.Add(outputRHI, GraphBuilder.CreateUAV(output_rdg));
 
-			FIntPoint Size = subRect != FIntPoint::ZeroValue ? subRect : output->GetRenderTargetResource()->GetSizeXY();
+				FBlitTextureShadersCS::FParameters* parameters = GraphBuilder.AllocParameters<FBlitTextureShadersCS::FParameters>();
+				parameters->SourceOffset = blit.SourceOffset;
+				parameters->DestOffset = blit.DestOffset;
+				parameters->Resolution = blit.Size;
+				parameters->Swizzle = blit.Swizzle;
+				parameters->Input = source_rdg;
+				parameters->Output = *output_uav;
 
-			FIntVector GroupCount = FComputeShaderUtils::GetGroupCount(Size, FIntPoint(16, 16));
+				FBlitTextureShadersCS::FPermutationDomain Permutation;
+				Permutation.Set<FBlitTextureShadersCS::FChannelFormatPermutation>(static_cast<FBlitTextureShadersCS::ECopyChannelFormat>(blit.ChannelFormat));
 
-			FComputeShaderUtils::AddPass(GraphBuilder,
-										 RDG_EVENT_NAME("BlitTextureToRT_CS"),
-										 blitShader,
-										 parameters,
-										 GroupCount);
+				auto blitShader = globalShaderMap->GetShader<FBlitTextureShadersCS>(Permutation);
 
-			GraphBuilder.AddPostExecuteCallback([onWriteComplete]()
+				FIntVector GroupCount = FComputeShaderUtils::GetGroupCount(blit.Size, FIntPoint(16, 16));
+
+				FComputeShaderUtils::AddPass(GraphBuilder,
+											 RDG_EVENT_NAME("BlitTextureToRT_CS"),
+											 blitShader,
+											 parameters,
+											 GroupCount);
+			}
+
+			GraphBuilder.AddPostExecuteCallback([callbacks]()
 			{
-				AsyncTask(ENamedThreads::GameThread, [onWriteComplete]
+				AsyncTask(ENamedThreads::GameThread, [callbacks]
 				{
-					if (onWriteComplete)
-						onWriteComplete();
+					for (const std::function<void()>& callback : callbacks)
+						callback();
 				});
 			});
 
@@ -103,4 +194,81 @@ namespace UTextureUtils
 
 		return true;
 	}
+
+	FBlitBatch& GetFrameBatch()
+	{
+		check(IsInGameThread());
+
+		static FBlitBatch FrameBatch;
+		return FrameBatch;
+	}
+
+	void FlushFrameBatch()
+	{
+		FBlitBatch& batch = GetFrameBatch();
+		if (batch.Num() > 0)
+			batch.Submit();
+	}
+
+	bool BlitTextureToRenderTarget(const TObjectPtr<UTexture2D> source, 
+								   TObjectPtr<UTextureRenderTarget2D>& output, 
+								   FIntPoint subRect,
+								   const std::function<void()>& onWriteComplete)
+	{
+		FBlitRequest request;
+		request.Source = source;
+		request.Output = output;
+		request.Size = subRect;
+
+		FBlitBatch batch;
+		if (!batch.Add(request))
+			return false;
+
+		return batch.Submit(onWriteComplete);
+	}
+
+	bool WriteToRenderTarget(void* srcData,
+							 uint32 srcPitch,
+							 TObjectPtr<UTextureRenderTarget2D>& output,
+							 const std::function<void()>& onWriteComplete)
+	{
+		if (!srcData)
+			return false;
+
+		if (!output || !output->GameThread_GetRenderTargetResource())
+		{
+			delete[] static_cast<uint8*>(srcData);
+			return false;
+		}
+
+		const uint32 width = output->GetSurfaceWidth();
+		const uint32 height = output->GetSurfaceHeight();
+
+		// The target may be destroyed or have its resource recreated before the command runs
+		TWeakObjectPtr<UTextureRenderTarget2D> target = output.Get();
+
+		ENQUEUE_RENDER_COMMAND(WriteRenderTargetCommand)([target, srcData, srcPitch, width, height, onWriteComplete](FRHICommandListImmediate& RHICmdList)
+		{
+			UTextureRenderTarget2D* renderTarget = target.Get();
+			FTextureRenderTargetResource* resource = renderTarget ? renderTarget->GetRenderTargetResource() : nullptr;
+
+			// A recreated resource may have a different size than the pixels
+			FRHITexture* texture = resource ? resource->GetRenderTargetTexture() : nullptr;
+			if (texture && texture->GetSizeXY() == FIntPoint(width, height))
+			{
+				const FUpdateTextureRegion2D region(0, 0, 0, 0, width, height);
+				RHICmdList.UpdateTexture2D(texture, 0, region, srcPitch, static_cast<const uint8*>(srcData));
+			}
+
+			delete[] static_cast<uint8*>(srcData);
+
+			AsyncTask(ENamedThreads::GameThread, [onWriteComplete]
+			{
+				if (onWriteComplete)
+					onWriteComplete();
+			});
+		});
+
+		return true;
+	}
 };
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "Interfaces/IPluginManager.h"
 
 #include "CLWorksLib.h"
+#include "Profiler/CLKernelAnalysis.h"
+#include "Render/CLTexturePool.h"
+#include "Render/UTextureUtils.h"
 
 #include "Engine/Texture2D.h"
 #include "Engine/TextureRenderTarget2D.h"
@@ -11,6 +14,8 @@
 #include "Private/UnitTests/TestUWorld.h"
 #include "Kismet/KismetRenderingLibrary.h"
 
+#include <thread>
+
 // Reference: https://minifloppy.it/posts/2024/automated-testing-specs-ue5/#writing-tests
 
 BEGIN_DEFINE_SPEC(FCLUnitTestsSpecs, "CLWorks Unit Test",
@@ -65,6 +70,100 @@ void FCLUnitTestsSpecs::Define()
 			OpenCL::CommandQueue queue(context, mpDefaultDevice);
 			TestTrue(TEXT("Failed Command Queue Creation!"), queue.Get() != nullptr);
 		});
+
+		It("(4) Device Selection", [this]()
+		{
+			const std::vector<OpenCL::DeviceDescription>& devices = OpenCL::DeviceEnumerator::GetDevices();
+			if (!TestTrue(TEXT("No Devices Enumerated!"), !devices.empty()))
+				return;
+
+			TestTrue(TEXT("Out of Range Platform Resolved!"), OpenCL::DeviceEnumerator::GetDevice(0, static_cast<uint32_t>(devices.size())) == nullptr);
+
+			const OpenCL::DeviceDescription* best = OpenCL::DeviceEnumerator::SelectBest(OpenCL::DeviceWorkload::Compute);
+			if (!TestNotNull(TEXT("No Device Selected!"), best))
+				return;
+
+			for (const OpenCL::DeviceDescription& desc : devices)
+			{
+				TestTrue(TEXT("Selected Device Outscored!"), OpenCL::DeviceEnumerator::Score(desc, OpenCL::DeviceWorkload::Compute) <= OpenCL::DeviceEnumerator::Score(*best, OpenCL::DeviceWorkload::Compute));
+			}
+
+			OpenCL::DevicePtr device = OpenCL::MakeBestDevice(OpenCL::DeviceWorkload::Compute);
+			TestTrue(TEXT("Invalid Selected Device!"), device && device->Get() == best->Device);
+		});
+
+		It("(5) Device Capabilities", [this]()
+		{
+			const OpenCL::DeviceCapabilities& caps = mpDefaultDevice->GetCapabilities();
+
+			TestTrue(TEXT("Capabilities Not Shared!"), &caps == OpenCL::DeviceCapabilities::Get(mpDefaultDevice->Get()).get());
+			TestTrue(TEXT("Missing Work Group Limit!"), caps.MaxWorkGroupSize > 0 && caps.MaxWorkItemSizes[0] > 0);
+			TestTrue(TEXT("Missing Alignment!"), caps.BaseAddressAlignment > 0);
+			TestEqual(TEXT("Mismatched Half Support!"), caps.bHalfSupport, mpDefaultDevice->IsExtensionSupported("cl_khr_fp16"));
+
+			if (caps.bImageSupport)
+				TestTrue(TEXT("RGBA8 Image Format Missing!"), caps.IsImageFormatSupported(CL_RGBA, CL_UNORM_INT8));
+		});
+
+		It("(6) CPU Partitioning", [this]()
+		{
+			const OpenCL::DeviceDescription* cpu = OpenCL::DeviceEnumerator::SelectBest(OpenCL::DeviceWorkload::General, CL_DEVICE_TYPE_CPU);
+			if (!cpu)
+			{
+				AddInfo(TEXT("No CPU Device, Skipping Partitioning."));
+				return;
+			}
+
+			OpenCL::DevicePtr parent = std::make_shared<OpenCL::Device>(*cpu);
+			const OpenCL::DeviceCapabilities& caps = parent->GetCapabilities();
+			if (!caps.IsPartitionTypeSupported(CL_DEVICE_PARTITION_EQUALLY) || caps.ComputeUnits < 2)
+			{
+				AddInfo(TEXT("CPU Device Can't Be Partitioned Equally, Skipping."));
+				return;
+			}
+
+			std::vector<OpenCL::DevicePtr> subDevices = OpenCL::CreateSubDevicesEqually(parent, caps.ComputeUnits / 2);
+			if (!TestTrue(TEXT("Missing Sub-Devices!"), subDevices.size() >= 2))
+				return;
+
+			for (const OpenCL::DevicePtr& subDevice : subDevices)
+			{
+				TestTrue(TEXT("Sub-Device Not Parented!"), subDevice->IsSubDevice() && subDevice->GetParent() == parent);
+				TestEqual(TEXT("Sub-Device Compute Units"), subDevice->GetCapabilities().ComputeUnits, caps.ComputeUnits / 2);
+			}
+
+			for (const OpenCL::DevicePartition& partition : OpenCL::MakePartitions(subDevices))
+				TestTrue(TEXT("Invalid Partition Queue!"), partition.Queue && partition.Queue->Get() != nullptr);
+		});
+
+		It("(7) Shared Registry", [this]()
+		{
+			OpenCL::DevicePtr device = OpenCL::Registry::GetDevice();
+			if (!TestNotNull(TEXT("No Shared Device!"), device.get()))
+				return;
+
+			TestTrue(TEXT("Device Not Shared!"), device == OpenCL::Registry::GetDevice());
+
+			OpenCL::ContextPtr context = OpenCL::Registry::GetContext(device);
+			if (!TestTrue(TEXT("Invalid Shared Context!"), context && context->Get() != nullptr))
+				return;
+
+			TestTrue(TEXT("Context Not Shared!"), context == OpenCL::Registry::GetContext(device));
+
+			std::shared_ptr<OpenCL::CommandQueue> queue = OpenCL::Registry::GetQueue(device);
+			TestTrue(TEXT("Queue Not Reused On Thread!"), queue && queue == OpenCL::Registry::GetQueue(device));
+
+			std::shared_ptr<OpenCL::CommandQueue> otherQueue;
+			std::thread([&]() { otherQueue = OpenCL::Registry::GetQueue(device); }).join();
+			TestTrue(TEXT("Queue Shared Across Threads!"), otherQueue && otherQueue != queue);
+
+			const char* source = "__kernel void registry_test(__global int* data) { }";
+			std::shared_ptr<OpenCL::Program> program = OpenCL::Registry::GetProgram("RegistryTest", source, context, device);
+			TestTrue(TEXT("Program Not Cached!"), program && program == OpenCL::Registry::GetProgram("RegistryTest", source, context, device));
+
+			const char* otherSource = "__kernel void registry_test(__global int* data) { data[0] = 1; }";
+			TestTrue(TEXT("Stale Program for Changed Source!"), program != OpenCL::Registry::GetProgram("RegistryTest", otherSource, context, device));
+		});
 	});
 
 	Describe("Kernel Setup", [this]()
@@ -153,6 +252,69 @@ void FCLUnitTestsSpecs::Define()
 
 			TestFalse(TEXT("Set Invalid Kernel Argument!"), kernel.IsValid());
 		});
+
+		It("(6) Kernel Info", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void test(__global float* values, float scale) { }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			OpenCL::Kernel kernel(program, "test");
+			if (!TestTrue(TEXT("Invalid Kernel!"), kernel.IsValid()))
+				return;
+
+			const std::shared_ptr<const OpenCL::Kernel::KernelInfo>& info = kernel.GetInfo();
+			if (!TestNotNull(TEXT("Missing Kernel Info!"), info.get()))
+				return;
+
+			TestTrue(TEXT("Invalid Work Group Size!"), info->WorkGroupSize > 0);
+
+			if (!TestEqual(TEXT("Mismatched Argument Count!"), info->Arguments.size(), (size_t)2))
+				return;
+
+			TestEqual(TEXT("Mismatched Argument Name!"), FString(info->Arguments[1].Name.c_str()), FString(TEXT("scale")));
+			TestEqual(TEXT("Mismatched Address Qualifier!"), info->Arguments[0].AddressQualifier, (cl_kernel_arg_address_qualifier)CL_KERNEL_ARG_ADDRESS_GLOBAL);
+		});
+
+		It("(7) Argument Caching", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void test(__global float* values, float scale, int4 offset) { }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			OpenCL::Kernel kernel(program, "test");
+			if (!TestTrue(TEXT("Invalid Kernel!"), kernel.IsValid()))
+				return;
+
+			TestEqual(TEXT("Mismatched Argument Size!"), kernel.GetInfo()->Arguments[2].Size, sizeof(cl_int4));
+			TestEqual(TEXT("Mismatched Argument Index!"), kernel.GetArgumentIndex("scale"), 1);
+
+			if (!TestTrue(TEXT("Failed to Set Argument By Name!"), kernel.SetArgument("scale", 2.0f)))
+				return;
+
+			TestTrue(TEXT("Changed Argument Not Dirty!"), kernel.IsArgumentDirty(1));
+			TestTrue(TEXT("Failed to Flush Arguments!"), kernel.FlushArguments());
+			TestFalse(TEXT("Flushed Argument Still Dirty!"), kernel.IsArgumentDirty(1));
+
+			kernel.SetArgument(1, 2.0f);
+			TestFalse(TEXT("Unchanged Argument Marked Dirty!"), kernel.IsArgumentDirty(1));
+
+			kernel.SetArgument(1, 3.0f);
+			TestTrue(TEXT("Changed Argument Not Dirty!"), kernel.IsArgumentDirty(1));
+
+			AddExpectedErrorPlain(TEXT("Couldn't Create Kernel Argument!"));
+
+			kernel.SetArgument(1, 2.0);
+			TestFalse(TEXT("Accepted Mismatched Argument Size!"), kernel.IsValid());
+		});
 	});
 
 	Describe("Buffer Handling", [this]()
@@ -391,6 +553,289 @@ void FCLUnitTestsSpecs::Define()
 			//TODO:: Implement
 
 		});
+
+		It("(4) Tuned Work Sizes", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void tuned_offset(__global float* data)\n"
+								   "{ int i = get_global_id(0); \n"
+								   "data[i] += 1; }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			size_t count = 1024;
+			std::vector<float> input_data(count, 0.0f);
+
+			OpenCL::Buffer buffer(mpDefaultDevice, context, input_data.data(), count * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+			if (!TestNotNull(TEXT("Failed Read-Write Buffer Creation!"), buffer.Get()))
+				return;
+
+			OpenCL::Kernel kernel(program, "tuned_offset");
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+			kernel.SetArgument<OpenCL::Buffer>(0, buffer);
+
+			// Enough dispatches to trial every candidate and run with the tuned size
+			const int32 dispatches = 48;
+			for (int32 i = 0; i < dispatches; ++i)
+			{
+				queue.EnqueueRange(kernel, 1, &count);
+				if (!TestTrue(TEXT("Couldn't Enqueue the Queue!"), queue.IsValid()))
+					return;
+			}
+
+			std::vector<float> output_data(count, 0.0f);
+			buffer.Fetch(queue, output_data.data(), count * sizeof(float));
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!TestEqual(TEXT("Tuned Dispatch Result"), output_data[i], static_cast<float>(dispatches)))
+					return;
+			}
+		});
+
+		It("(5) Multi-Device Split", [this]()
+		{
+			// Every device sharing the default device's platform, e.g. a CPU next to the GPU
+			std::vector<OpenCL::DevicePtr> devices;
+			for (const OpenCL::DeviceDescription& desc : OpenCL::DeviceEnumerator::GetDevices())
+			{
+				if (desc.Platform == OpenCL::DeviceEnumerator::GetDevice()->Platform)
+					devices.push_back(std::make_shared<OpenCL::Device>(desc));
+			}
+
+			OpenCL::ContextPtr context = MakeContext(devices);
+			if (!TestTrue(TEXT("Failed Context Creation!"), context->Get() != nullptr))
+				return;
+
+			OpenCL::Program program(context, devices[0]);
+			program.ReadFromString("__kernel void split_scale(__global float* data, float factor)\n"
+								   "{ size_t i = get_global_id(0) - get_global_offset(0); \n"
+								   "data[i] = get_global_id(0) * factor; }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			size_t count = 1 << 16;
+			std::vector<float> data(count, 0.0f);
+
+			OpenCL::Buffer buffer(devices[0], context, data.data(), count * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+			if (!TestNotNull(TEXT("Failed Read-Write Buffer Creation!"), buffer.Get()))
+				return;
+
+			OpenCL::Kernel kernel(program, "split_scale");
+			kernel.SetArgument<OpenCL::Buffer>(0, buffer);
+			kernel.SetArgument<float>(1, 2.0f);
+
+			OpenCL::MultiDeviceExecutor executor(context, devices);
+			if (!TestEqual(TEXT("Missing Executor Devices!"), executor.GetDeviceCount(), devices.size()))
+				return;
+
+			// Several rounds so the split adapts to the measured throughput
+			for (int32 round = 0; round < 4; ++round)
+			{
+				if (!TestTrue(TEXT("Couldn't Enqueue Split Range!"), executor.EnqueueRange(kernel, 1, &count, nullptr, { { 0, &buffer, sizeof(float) } })))
+					return;
+				executor.WaitForFinish();
+			}
+
+			double ratioSum = 0.0;
+			for (size_t i = 0; i < executor.GetDeviceCount(); ++i)
+				ratioSum += executor.GetSplitRatio(i);
+			TestEqual(TEXT("Split Ratios Don't Sum to One!"), ratioSum, 1.0, 1e-6);
+
+			buffer.Fetch(executor.GetQueue(0), data.data(), count * sizeof(float));
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!TestEqual(TEXT("Split Dispatch Result"), data[i], i * 2.0f))
+					return;
+			}
+
+			// A skewed split over one work group per device still times every device
+			std::vector<double> skewed(executor.GetDeviceCount(), 0.0);
+			skewed[0] = 1.0;
+			executor.SetSplitRatios(skewed);
+
+			size_t groupSize = 256;
+			size_t skewedCount = groupSize * executor.GetDeviceCount();
+			if (!TestTrue(TEXT("Couldn't Enqueue Skewed Range!"), executor.EnqueueRange(kernel, 1, &skewedCount, &groupSize, { { 0, &buffer, sizeof(float) } })))
+				return;
+			executor.WaitForFinish();
+
+			for (size_t i = 0; i < executor.GetDeviceCount(); ++i)
+				TestTrue(TEXT("Device Left Unmeasured!"), executor.GetSplitRatio(i) > 0.0);
+		});
+
+		It("(6) Typed Kernel", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void scale_data(__global float* data, __local float* scratch, float scale)\n"
+								   "{ int i = get_global_id(0); \n"
+								   "scratch[get_local_id(0)] = data[i]; \n"
+								   "data[i] = scratch[get_local_id(0)] * scale; }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			AddExpectedErrorPlain(TEXT("Doesn't Match the Signature"));
+
+			OpenCL::TypedKernel<OpenCL::Buffer, OpenCL::LocalMemory, int> mismatched(program, "scale_data");
+			TestFalse(TEXT("Accepted Mismatched Signature!"), mismatched.IsValid());
+
+			OpenCL::TypedKernel<OpenCL::Buffer, OpenCL::LocalMemory, float> kernel(program, "scale_data");
+			if (!TestTrue(TEXT("Invalid Typed Kernel!"), kernel.IsValid()))
+				return;
+
+			size_t count = 4;
+			std::vector<float> data = { 1, 2, 3, 4 };
+
+			OpenCL::Buffer buffer(mpDefaultDevice, context, data.data(), count * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+			if (!TestTrue(TEXT("Couldn't Set Kernel Arguments!"), kernel(buffer, OpenCL::LocalArray<float>(count), 2.0f)))
+				return;
+
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+			queue.EnqueueRange(kernel, 1, &count, &count);
+			if (!TestTrue(TEXT("Couldn't Enqueue the Queue!"), queue.IsValid()))
+				return;
+
+			buffer.Fetch(queue, data.data(), count * sizeof(float));
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!TestEqual(TEXT("Typed Dispatch Result"), data[i], (i + 1) * 2.0f))
+					return;
+			}
+		});
+
+		It("(7) Command Buffer Replay", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void add_value(__global float* data, float value)\n"
+								   "{ int i = get_global_id(0); \n"
+								   "data[i] += value; }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			size_t count = 4;
+			std::vector<float> data(count, 0.0f);
+
+			OpenCL::Buffer buffer(mpDefaultDevice, context, data.data(), count * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+			OpenCL::Kernel kernel(program, "add_value");
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+			kernel.SetArgument<OpenCL::Buffer>(0, buffer);
+			kernel.SetArgument(1, 1.0f);
+
+			OpenCL::CommandBuffer commands(queue);
+			commands.RecordRange(kernel, 1, &count);
+			commands.RecordRange(kernel, 1, &count);
+			if (!TestTrue(TEXT("Couldn't Finalize the Command Buffer!"), commands.Finalize()))
+				return;
+
+			TestFalse(TEXT("Recorded Into a Finalized Command Buffer!"), commands.RecordRange(kernel, 1, &count));
+
+			// Replays with the arguments current at each enqueue
+			TestTrue(TEXT("Couldn't Replay the Command Buffer!"), commands.Enqueue());
+
+			kernel.SetArgument(1, 3.0f);
+			TestTrue(TEXT("Couldn't Replay the Command Buffer!"), commands.Enqueue());
+
+			buffer.Fetch(queue, data.data(), count * sizeof(float));
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!TestEqual(TEXT("Replayed Dispatch Result"), data[i], 8.0f))
+					return;
+			}
+
+			// Transfers replay in recording order, the copy overwrites the front of the fill
+			std::vector<float> copied(count, 0.0f);
+			OpenCL::Buffer copy(mpDefaultDevice, context, copied.data(), count * sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+
+			const float fill = 2.0f;
+			OpenCL::CommandBuffer transfers(queue);
+			transfers.RecordFill(copy, &fill, sizeof(fill), count * sizeof(float));
+			transfers.RecordCopy(buffer, copy, 2 * sizeof(float));
+			if (!TestTrue(TEXT("Couldn't Finalize the Transfers!"), transfers.Finalize()))
+				return;
+
+			TestTrue(TEXT("Couldn't Replay the Transfers!"), transfers.Enqueue());
+
+			copy.Fetch(queue, copied.data(), count * sizeof(float));
+			TestEqual(TEXT("Replayed Copy Result"), copied[0], 8.0f);
+			TestEqual(TEXT("Replayed Fill Result"), copied[count - 1], 2.0f);
+		});
+
+		It("(8) Compute Graph", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+
+			OpenCL::Program program(context, mpDefaultDevice);
+			program.ReadFromString("__kernel void double_data(__global const float* src, __global float* dst)\n"
+								   "{ int i = get_global_id(0); \n"
+								   "dst[i] = src[i] * 2; }");
+
+			if (!TestTrue(TEXT("Invalid Program!"), program.Get() != nullptr))
+				return;
+
+			size_t count = 16;
+			const size_t dataSize = count * sizeof(float);
+			std::vector<float> data(count, 1.0f);
+
+			OpenCL::Buffer input(mpDefaultDevice, context, data.data(), dataSize, OpenCL::AccessType::READ_ONLY, OpenCL::MemoryStrategy::COPY_ONCE);
+			OpenCL::Buffer output(mpDefaultDevice, context, nullptr, dataSize, OpenCL::AccessType::WRITE_ONLY, OpenCL::MemoryStrategy::STREAM);
+
+			OpenCL::TypedKernel<cl_mem, cl_mem> kernel(program, "double_data");
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+			OpenCL::TransientPool pool(context);
+
+			OpenCL::ComputeGraph graph(pool);
+			const OpenCL::GraphResource source = graph.ImportBuffer("Input", input);
+			const OpenCL::GraphResource target = graph.ImportBuffer("Output", output);
+
+			// A chain of four doublings through three transients, the first and last can share memory
+			std::vector<OpenCL::GraphResource> stages = { source };
+			for (int32 i = 0; i < 3; ++i)
+				stages.push_back(graph.CreateBuffer("Stage" + std::to_string(i), dataSize));
+			stages.push_back(target);
+
+			for (size_t i = 0; i + 1 < stages.size(); ++i)
+			{
+				const OpenCL::GraphResource src = stages[i];
+				const OpenCL::GraphResource dst = stages[i + 1];
+				graph.AddPass("Double" + std::to_string(i), { src }, { dst }, [&, src, dst](const OpenCL::ComputeGraph::PassContext& pass)
+				{
+					kernel(pass.Get(src), pass.Get(dst));
+					pass.GetQueue().EnqueueRange(kernel, 1, &count);
+				});
+			}
+
+			// Nothing reads the result, culled
+			const OpenCL::GraphResource unused = graph.CreateBuffer("Unused", dataSize);
+			graph.AddPass("Unused", { source }, { unused }, [&](const OpenCL::ComputeGraph::PassContext& pass)
+			{
+				AddError(TEXT("Culled Pass Executed!"));
+			});
+
+			if (!TestTrue(TEXT("Couldn't Execute the Graph!"), graph.Execute(queue)))
+				return;
+
+			TestEqual(TEXT("Mismatched Executed Passes!"), graph.GetExecutedPassCount(), (size_t)4);
+			TestEqual(TEXT("Transients Weren't Aliased!"), pool.GetAllocatedBytes(), dataSize * 2);
+
+			output.Fetch(queue, data.data(), dataSize);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!TestEqual(TEXT("Graph Result"), data[i], 16.0f))
+					return;
+			}
+		});
 	});
 
 	Describe("Textures", [this]()
@@ -710,6 +1155,248 @@ void FCLUnitTestsSpecs::Define()
 
 			}, TStatId(), nullptr, ENamedThreads::GameThread);
 		});
+
+		It("(5) UTexture2D Pooling", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+			OpenCL::Image cltexture(context,
+									mpDefaultDevice,
+									mDefaultUTextureWidth,
+									mDefaultUTextureHeight,
+									1,
+									OpenCL::Image::Format::RGBA8,
+									OpenCL::Image::Type::Texture2D);
+
+			if (!TestNotNull(TEXT("Failed Texture2D Creation!"), cltexture.Get()))
+				return;
+
+			UTexture2D* first = cltexture.CreateUTexture2D(queue);
+			if (!TestNotNull(TEXT("Failed UTexture2D Creation!"), first))
+				return;
+
+			FCLTexturePool::Release(first);
+
+			UTexture2D* second = cltexture.CreateUTexture2D(queue);
+			TestTrue(TEXT("Released UTexture2D Wasn't Recycled!"), first == second);
+
+			UTexture2D* third = cltexture.CreateUTexture2D(queue, false);
+			TestTrue(TEXT("Mismatched sRGB UTexture2D Was Recycled!"), third != second);
+
+			// Textures are only released by their owner, and only once
+			UCLImageObject* owner = NewObject<UCLImageObject>(GetTransientPackage(), NAME_None, RF_Transient);
+			FCLTexturePool::SetOwner(second, owner);
+			FCLTexturePool::Release(second);
+
+			UTexture2D* unowned = cltexture.CreateUTexture2D(queue);
+			TestTrue(TEXT("Owned UTexture2D Was Released by Another Owner!"), unowned != second);
+
+			FCLTexturePool::Release(second, owner);
+			FCLTexturePool::Release(second, owner);
+
+			UTexture2D* fourth = cltexture.CreateUTexture2D(queue);
+			UTexture2D* fifth = cltexture.CreateUTexture2D(queue);
+			TestTrue(TEXT("Released UTexture2D Wasn't Recycled!"), fourth == second);
+			TestTrue(TEXT("Double Released UTexture2D Was Handed Out Twice!"), fifth != second);
+
+			for (UTexture2D* texture : { third, unowned, fourth, fifth })
+				FCLTexturePool::Release(texture);
+		});
+
+		It("(6) Compressed UTexture2D Creation", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+			OpenCL::Image cltexture(context,
+									mpDefaultDevice,
+									mDefaultUTextureWidth,
+									mDefaultUTextureHeight,
+									1,
+									OpenCL::Image::Format::RGBA8,
+									OpenCL::Image::Type::Texture2D);
+
+			if (!TestNotNull(TEXT("Failed Texture2D Creation!"), cltexture.Get()))
+				return;
+
+			const std::pair<OpenCL::Image::Compression, EPixelFormat> compressions[] =
+			{
+				{ OpenCL::Image::Compression::BC1, PF_DXT1 },
+				{ OpenCL::Image::Compression::BC4, PF_BC4 },
+				{ OpenCL::Image::Compression::BC5, PF_BC5 },
+				{ OpenCL::Image::Compression::BC7, PF_BC7 },
+			};
+
+			for (const std::pair<OpenCL::Image::Compression, EPixelFormat>& compression : compressions)
+			{
+				UTexture2D* texture = cltexture.CreateCompressedUTexture2D(queue, compression.first);
+				if (!TestNotNull(TEXT("Failed Compressed UTexture2D Creation!"), texture))
+					return;
+
+				TestEqual(TEXT("Mismatched Compressed Pixel Format!"), texture->GetPixelFormat(), compression.second);
+				FCLTexturePool::Release(texture);
+			}
+		});
+
+		It("(7) Converted UTexture2D Creation", [this]()
+		{
+			OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+			OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+			const int32 pixelCount = mDefaultUTextureWidth * mDefaultUTextureHeight;
+
+			std::vector<float> pixels(pixelCount * 4, 0.0f);
+			for (int32 i = 0; i < pixelCount; ++i)
+			{
+				pixels[i * 4 + 0] = 1.0f;
+				pixels[i * 4 + 3] = 1.0f;
+			}
+
+			OpenCL::Image cltexture(context,
+									mpDefaultDevice,
+									mDefaultUTextureWidth,
+									mDefaultUTextureHeight,
+									1,
+									OpenCL::Image::Format::RGBA32F,
+									OpenCL::Image::Type::Texture2D);
+
+			if (!TestNotNull(TEXT("Failed Texture2D Creation!"), cltexture.Get()))
+				return;
+
+			const size_t origin[3] = { 0, 0, 0 };
+			const size_t region[3] = { (size_t)mDefaultUTextureWidth, (size_t)mDefaultUTextureHeight, 1 };
+			clEnqueueWriteImage(queue, cltexture, CL_TRUE, origin, region, 0, 0, pixels.data(), 0, nullptr, nullptr);
+
+			std::vector<uint8_t> converted(pixelCount * 4, 0);
+			if (!TestTrue(TEXT("Failed Image Conversion!"), cltexture.FetchConverted(queue, PF_B8G8R8A8, false, converted.data())))
+				return;
+
+			// Red in BGRA order
+			TestEqual(TEXT("Mismatched Blue Channel!"), converted[0], (uint8_t)0);
+			TestEqual(TEXT("Mismatched Green Channel!"), converted[1], (uint8_t)0);
+			TestEqual(TEXT("Mismatched Red Channel!"), converted[2], (uint8_t)255);
+			TestEqual(TEXT("Mismatched Alpha Channel!"), converted[3], (uint8_t)255);
+
+			UTexture2D* texture = cltexture.CreateConvertedUTexture2D(queue, PF_B8G8R8A8);
+			if (!TestNotNull(TEXT("Failed Converted UTexture2D Creation!"), texture))
+				return;
+
+			TestEqual(TEXT("Mismatched Converted Pixel Format!"), texture->GetPixelFormat(), PF_B8G8R8A8);
+			FCLTexturePool::Release(texture);
+
+			// 8-bit images are already encoded, requesting sRGB only reorders their channels
+			const std::vector<uint8_t> pixels8(pixelCount * 4, 128);
+
+			OpenCL::Image cltexture8(context,
+									 mpDefaultDevice,
+									 mDefaultUTextureWidth,
+									 mDefaultUTextureHeight,
+									 1,
+									 OpenCL::Image::Format::RGBA8,
+									 OpenCL::Image::Type::Texture2D);
+
+			if (!TestNotNull(TEXT("Failed Texture2D Creation!"), cltexture8.Get()))
+				return;
+
+			clEnqueueWriteImage(queue, cltexture8, CL_TRUE, origin, region, 0, 0, pixels8.data(), 0, nullptr, nullptr);
+
+			std::vector<uint8_t> converted8(pixelCount * 4, 0);
+			if (!TestTrue(TEXT("Failed Image Conversion!"), cltexture8.FetchConverted(queue, PF_B8G8R8A8, true, converted8.data())))
+				return;
+
+			TestEqual(TEXT("Mismatched Encoded 8-bit Channel!"), converted8[0], (uint8_t)128);
+		});
+
+		LatentIt("(8) UTexture2D Blit Batch", EAsyncExecution::ThreadPool, TestTimeout_S, [this](const FDoneDelegate& Done)
+		{
+			FFunctionGraphTask::CreateAndDispatchWhenReady([Done, this]()
+			{
+				OpenCL::ContextPtr context = MakeContext(mpDefaultDevice);
+				OpenCL::CommandQueue queue(context, mpDefaultDevice);
+
+				OpenCL::Image cltexture(context,
+										mpDefaultDevice,
+										mDefaultUTextureWidth,
+										mDefaultUTextureHeight,
+										1,
+										OpenCL::Image::Format::RGBA8,
+										OpenCL::Image::Type::Texture2D);
+
+				if (!TestNotNull(TEXT("Failed Texture2D Creation!"), cltexture.Get()))
+				{
+					Done.Execute();
+					return;
+				}
+
+				// Green in RGBA order
+				std::vector<uint8_t> green(mDefaultUTextureWidth * mDefaultUTextureHeight * 4, 0);
+				for (size_t i = 0; i < green.size(); i += 4)
+				{
+					green[i + 1] = 255;
+					green[i + 3] = 255;
+				}
+
+				const size_t origin[3] = { 0, 0, 0 };
+				const size_t region[3] = { (size_t)mDefaultUTextureWidth, (size_t)mDefaultUTextureHeight, 1 };
+				clEnqueueWriteImage(queue, cltexture, CL_TRUE, origin, region, 0, 0, green.data(), 0, nullptr, nullptr);
+
+				UTexture2D* source = cltexture.CreateUTexture2D(queue, false);
+				UTexture2D* destroyed = cltexture.CreateUTexture2D(queue, false);
+
+				UTextureRenderTarget2D* rt = NewObject<UTextureRenderTarget2D>(GetTransientPackage(),
+																			   NAME_None,
+																			   RF_Transient);
+				rt->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
+				rt->ClearColor = FLinearColor::Transparent;
+				rt->bAutoGenerateMips = false;
+				rt->bCanCreateUAV = true;
+				rt->InitAutoFormat(mDefaultUTextureWidth, mDefaultUTextureHeight);
+				rt->UpdateResourceImmediate(true);
+
+				if (!TestNotNull(TEXT("Failed UTexture2D Creation!"), source) || !TestNotNull(TEXT("Failed UTexture2D Creation!"), destroyed))
+				{
+					Done.Execute();
+					return;
+				}
+
+				source->AddToRoot();
+				rt->AddToRoot();
+
+				UTextureUtils::FBlitRequest request;
+				request.Source = source;
+				request.Output = rt;
+
+				UTextureUtils::FBlitBatch batch;
+				TestTrue(TEXT("Failed Queuing Blit!"), batch.Add(request));
+
+				// Textures destroyed while queued are skipped on submission
+				request.Source = destroyed;
+				TestTrue(TEXT("Failed Queuing Blit!"), batch.Add(request));
+				TestEqual(TEXT("Mismatched Queued Blits!"), batch.Num(), 2);
+
+				destroyed->MarkAsGarbage();
+
+				const bool submitted = batch.Submit([source, rt, Done, this]()
+				{
+					TUniquePtr<FTestUWorld> tempWorld = MakeUnique<FTestUWorld>();
+
+					FColor rt_color = UKismetRenderingLibrary::ReadRenderTargetPixel(tempWorld->GetWorld(), rt, 0, 0);
+					TestTrue(TEXT("Incorrect Color In Render Target2D!"), rt_color == FColor::Green);
+
+					source->RemoveFromRoot();
+					rt->RemoveFromRoot();
+					rt->ConditionalBeginDestroy();
+
+					tempWorld.Reset();
+
+					Done.Execute();
+				});
+
+				TestTrue(TEXT("Failed Blit Batch Submission!"), submitted);
+				TestEqual(TEXT("Submitted Blit Batch Wasn't Cleared!"), batch.Num(), 0);
+			}, TStatId(), nullptr, ENamedThreads::GameThread);
+		});
 	});
 
 	Describe("Programs", [this]()
@@ -777,4 +1464,41 @@ void FCLUnitTestsSpecs::Define()
 			}
 		});
 	});
+
+	Describe("Profiling", [this]()
+	{
+		It("(1) Theoretical Occupancy", [this]()
+		{
+			FCLHardwareMetrics metrics;
+			metrics.MaxComputeUnits = 8;
+			metrics.MaxWorkGroupSize = 1024;
+			metrics.LocalMemSize = 32 * 1024;
+			metrics.MaxResidentWorkItems = 2048;
+			metrics.PrivateMemSize = 256 * 1024;
+
+			OpenCL::Kernel::KernelInfo info;
+
+			// Limited by resident work items only
+			TestEqual(TEXT("Full Occupancy"), FCLKernelAnalysis::GetTheoreticalOccupancy(metrics, info, 256), 1.0);
+
+			// Two groups of 256 fit in local memory
+			info.LocalMemSize = 16 * 1024;
+			TestEqual(TEXT("Local Memory Limited Occupancy"), FCLKernelAnalysis::GetTheoreticalOccupancy(metrics, info, 256), 0.25);
+
+			// No group fits
+			info.LocalMemSize = 64 * 1024;
+			TestEqual(TEXT("Exceeded Local Memory Occupancy"), FCLKernelAnalysis::GetTheoreticalOccupancy(metrics, info, 256), 0.0);
+
+			// Four groups of 256 fit in private memory
+			info.LocalMemSize = 0;
+			info.PrivateMemSize = 256;
+			TestEqual(TEXT("Private Memory Limited Occupancy"), FCLKernelAnalysis::GetTheoreticalOccupancy(metrics, info, 256), 0.5);
+
+			// Without a resident limit a compute unit holds a single largest group
+			metrics.MaxResidentWorkItems = 0;
+			info.PrivateMemSize = 0;
+			info.LocalMemSize = 16 * 1024;
+			TestEqual(TEXT("Group Size Fallback Occupancy"), FCLKernelAnalysis::GetTheoreticalOccupancy(metrics, info, 256), 0.5);
+		});
+	});
 }
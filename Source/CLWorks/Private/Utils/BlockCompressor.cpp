@@ -0,0 +1,408 @@
+#include "BlockCompressor.h"
+
+#include "CLWorksLog.h"
+
+#include "Utils/BuiltinPrograms.h"
+
+namespace BlockCompressor
+{
+	// Each work item encodes one 4x4 block, texels outside the image clamp to the edge.
+	// Linear (floating point) sources of sRGB textures have their color channels encoded before quantization.
+	static const char* BlockCompressionSource = R"CL(
+inline float linear_to_srgb(float value)
+{
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+inline float4 load_texel(read_only image2d_t src, int x, int y, int width, int height)
+{
+	return read_imagef(src, (int2)(min(x, width - 1), min(y, height - 1)));
+}
+
+inline void load_block(read_only image2d_t src, int bx, int by, int width, int height, int encodeSRGB, float4* texels)
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		float4 texel = clamp(load_texel(src, bx * 4 + (i & 3), by * 4 + (i >> 2), width, height), 0.0f, 1.0f);
+		if (encodeSRGB)
+			texel = (float4)(linear_to_srgb(texel.x), linear_to_srgb(texel.y), linear_to_srgb(texel.z), texel.w);
+		texels[i] = texel;
+	}
+}
+
+// BC1 ---------------------------------------------------------------------------------------------
+inline ushort pack_565(float3 color)
+{
+	const uint r = (uint)(color.x * 31.0f + 0.5f);
+	const uint g = (uint)(color.y * 63.0f + 0.5f);
+	const uint b = (uint)(color.z * 31.0f + 0.5f);
+	return (ushort)((r << 11) | (g << 5) | b);
+}
+
+inline float3 unpack_565(ushort color)
+{
+	return (float3)(((color >> 11) & 31) / 31.0f,
+					((color >> 5) & 63) / 63.0f,
+					(color & 31) / 31.0f);
+}
+
+__kernel void compress_bc1(read_only image2d_t src, __global uint2* dst, int width, int height, int encodeSRGB)
+{
+	const int bx = get_global_id(0);
+	const int by = get_global_id(1);
+	const int blocksX = (width + 3) / 4;
+	if (bx >= blocksX || by >= (height + 3) / 4)
+		return;
+
+	float4 texels[16];
+	load_block(src, bx, by, width, height, encodeSRGB, texels);
+
+	float3 minColor = texels[0].xyz;
+	float3 maxColor = texels[0].xyz;
+	for (int i = 1; i < 16; ++i)
+	{
+		minColor = fmin(minColor, texels[i].xyz);
+		maxColor = fmax(maxColor, texels[i].xyz);
+	}
+
+	// Inset the bounding box, the extremes are rarely the best endpoints
+	const float3 inset = (maxColor - minColor) / 16.0f;
+	minColor = clamp(minColor + inset, 0.0f, 1.0f);
+	maxColor = clamp(maxColor - inset, 0.0f, 1.0f);
+
+	ushort c0 = pack_565(maxColor);
+	ushort c1 = pack_565(minColor);
+	if (c0 < c1)
+	{
+		const ushort tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+	}
+
+	// c0 > c1 selects the four color mode, equal endpoints keep all indices at zero
+	uint indices = 0;
+	if (c0 != c1)
+	{
+		const float3 e0 = unpack_565(c0);
+		const float3 e1 = unpack_565(c1);
+		const float3 palette[4] = { e0, e1, (2.0f * e0 + e1) / 3.0f, (e0 + 2.0f * e1) / 3.0f };
+
+		for (int i = 0; i < 16; ++i)
+		{
+			uint best = 0;
+			float bestError = MAXFLOAT;
+			for (uint p = 0; p < 4; ++p)
+			{
+				const float3 d = texels[i].xyz - palette[p];
+				const float error = dot(d, d);
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= best << (2 * i);
+		}
+	}
+
+	dst[by * blocksX + bx] = (uint2)((uint)c0 | ((uint)c1 << 16), indices);
+}
+
+// BC4 / BC5 ---------------------------------------------------------------------------------------
+inline uint2 encode_bc4(const float* values)
+{
+	float minValue = values[0];
+	float maxValue = values[0];
+	for (int i = 1; i < 16; ++i)
+	{
+		minValue = fmin(minValue, values[i]);
+		maxValue = fmax(maxValue, values[i]);
+	}
+
+	const uint r0 = (uint)(maxValue * 255.0f + 0.5f);
+	const uint r1 = (uint)(minValue * 255.0f + 0.5f);
+
+	ulong bits = (ulong)r0 | ((ulong)r1 << 8);
+
+	// r0 > r1 selects the eight value mode, equal endpoints keep all indices at zero
+	if (r0 > r1)
+	{
+		float palette[8];
+		palette[0] = (float)r0;
+		palette[1] = (float)r1;
+		for (int i = 1; i < 7; ++i)
+			palette[i + 1] = ((7 - i) * (float)r0 + i * (float)r1) / 7.0f;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			const float value = values[i] * 255.0f;
+
+			ulong best = 0;
+			float bestError = MAXFLOAT;
+			for (int p = 0; p < 8; ++p)
+			{
+				const float error = fabs(value - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			bits |= best << (16 + 3 * i);
+		}
+	}
+
+	return (uint2)((uint)bits, (uint)(bits >> 32));
+}
+
+__kernel void compress_bc4(read_only image2d_t src, __global uint2* dst, int width, int height, int encodeSRGB)
+{
+	const int bx = get_global_id(0);
+	const int by = get_global_id(1);
+	const int blocksX = (width + 3) / 4;
+	if (bx >= blocksX || by >= (height + 3) / 4)
+		return;
+
+	float4 texels[16];
+	load_block(src, bx, by, width, height, encodeSRGB, texels);
+
+	float red[16];
+	for (int i = 0; i < 16; ++i)
+		red[i] = texels[i].x;
+
+	dst[by * blocksX + bx] = encode_bc4(red);
+}
+
+__kernel void compress_bc5(read_only image2d_t src, __global uint4* dst, int width, int height, int encodeSRGB)
+{
+	const int bx = get_global_id(0);
+	const int by = get_global_id(1);
+	const int blocksX = (width + 3) / 4;
+	if (bx >= blocksX || by >= (height + 3) / 4)
+		return;
+
+	float4 texels[16];
+	load_block(src, bx, by, width, height, encodeSRGB, texels);
+
+	float red[16];
+	float green[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		red[i] = texels[i].x;
+		green[i] = texels[i].y;
+	}
+
+	const uint2 redBlock = encode_bc4(red);
+	const uint2 greenBlock = encode_bc4(green);
+	dst[by * blocksX + bx] = (uint4)(redBlock.x, redBlock.y, greenBlock.x, greenBlock.y);
+}
+
+// BC7 (Mode 6) ------------------------------------------------------------------------------------
+inline void put_bits(ulong* lo, ulong* hi, int* pos, ulong value, int count)
+{
+	if (*pos < 64)
+	{
+		*lo |= value << *pos;
+		if (*pos + count > 64)
+			*hi |= value >> (64 - *pos);
+	}
+	else
+	{
+		*hi |= value << (*pos - 64);
+	}
+	*pos += count;
+}
+
+// Quantizes an endpoint to 7 bits per channel plus a shared p-bit, returning the squared error.
+inline float quantize_endpoint(float4 color, uint pbit, uint4* quantized)
+{
+	const float4 scaled = color * 255.0f;
+	*quantized = convert_uint4(clamp(round((scaled - (float)pbit) * 0.5f), 0.0f, 127.0f));
+
+	const float4 d = convert_float4((*quantized << 1) | pbit) - scaled;
+	return dot(d, d);
+}
+
+__kernel void compress_bc7(read_only image2d_t src, __global uint4* dst, int width, int height, int encodeSRGB)
+{
+	const int bx = get_global_id(0);
+	const int by = get_global_id(1);
+	const int blocksX = (width + 3) / 4;
+	if (bx >= blocksX || by >= (height + 3) / 4)
+		return;
+
+	float4 texels[16];
+	load_block(src, bx, by, width, height, encodeSRGB, texels);
+
+	float4 minColor = texels[0];
+	float4 maxColor = texels[0];
+	for (int i = 1; i < 16; ++i)
+	{
+		minColor = fmin(minColor, texels[i]);
+		maxColor = fmax(maxColor, texels[i]);
+	}
+
+	// Pick the p-bit of each endpoint that minimizes its quantization error
+	uint4 q0, q1, q_alt;
+	uint p0 = 0;
+	uint p1 = 0;
+	if (quantize_endpoint(minColor, 1, &q_alt) < quantize_endpoint(minColor, 0, &q0))
+	{
+		q0 = q_alt;
+		p0 = 1;
+	}
+	if (quantize_endpoint(maxColor, 1, &q_alt) < quantize_endpoint(maxColor, 0, &q1))
+	{
+		q1 = q_alt;
+		p1 = 1;
+	}
+
+	const float4 e0 = convert_float4((q0 << 1) | p0);
+	const float4 e1 = convert_float4((q1 << 1) | p1);
+	const float4 axis = e1 - e0;
+	const float axisLength = dot(axis, axis);
+
+	const float weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	uint indices[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		uint best = 0;
+		if (axisLength > 0.0f)
+		{
+			const float t = clamp(dot(texels[i] * 255.0f - e0, axis) / axisLength, 0.0f, 1.0f) * 64.0f;
+
+			float bestError = MAXFLOAT;
+			for (uint w = 0; w < 16; ++w)
+			{
+				const float error = fabs(t - weights[w]);
+				if (error < bestError)
+				{
+					bestError = error;
+					best = w;
+				}
+			}
+		}
+		indices[i] = best;
+	}
+
+	// The anchor index is stored without its most significant bit, flip the endpoints if it's set
+	if (indices[0] & 8)
+	{
+		const uint4 q = q0;
+		q0 = q1;
+		q1 = q;
+
+		const uint p = p0;
+		p0 = p1;
+		p1 = p;
+
+		for (int i = 0; i < 16; ++i)
+			indices[i] = 15 - indices[i];
+	}
+
+	ulong lo = 0;
+	ulong hi = 0;
+	int pos = 0;
+
+	put_bits(&lo, &hi, &pos, 1ul << 6, 7);
+
+	put_bits(&lo, &hi, &pos, q0.x, 7);
+	put_bits(&lo, &hi, &pos, q1.x, 7);
+	put_bits(&lo, &hi, &pos, q0.y, 7);
+	put_bits(&lo, &hi, &pos, q1.y, 7);
+	put_bits(&lo, &hi, &pos, q0.z, 7);
+	put_bits(&lo, &hi, &pos, q1.z, 7);
+	put_bits(&lo, &hi, &pos, q0.w, 7);
+	put_bits(&lo, &hi, &pos, q1.w, 7);
+
+	put_bits(&lo, &hi, &pos, p0, 1);
+	put_bits(&lo, &hi, &pos, p1, 1);
+
+	put_bits(&lo, &hi, &pos, indices[0], 3);
+	for (int i = 1; i < 16; ++i)
+		put_bits(&lo, &hi, &pos, indices[i], 4);
+
+	dst[by * blocksX + bx] = (uint4)((uint)lo, (uint)(lo >> 32), (uint)hi, (uint)(hi >> 32));
+}
+)CL";
+
+	size_t GetBlockBytes(OpenCL::Image::Compression compression)
+	{
+		switch (compression)
+		{
+			case OpenCL::Image::Compression::BC1:
+			case OpenCL::Image::Compression::BC4:
+				return 8;
+			case OpenCL::Image::Compression::BC5:
+			case OpenCL::Image::Compression::BC7:
+				return 16;
+			default:
+				return 0;
+		}
+	}
+
+	static const char* GetKernelName(OpenCL::Image::Compression compression)
+	{
+		switch (compression)
+		{
+			case OpenCL::Image::Compression::BC1:
+				return "compress_bc1";
+			case OpenCL::Image::Compression::BC4:
+				return "compress_bc4";
+			case OpenCL::Image::Compression::BC5:
+				return "compress_bc5";
+			case OpenCL::Image::Compression::BC7:
+				return "compress_bc7";
+			default:
+				return nullptr;
+		}
+	}
+
+	bool Compress(std::vector<uint8_t>& output,
+				  const OpenCL::ContextPtr& context,
+				  const OpenCL::DevicePtr& device,
+				  const OpenCL::CommandQueue& queue,
+				  cl_mem image,
+				  uint32_t width,
+				  uint32_t height,
+				  OpenCL::Image::Compression compression,
+				  bool encodeSRGB)
+	{
+		const char* kernelName = GetKernelName(compression);
+		const size_t blockBytes = GetBlockBytes(compression);
+		if (!kernelName || blockBytes == 0)
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Invalid Block Compression: %d"), compression);
+			return false;
+		}
+
+		const size_t blocksX = (width + 3) / 4;
+		const size_t blocksY = (height + 3) / 4;
+		const size_t dataSize = blocksX * blocksY * blockBytes;
+
+		output.resize(dataSize);
+
+		// BC4 and BC5 have no sRGB variant, their channels are always sampled linearly
+		const bool isColor = compression == OpenCL::Image::Compression::BC1 || compression == OpenCL::Image::Compression::BC7;
+		const cl_int srgb = encodeSRGB && isColor ? 1 : 0;
+
+		const size_t global_work_size[2] = { blocksX, blocksY };
+		return BuiltinPrograms::Dispatch("BlockCompression",
+										 BlockCompressionSource,
+										 kernelName,
+										 context,
+										 device,
+										 queue,
+										 image,
+										 width,
+										 height,
+										 global_work_size,
+										 output.data(),
+										 dataSize,
+										 [&](OpenCL::Kernel& kernel)
+										 {
+											 return kernel.SetArgument(4, srgb);
+										 });
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Core/CLImage.h"
+#include "Core/CLCommandQueue.h"
+
+#include <vector>
+
+namespace BlockCompressor
+{
+	/// <summary>
+	/// Retrieves the encoded size of a single 4x4 block.
+	/// </summary>
+	size_t GetBlockBytes(OpenCL::Image::Compression compression);
+
+	/// <summary>
+	/// Encodes a 2D image into BCn blocks on the device and reads back the blocks.
+	/// </summary>
+	/// <param name="output">The encoded blocks in row-major block order</param>
+	/// <param name="context">The image context</param>
+	/// <param name="device">The image device</param>
+	/// <param name="queue">The queue executing the encoding</param>
+	/// <param name="image">The source image</param>
+	/// <param name="width">The image width</param>
+	/// <param name="height">The image height</param>
+	/// <param name="compression">The block format</param>
+	/// <param name="encodeSRGB">Whether color channels are encoded from linear to sRGB, only for linear (floating point) sources</param>
+	/// <returns>True if the image was encoded</returns>
+	bool Compress(std::vector<uint8_t>& output,
+				  const OpenCL::ContextPtr& context,
+				  const OpenCL::DevicePtr& device,
+				  const OpenCL::CommandQueue& queue,
+				  cl_mem image,
+				  uint32_t width,
+				  uint32_t height,
+				  OpenCL::Image::Compression compression,
+				  bool encodeSRGB);
+}
@@ -0,0 +1,113 @@
+#include "BuiltinPrograms.h"
+
+#include "CLWorksLog.h"
+
+#include "Core/CLBuffer.h"
+#include "Core/CLRegistry.h"
+
+#include <map>
+
+namespace BuiltinPrograms
+{
+	namespace
+	{
+		struct CachedKernel
+		{
+			// Expires with the program, its address may then be reused by another one
+			std::weak_ptr<OpenCL::Program> Program;
+			std::unique_ptr<OpenCL::Kernel> Kernel;
+		};
+
+		/// <summary>
+		/// The calling thread's kernel of the program, created on first use. Kernels are kept per thread
+		/// since every dispatch sets its own arguments.
+		/// </summary>
+		OpenCL::Kernel* GetKernel(const std::shared_ptr<OpenCL::Program>& program,
+								  const char* kernelName)
+		{
+			thread_local std::map<std::pair<const OpenCL::Program*, std::string>, CachedKernel> Kernels;
+
+			CachedKernel& cached = Kernels[std::make_pair(program.get(), std::string(kernelName))];
+			if (!cached.Kernel || cached.Program.expired())
+			{
+				cached.Program = program;
+				cached.Kernel = std::make_unique<OpenCL::Kernel>(*program, kernelName);
+			}
+			return cached.Kernel->IsValid() ? cached.Kernel.get() : nullptr;
+		}
+	}
+
+	std::shared_ptr<OpenCL::Program> Get(const std::string& name,
+										 const char* source,
+										 const OpenCL::ContextPtr& context,
+										 const OpenCL::DevicePtr& device)
+	{
+		std::string errMsg;
+		std::shared_ptr<OpenCL::Program> program = OpenCL::Registry::GetProgram(name, source, context, device, &errMsg);
+		if (!program && context && device)
+			UE_LOG(LogCLWorks, Error, TEXT("Failed Building Builtin Program %s: %s"), *FString(name.c_str()), *FString(errMsg.c_str()));
+		return program;
+	}
+
+	bool Dispatch(const std::string& name,
+				  const char* source,
+				  const char* kernelName,
+				  const OpenCL::ContextPtr& context,
+				  const OpenCL::DevicePtr& device,
+				  const OpenCL::CommandQueue& queue,
+				  cl_mem image,
+				  uint32_t width,
+				  uint32_t height,
+				  const size_t globalSize[2],
+				  void* output,
+				  size_t outputSize,
+				  const ArgumentSetter& setArguments)
+	{
+		std::shared_ptr<OpenCL::Program> program = Get(name, source, context, device);
+		if (!program)
+			return false;
+
+		OpenCL::Kernel* kernel = GetKernel(program, kernelName);
+		if (!kernel)
+			return false;
+
+		OpenCL::Buffer buffer(device, context, nullptr, outputSize, OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+		if (!buffer.IsValid())
+			return false;
+
+		const cl_int imageWidth = static_cast<cl_int>(width);
+		const cl_int imageHeight = static_cast<cl_int>(height);
+
+		const bool argsSet = kernel->SetArgument(0, image) &&
+							 kernel->SetArgument<OpenCL::Buffer>(1, buffer) &&
+							 kernel->SetArgument(2, imageWidth) &&
+							 kernel->SetArgument(3, imageHeight) &&
+							 (!setArguments || setArguments(*kernel));
+		if (!argsSet || !kernel->FlushArguments())
+			return false;
+
+		std::shared_ptr<OpenCL::CommandQueue> localqueue;
+		if (!queue.Get())
+			localqueue = OpenCL::Registry::GetQueue(context, device);
+
+		const OpenCL::CommandQueue& target = localqueue ? *localqueue : queue;
+		if (!target.Get())
+			return false;
+
+		cl_int err = clEnqueueNDRangeKernel(target.Get(),
+											kernel->Get(),
+											2,
+											nullptr,
+											globalSize,
+											nullptr,
+											0,
+											nullptr,
+											nullptr);
+		if (err < 0)
+		{
+			UE_LOG(LogCLWorks, Error, TEXT("Couldn't Enqueue Builtin Kernel %s: %d"), *FString(kernelName), err);
+			return false;
+		}
+		return buffer.Fetch(target, output, outputSize);
+	}
+}
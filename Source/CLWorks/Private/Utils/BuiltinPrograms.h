@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Core/CLCommandQueue.h"
+#include "Core/CLContext.h"
+#include "Core/CLDevice.h"
+#include "Core/CLKernel.h"
+#include "Core/CLProgram.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace BuiltinPrograms
+{
+	/// <summary>
+	/// Retrieves a plugin provided program, compiling it once per context through the shared OpenCL::Registry cache.
+	/// </summary>
+	/// <param name="name">The unique program name</param>
+	/// <param name="source">The program source, only compiled on the first request</param>
+	/// <param name="context">The context</param>
+	/// <param name="device">The device</param>
+	/// <returns>The compiled program, or nullptr on failure</returns>
+	std::shared_ptr<OpenCL::Program> Get(const std::string& name,
+										 const char* source,
+										 const OpenCL::ContextPtr& context,
+										 const OpenCL::DevicePtr& device);
+
+	/// <summary>
+	/// Sets the arguments following the image, output buffer and image extent.
+	/// </summary>
+	using ArgumentSetter = std::function<bool(OpenCL::Kernel& kernel)>;
+
+	/// <summary>
+	/// Runs a builtin image kernel over a 2D range and reads its output buffer back. The kernel takes the image,
+	/// the output buffer, the image width and height, followed by the arguments of the setter.
+	/// Kernels are created once per program and thread, then reused by later dispatches.
+	/// </summary>
+	/// <param name="queue">The queue to run on, the registry's queue of the device if it's empty</param>
+	/// <param name="globalSize">The 2D range, e.g. the image's pixels or blocks</param>
+	/// <param name="output">Receives the output buffer's data</param>
+	/// <param name="outputSize">The output buffer's size in bytes</param>
+	/// <returns>False if the kernel couldn't be run or its output couldn't be read</returns>
+	bool Dispatch(const std::string& name,
+				  const char* source,
+				  const char* kernelName,
+				  const OpenCL::ContextPtr& context,
+				  const OpenCL::DevicePtr& device,
+				  const OpenCL::CommandQueue& queue,
+				  cl_mem image,
+				  uint32_t width,
+				  uint32_t height,
+				  const size_t globalSize[2],
+				  void* output,
+				  size_t outputSize,
+				  const ArgumentSetter& setArguments = nullptr);
+}
@@ -0,0 +1,151 @@
+#include "FormatConverter.h"
+
+#include "CLWorksLog.h"
+
+#include "Utils/BuiltinPrograms.h"
+
+namespace FormatConverter
+{
+	// Each work item converts one texel, the swizzle selects the source channel (0-3) or a constant zero (4) / one (5).
+	static const char* FormatConversionSource = R"CL(
+inline float linear_to_srgb(float value)
+{
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+inline float select_channel(float4 texel, int channel)
+{
+	switch (channel)
+	{
+		case 0: return texel.x;
+		case 1: return texel.y;
+		case 2: return texel.z;
+		case 3: return texel.w;
+		case 4: return 0.0f;
+		default: return 1.0f;
+	}
+}
+
+__kernel void convert_unorm8(read_only image2d_t src, __global uchar* dst, int width, int height, int4 swizzle, int channels, int encodeSRGB)
+{
+	const int x = get_global_id(0);
+	const int y = get_global_id(1);
+	if (x >= width || y >= height)
+		return;
+
+	const float4 texel = read_imagef(src, (int2)(x, y));
+	const int swizzles[4] = { swizzle.x, swizzle.y, swizzle.z, swizzle.w };
+
+	const int offset = (y * width + x) * channels;
+	for (int c = 0; c < channels; ++c)
+	{
+		const int channel = swizzles[c];
+
+		float value = clamp(select_channel(texel, channel), 0.0f, 1.0f);
+		if (encodeSRGB && channel < 3)
+			value = linear_to_srgb(value);
+
+		dst[offset + c] = convert_uchar_sat_rte(value * 255.0f);
+	}
+}
+
+__kernel void convert_half(read_only image2d_t src, __global half* dst, int width, int height, int4 swizzle, int channels, int encodeSRGB)
+{
+	const int x = get_global_id(0);
+	const int y = get_global_id(1);
+	if (x >= width || y >= height)
+		return;
+
+	const float4 texel = read_imagef(src, (int2)(x, y));
+	const int swizzles[4] = { swizzle.x, swizzle.y, swizzle.z, swizzle.w };
+
+	const int offset = (y * width + x) * channels;
+	for (int c = 0; c < channels; ++c)
+		vstore_half_rte(select_channel(texel, swizzles[c]), offset + c, dst);
+}
+)CL";
+
+	struct Conversion
+	{
+		const char* mKernelName = nullptr;
+		cl_int mChannels = 0;
+		cl_int4 mSwizzle = {};
+	};
+
+	static bool GetConversion(EPixelFormat format, Conversion& conversion)
+	{
+		switch (format)
+		{
+			case PF_B8G8R8A8:
+				conversion = { "convert_unorm8", 4, {{ 2, 1, 0, 3 }} };
+				return true;
+			case PF_R8G8B8A8:
+				conversion = { "convert_unorm8", 4, {{ 0, 1, 2, 3 }} };
+				return true;
+			case PF_R8G8:
+				conversion = { "convert_unorm8", 2, {{ 0, 1, 4, 4 }} };
+				return true;
+			case PF_R8:
+				conversion = { "convert_unorm8", 1, {{ 0, 4, 4, 4 }} };
+				return true;
+			case PF_FloatRGBA:
+				conversion = { "convert_half", 4, {{ 0, 1, 2, 3 }} };
+				return true;
+			case PF_G16R16F:
+				conversion = { "convert_half", 2, {{ 0, 1, 4, 4 }} };
+				return true;
+			case PF_R16F:
+				conversion = { "convert_half", 1, {{ 0, 4, 4, 4 }} };
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool IsSupported(EPixelFormat format)
+	{
+		Conversion conversion;
+		return GetConversion(format, conversion);
+	}
+
+	bool Convert(void* output,
+				 const OpenCL::ContextPtr& context,
+				 const OpenCL::DevicePtr& device,
+				 const OpenCL::CommandQueue& queue,
+				 cl_mem image,
+				 uint32_t width,
+				 uint32_t height,
+				 EPixelFormat format,
+				 bool encodeSRGB)
+	{
+		Conversion conversion;
+		if (!GetConversion(format, conversion))
+		{
+			UE_LOG(LogCLWorks, Warning, TEXT("Unsupported Conversion Format: %d"), format);
+			return false;
+		}
+
+		const size_t dataSize = static_cast<size_t>(width) * height * GPixelFormats[format].BlockBytes;
+		const cl_int srgb = encodeSRGB ? 1 : 0;
+
+		const size_t global_work_size[2] = { width, height };
+		return BuiltinPrograms::Dispatch("FormatConversion",
+										 FormatConversionSource,
+										 conversion.mKernelName,
+										 context,
+										 device,
+										 queue,
+										 image,
+										 width,
+										 height,
+										 global_work_size,
+										 output,
+										 dataSize,
+										 [&](OpenCL::Kernel& kernel)
+										 {
+											 return kernel.SetArgument(4, conversion.mSwizzle) &&
+													kernel.SetArgument(5, conversion.mChannels) &&
+													kernel.SetArgument(6, srgb);
+										 });
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Core/CLContext.h"
+#include "Core/CLDevice.h"
+#include "Core/CLCommandQueue.h"
+
+#include "PixelFormat.h"
+
+namespace FormatConverter
+{
+	/// <summary>
+	/// Checks whether images can be converted into the pixel format on the device.
+	/// </summary>
+	bool IsSupported(EPixelFormat format);
+
+	/// <summary>
+	/// Converts a normalized or floating point 2D image into the layout of a UE pixel format
+	/// on the device and reads back only the converted pixels.
+	/// </summary>
+	/// <param name="output">The converted pixels, tightly packed (width * BlockBytes per row)</param>
+	/// <param name="context">The image context</param>
+	/// <param name="device">The image device</param>
+	/// <param name="queue">The queue executing the conversion</param>
+	/// <param name="image">The source image</param>
+	/// <param name="width">The image width</param>
+	/// <param name="height">The image height</param>
+	/// <param name="format">The destination pixel format</param>
+	/// <param name="encodeSRGB">Whether 8-bit color channels are encoded from linear to sRGB, only for linear (floating point) sources</param>
+	/// <returns>True if the image was converted</returns>
+	bool Convert(void* output,
+				 const OpenCL::ContextPtr& context,
+				 const OpenCL::DevicePtr& device,
+				 const OpenCL::CommandQueue& queue,
+				 cl_mem image,
+				 uint32_t width,
+				 uint32_t height,
+				 EPixelFormat format,
+				 bool encodeSRGB);
+}
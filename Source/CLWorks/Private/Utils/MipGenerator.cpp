@@ -1,9 +1,96 @@
 #include "MipGenerator.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace MipGenerator
 {
+	// IEEE 754 binary16, averaged in float precision
+	struct Half
+	{
+	public:
+		Half() = default;
+
+		Half(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+			uint32_t mantissa = bits & 0x7FFFFF;
+
+			if (exponent <= 0)
+			{
+				// Denormals, flushed to zero below the smallest one
+				if (exponent < -10)
+				{
+					mBits = static_cast<uint16_t>(sign);
+					return;
+				}
+
+				mantissa |= 0x800000;
+				const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+				mBits = static_cast<uint16_t>(sign | ((mantissa + (1u << (shift - 1))) >> shift));
+			}
+			else if (exponent >= 31)
+			{
+				// Overflow to infinity, NaNs keep a mantissa bit
+				const bool isNaN = ((bits >> 23) & 0xFF) == 0xFF && mantissa != 0;
+				mBits = static_cast<uint16_t>(sign | 0x7C00 | (isNaN ? 0x200 : 0));
+			}
+			else
+			{
+				// Round to nearest, a carry correctly bumps the exponent
+				mBits = static_cast<uint16_t>(sign | ((exponent << 10) + ((mantissa + 0x1000) >> 13)));
+			}
+		}
+
+		operator float() const
+		{
+			const uint32_t sign = static_cast<uint32_t>(mBits & 0x8000) << 16;
+			uint32_t exponent = (mBits >> 10) & 0x1F;
+			uint32_t mantissa = mBits & 0x3FF;
+
+			uint32_t bits;
+			if (exponent == 0)
+			{
+				if (mantissa == 0)
+				{
+					bits = sign;
+				}
+				else
+				{
+					// Normalize the denormal
+					exponent = 127 - 15 + 1;
+					while ((mantissa & 0x400) == 0)
+					{
+						mantissa <<= 1;
+						--exponent;
+					}
+					bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+				}
+			}
+			else if (exponent == 31)
+			{
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			}
+			else
+			{
+				bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+			}
+
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	private:
+		uint16_t mBits = 0;
+	};
+
+	static_assert(sizeof(Half) == sizeof(uint16_t), "Half must alias its binary16 bits");
+
 	template<typename V, typename C>
 	void GenerateMip(std::vector<Mip>& output,
 				     V* const src,
@@ -108,13 +195,13 @@ namespace MipGenerator
 	}
 
 	void GenerateMipsFloat16(std::vector<Mip>& output,
-							 FFloat16* const src,
+							 uint16_t* const src,
 						     size_t srcWidth, 
 						     size_t srcHeight, 
 							 size_t srcLayers,
 						     uint8_t srcChannels)
 	{
-		GenerateMip<FFloat16, float>(output, src, srcWidth, srcHeight, srcLayers, srcChannels);
+		GenerateMip<Half, float>(output, reinterpret_cast<Half*>(src), srcWidth, srcHeight, srcLayers, srcChannels);
 	}
 
 	void GenerateMipsFloat(std::vector<Mip>& output,
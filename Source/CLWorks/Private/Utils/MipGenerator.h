@@ -2,42 +2,44 @@
 
 #include "Core/ImageDefines.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace MipGenerator
 {
-	static void GenerateMipsInt8(std::vector<Mip>& output,
-								 uint8_t* const src,
-								 size_t srcWidth, 
-								 size_t srcHeight,
-								 size_t srcLayers,
-								 uint8_t srcChannels);
+	void GenerateMipsInt8(std::vector<Mip>& output,
+						  uint8_t* const src,
+						  size_t srcWidth,
+						  size_t srcHeight,
+						  size_t srcLayers,
+						  uint8_t srcChannels);
 
-	static void GenerateMipsUInt32(std::vector<Mip>& output,
-								   uint32_t* const src,
-								   size_t srcWidth, 
-								   size_t srcHeight,
-								   size_t srcLayers,
-								   uint8_t srcChannels);
+	void GenerateMipsUInt32(std::vector<Mip>& output,
+							uint32_t* const src,
+							size_t srcWidth,
+							size_t srcHeight,
+							size_t srcLayers,
+							uint8_t srcChannels);
 
-	static void GenerateMipsInt32(std::vector<Mip>& output,
-								  int32_t* const src,
-								  size_t srcWidth, 
-								  size_t srcHeight,
-								  size_t srcLayers,
-								  uint8_t srcChannels);
+	void GenerateMipsInt32(std::vector<Mip>& output,
+						   int32_t* const src,
+						   size_t srcWidth,
+						   size_t srcHeight,
+						   size_t srcLayers,
+						   uint8_t srcChannels);
 
-	static void GenerateMipsFloat16(std::vector<Mip>& output,
-									FFloat16* const src,
-									size_t srcWidth,
-									size_t srcHeight,
-									size_t srcLayers,
-									uint8_t srcChannels);
+	// Half floats are passed as their IEEE 754 binary16 bits
+	void GenerateMipsFloat16(std::vector<Mip>& output,
+							 uint16_t* const src,
+							 size_t srcWidth,
+							 size_t srcHeight,
+							 size_t srcLayers,
+							 uint8_t srcChannels);
 
-	static void GenerateMipsFloat(std::vector<Mip>& output,
-								  float* const src,
-								  size_t srcWidth,
-								  size_t srcHeight,
-								  size_t srcLayers,
-								  uint8_t srcChannels);
+	void GenerateMipsFloat(std::vector<Mip>& output,
+						   float* const src,
+						   size_t srcWidth,
+						   size_t srcHeight,
+						   size_t srcLayers,
+						   uint8_t srcChannels);
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/// <summary>
+/// Bounded lock-free queue for many producers and a single consumer.
+/// Each cell carries a sequence number marking whether it is free to be
+/// written or ready to be read, so producers only contend on a single
+/// compare-exchange of the enqueue position.
+/// </summary>
+template<typename T, size_t Capacity>
+class TMpscRing
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+	TMpscRing()
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+			mCells[i].mSequence.store(i, std::memory_order_relaxed);
+	}
+
+	TMpscRing(const TMpscRing&) = delete;
+	TMpscRing& operator=(const TMpscRing&) = delete;
+public:
+	/// <summary>
+	/// Pushes a value, safe from any thread.
+	/// </summary>
+	/// <returns>False if the ring is full</returns>
+	bool TryPush(T&& value)
+	{
+		Cell* cell = nullptr;
+		size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			cell = &mCells[pos & Mask];
+
+			const size_t sequence = cell->mSequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+			if (diff == 0)
+			{
+				if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->mData = std::move(value);
+		cell->mSequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// <summary>
+	/// Pops the oldest value, must only be called from the consuming thread.
+	/// </summary>
+	/// <returns>False if the ring is empty</returns>
+	bool TryPop(T& output)
+	{
+		Cell& cell = mCells[mDequeuePos & Mask];
+
+		const size_t sequence = cell.mSequence.load(std::memory_order_acquire);
+		if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(mDequeuePos + 1) < 0)
+			return false;
+
+		output = std::move(cell.mData);
+		cell.mSequence.store(mDequeuePos + Capacity, std::memory_order_release);
+		++mDequeuePos;
+		return true;
+	}
+private:
+	static constexpr size_t Mask = Capacity - 1;
+
+	struct Cell
+	{
+		std::atomic<size_t> mSequence;
+		T mData;
+	};
+private:
+	Cell mCells[Capacity];
+
+	alignas(64) std::atomic<size_t> mEnqueuePos = 0;
+	alignas(64) size_t mDequeuePos = 0;
+};
@@ -2,9 +2,12 @@
 
 #pragma once
 
+#include "Async/Future.h"
 #include "Modules/ModuleManager.h"
 
 class FCLProfilerManager;
+class FCLTexturePool;
+class FCLWorksInstrumentation;
 
 class FCLWorksModule : public IModuleInterface
 {
@@ -13,6 +16,24 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+public:
+	/// <summary>
+	/// Resolves once the background OpenCL initialization (platform enumeration and the
+	/// default device's shared context) finished. Using OpenCL earlier is safe, it waits on
+	/// the work in progress instead of repeating it.
+	/// </summary>
+	static CLWORKS_API TSharedFuture<void> GetReadyFuture();
+
+	/// <summary>
+	/// Whether the background OpenCL initialization finished, never blocks.
+	/// </summary>
+	static CLWORKS_API bool IsReady();
 private:
+	static TSharedFuture<void> ReadyFuture;
+
 	TUniquePtr<FCLProfilerManager> mpCLProfileManager;
+	TUniquePtr<FCLTexturePool> mpCLTexturePool;
+	TUniquePtr<FCLWorksInstrumentation> mpInstrumentation;
+
+	FDelegateHandle mEndFrameHandle;
 };
@@ -1,15 +1,22 @@
 #pragma once
 
 #include "Core/CLDevice.h"
+#include "Core/CLDevicePartition.h"
 #include "Core/CLContext.h"
 
 #include "Core/CLBuffer.h"
 #include "Core/CLImage.h"
 
 #include "Core/CLKernel.h"
+#include "Core/CLTypedKernel.h"
 #include "Core/CLProgram.h"
+#include "Core/CLRegistry.h"
 #include "Core/CLCommandQueue.h"
+#include "Core/CLCommandBuffer.h"
 #include "Core/CLEvent.h"
+#include "Core/CLMultiDeviceExecutor.h"
+#include "Core/CLTransientPool.h"
+#include "Core/CLComputeGraph.h"
 
 #include "Objects/CLObjectDefines.h"
 #include "Objects/CLContextObject.h"
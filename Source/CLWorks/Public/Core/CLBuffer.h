@@ -33,8 +33,16 @@ namespace OpenCL
 		bool IsValid() const { return mpBuffer || mpSVMPtr; }
 
 		size_t Size() const { return mDataSize; }
+
+		// Zero-copy buffers are SVM allocations without a cl_mem
+		bool IsSVM() const { return mpSVMPtr != nullptr; }
+		void* GetSVMPointer() const { return mpSVMPtr; }
 	public:
-		void Fetch(const OpenCL::CommandQueue& queue,
+		/// <summary>
+		/// Blocking read back of the buffer's data.
+		/// </summary>
+		/// <returns>False if the data couldn't be read</returns>
+		bool Fetch(const OpenCL::CommandQueue& queue,
 				   void* output,
 				   size_t size, 
 				   size_t offset = 0);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Core/CLBuffer.h"
+#include "Core/CLCommandQueue.h"
+#include "Core/CLKernel.h"
+
+#include <memory>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// A recorded sequence of kernel dispatches, buffer copies and fills replayed on a queue with a single submission.
+	/// Replays go through cl_khr_command_buffer where the device supports it and are enqueued back
+	/// to back otherwise, skipping the work-group tuning and profiler bookkeeping of
+	/// CommandQueue::EnqueueRange either way.
+	///
+	/// Every dispatch runs with its kernel's arguments as set when the buffer is enqueued, a kernel
+	/// recorded twice runs twice with the same arguments. Changed arguments are updated in place on
+	/// devices with cl_khr_command_buffer_mutable_dispatch, other driver command buffers are recorded
+	/// again on the next enqueue, costing about as much as enqueuing the commands one by one.
+	/// Recorded kernels and buffers must outlive the buffer.
+	/// </summary>
+	class CLWORKS_API CommandBuffer
+	{
+	public:
+		CommandBuffer(const CommandQueue& queue);
+
+		~CommandBuffer();
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+	public:
+		inline bool IsValid() const { return mIsValid; }
+
+		inline bool IsFinalized() const { return mIsFinalized; }
+
+		/// <summary>
+		/// Whether replays are submitted as a driver command buffer rather than emulated.
+		/// </summary>
+		inline bool IsNative() const { return mpNative != nullptr; }
+
+		inline size_t GetCommandCount() const { return mCommands.size(); }
+
+		/// <summary>
+		/// Appends a dispatch, only allowed before the buffer is finalized.
+		/// </summary>
+		/// <param name="local_work_size">Nullptr leaves the local size to the driver</param>
+		/// <returns>True if the dispatch was recorded</returns>
+		bool RecordRange(const Kernel& kernel,
+						 size_t work_dim,
+						 const size_t* global_work_size,
+						 const size_t* local_work_size = nullptr);
+
+		/// <summary>
+		/// Appends a copy between two buffers, only allowed before the buffer is finalized.
+		/// Shared virtual memory buffers can't be recorded.
+		/// </summary>
+		/// <returns>True if the copy was recorded</returns>
+		bool RecordCopy(const Buffer& source,
+						const Buffer& destination,
+						size_t size,
+						size_t sourceOffset = 0,
+						size_t destinationOffset = 0);
+
+		/// <summary>
+		/// Appends a fill of the buffer's range with a repeated pattern, only allowed before the buffer is finalized.
+		/// </summary>
+		/// <param name="pattern">Copied on record, its size must divide the range's size and offset</param>
+		/// <returns>True if the fill was recorded</returns>
+		bool RecordFill(const Buffer& buffer,
+						const void* pattern,
+						size_t patternSize,
+						size_t size,
+						size_t offset = 0);
+
+		/// <summary>
+		/// Ends the recording, building the driver command buffer if supported.
+		/// </summary>
+		bool Finalize();
+
+		/// <summary>
+		/// Replays every recorded command. Kernels whose arguments changed since the last replay
+		/// have them rebound, updating or re-recording the driver command buffer if needed.
+		/// </summary>
+		/// <returns>False if the replay couldn't be submitted</returns>
+		bool Enqueue();
+
+		/// <summary>
+		/// Drops every recorded command so the buffer can be recorded again.
+		/// </summary>
+		void Reset();
+	private:
+		enum class CommandType : uint8_t
+		{
+			Range,
+			Copy,
+			Fill,
+		};
+
+		struct Command
+		{
+			CommandType Type = CommandType::Range;
+
+			// Dispatches
+			const Kernel* pKernel = nullptr;
+			uint64_t ArgumentVersion = 0;
+
+			// Whether the kernel's arguments changed since the last enqueue
+			bool bStale = false;
+
+			cl_uint WorkDim = 0;
+			size_t GlobalWorkSize[3] = {};
+			size_t LocalWorkSize[3] = {};
+			bool bHasLocalSize = false;
+
+			// Copies and fills, the source is unused by fills
+			cl_mem Source = nullptr;
+			cl_mem Destination = nullptr;
+			size_t SourceOffset = 0;
+			size_t DestinationOffset = 0;
+			size_t Size = 0;
+			std::vector<uint8_t> Pattern;
+		};
+
+		// Extension entry points and handle, defined alongside the implementation since the
+		// extension's types only exist in recent headers
+		struct NativeCommandBuffer;
+	private:
+		static const char* GetCommandName(const Command& command);
+
+		bool CanRecord(const char* name) const;
+
+		bool FlushArguments(bool& bStale);
+
+		bool EnqueueEmulated() const;
+	private:
+		cl_command_queue mpCommandQueue = nullptr;
+		cl_device_id mpDeviceId = nullptr;
+
+		std::vector<Command> mCommands;
+		std::unique_ptr<NativeCommandBuffer> mpNative;
+
+		bool mIsValid = false;
+		bool mIsFinalized = false;
+	};
+}
\ No newline at end of file
@@ -15,8 +15,12 @@ namespace OpenCL
 	public:
 		CommandQueue();
 
+		/// <summary>
+		/// Creates a queue on the device, profiling if the instrumentation asks for it or if forced.
+		/// </summary>
 		CommandQueue(const OpenCL::ContextPtr& context, 
-					 const OpenCL::DevicePtr& device);
+					 const OpenCL::DevicePtr& device,
+					 bool forceProfiling = false);
 
 		~CommandQueue();
 	public:
@@ -24,23 +28,43 @@ namespace OpenCL
 		cl_command_queue Get() const { return mpCommandQueue; };
 
 		inline DevicePtr GetDevicePtr() const { return mpAttachedDevice.lock(); }
+
+		inline cl_device_id GetDeviceId() const { return mpDeviceId; }
+
+		/// <summary>
+		/// Identifies the queue for the process lifetime, unlike its handle which the runtime may reuse once released.
+		/// </summary>
+		inline uint64_t GetId() const { return mId; }
 	public:
 		bool IsValid() const { return mIsValid; }
 
+		/// <summary>
+		/// Whether the queue was created with profiling, commands only create events for the profiler if so.
+		/// </summary>
+		bool IsProfiling() const { return mIsProfiling; }
+
 		void WaitForFinish() const;
 
-		void EnqueueRange(const OpenCL::Kernel& kernel, 
+		/// <summary>
+		/// Enqueues the kernel over the range, a failed enqueue invalidates the queue.
+		/// </summary>
+		/// <returns>False if the kernel couldn't be enqueued</returns>
+		bool EnqueueRange(const OpenCL::Kernel& kernel, 
 						  size_t work_dim, 
 						  const size_t* global_work_size,
 						  const size_t* local_work_size = nullptr);
 	private:
 		void Initialize(cl_context context, 
-						cl_device_id device);
+						cl_device_id device,
+						bool forceProfiling);
 	private:
 		cl_command_queue mpCommandQueue;
+		cl_device_id mpDeviceId = nullptr;
+		uint64_t mId = 0;
 
 		std::weak_ptr<OpenCL::Context> mpContext;
 		std::weak_ptr<OpenCL::Device> mpAttachedDevice;
 		bool mIsValid;
+		bool mIsProfiling = false;
 	};
 }
\ No newline at end of file
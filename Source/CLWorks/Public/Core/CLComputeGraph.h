@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Core/CLBuffer.h"
+#include "Core/CLCommandQueue.h"
+#include "Core/CLTransientPool.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// Handle to a buffer or image declared on a compute graph.
+	/// </summary>
+	struct CLWORKS_API GraphResource
+	{
+		static constexpr uint32_t InvalidIndex = ~0u;
+
+		uint32_t Index = InvalidIndex;
+	public:
+		bool IsValid() const { return Index != InvalidIndex; }
+	};
+
+	/// <summary>
+	/// A frame's compute work declared as passes reading and writing resources. On execution the graph
+	/// culls passes that don't contribute to an imported or output resource, derives the dependencies
+	/// between the remaining ones from their accesses, synchronizes passes on different queues with
+	/// events and backs transient resources with pooled storage aliased between resources whose
+	/// lifetimes don't overlap. Passes run in the order they were added.
+	/// </summary>
+	class CLWORKS_API ComputeGraph
+	{
+	public:
+		/// <summary>
+		/// What a pass may access while it runs.
+		/// </summary>
+		class CLWORKS_API PassContext
+		{
+			friend ComputeGraph;
+		public:
+			/// <summary>
+			/// The memory backing a resource the pass declared, nullptr otherwise.
+			/// </summary>
+			cl_mem Get(GraphResource resource) const;
+
+			inline CommandQueue& GetQueue() const { return *mpQueue; }
+		private:
+			PassContext(const ComputeGraph& graph,
+						uint32_t passIndex,
+						CommandQueue& queue);
+		private:
+			const ComputeGraph& mGraph;
+			uint32_t mPassIndex;
+			CommandQueue* mpQueue;
+		};
+
+		using PassFunction = std::function<void(const PassContext& context)>;
+	public:
+		ComputeGraph(TransientPool& pool);
+
+		ComputeGraph(const ComputeGraph&) = delete;
+		ComputeGraph& operator=(const ComputeGraph&) = delete;
+	public:
+		/// <summary>
+		/// Declares a transient buffer, only backed by memory while passes use it.
+		/// </summary>
+		GraphResource CreateBuffer(const std::string& name,
+								   size_t size);
+
+		/// <summary>
+		/// Declares a transient 2D image, aliased only with images of the same format and extent.
+		/// </summary>
+		GraphResource CreateImage2D(const std::string& name,
+									const cl_image_format& format,
+									size_t width,
+									size_t height);
+
+		/// <summary>
+		/// Declares memory owned outside the graph, passes writing it are never culled.
+		/// </summary>
+		GraphResource ImportBuffer(const std::string& name,
+								   const Buffer& buffer);
+
+		/// <summary>
+		/// Declares a buffer or image owned outside the graph by its handle, e.g. an Image's.
+		/// </summary>
+		GraphResource ImportMemory(const std::string& name,
+								   cl_mem memory);
+
+		/// <summary>
+		/// Keeps the passes writing a transient resource, e.g. one only inspected while debugging.
+		/// </summary>
+		void MarkOutput(GraphResource resource);
+
+		/// <summary>
+		/// Adds a pass accessing the resources, a resource both read and written goes in both lists.
+		/// </summary>
+		/// <param name="execute">Enqueues the pass' work on the queue it's given</param>
+		/// <param name="queue">Runs the pass on another queue than the graph's, e.g. a second device's</param>
+		/// <param name="bNeverCull">Keeps the pass even if nothing reads what it writes</param>
+		void AddPass(const std::string& name,
+					 const std::vector<GraphResource>& reads,
+					 const std::vector<GraphResource>& writes,
+					 PassFunction&& execute,
+					 CommandQueue* queue = nullptr,
+					 bool bNeverCull = false);
+
+		/// <summary>
+		/// Runs the graph's passes, work on other queues is joined back into the given one.
+		/// The graph can only be executed once.
+		/// </summary>
+		/// <returns>False if the graph is invalid, e.g. a transient is read before it's written</returns>
+		bool Execute(CommandQueue& queue);
+
+		inline size_t GetPassCount() const { return mPasses.size(); }
+
+		/// <summary>
+		/// Passes that survived culling in the last execution.
+		/// </summary>
+		inline size_t GetExecutedPassCount() const { return mExecutedPassCount; }
+	private:
+		struct Resource
+		{
+			std::string Name;
+			TransientDesc Desc;
+
+			bool bImported = false;
+			bool bOutput = false;
+
+			cl_mem Memory = nullptr;
+
+			// Lifetime over the executed passes
+			int32_t FirstPass = -1;
+			int32_t LastPass = -1;
+		};
+
+		struct Pass
+		{
+			std::string Name;
+			std::vector<uint32_t> Reads;
+			std::vector<uint32_t> Writes;
+			PassFunction Execute;
+
+			CommandQueue* Queue = nullptr;
+			bool bNeverCull = false;
+
+			bool bCulled = false;
+			std::vector<uint32_t> Dependencies;
+		};
+	private:
+		GraphResource AddResource(Resource&& resource);
+
+		bool IsValidResource(GraphResource resource, const char* action) const;
+
+		void CullPasses();
+
+		bool ComputeLifetimes();
+
+		void AddDependency(uint32_t pass, int32_t dependency);
+
+		bool Compile();
+	private:
+		TransientPool& mPool;
+
+		std::vector<Resource> mResources;
+		std::vector<Pass> mPasses;
+
+		size_t mExecutedPassCount = 0;
+		bool mIsExecuted = false;
+	};
+}
\ No newline at end of file
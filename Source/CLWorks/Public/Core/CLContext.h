@@ -2,6 +2,8 @@
 
 #include "Core/CLDevice.h"
 
+#include <vector>
+
 namespace OpenCL
 {
 	enum class Interop
@@ -25,6 +27,12 @@ namespace OpenCL
 		Context(const DevicePtr& device,
 				const ContextProperties& properties = {});
 
+		/// <summary>
+		/// Shares memory objects and programs between the devices, which must be of one platform.
+		/// </summary>
+		Context(const std::vector<DevicePtr>& devices,
+				const ContextProperties& properties = {});
+
 		~Context();
 	public:
 		operator cl_context() const { return mpContext; }
@@ -32,7 +40,8 @@ namespace OpenCL
 		
 		void PrintSupportedImageFormats(cl_mem_flags mem_flags);
 	private:
-		void Initialize(cl_device_id device, 
+		void Initialize(const cl_device_id* devices,
+						cl_uint numDevices,
 						const ContextProperties& properties);
 	private:
 		cl_context mpContext = nullptr;
@@ -45,4 +54,10 @@ namespace OpenCL
 	{
 		return std::make_shared<OpenCL::Context>(device, properties);
 	}
+
+	inline static ContextPtr MakeContext(const std::vector<DevicePtr>& devices,
+										 const ContextProperties& properties = {})
+	{
+		return std::make_shared<OpenCL::Context>(devices, properties);
+	}
 }
\ No newline at end of file
@@ -1,5 +1,16 @@
 #pragma once
 
+#include <cstdint>
+
+// Builds outside of Unreal (see the root CMakeLists.txt) define these themselves
+#ifndef CLWORKS_WITH_UNREAL
+	#define CLWORKS_WITH_UNREAL 0
+#endif
+
+#ifndef CLWORKS_API
+	#define CLWORKS_API
+#endif
+
 namespace OpenCL
 {
 	enum class AccessType : uint8_t
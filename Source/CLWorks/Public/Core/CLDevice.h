@@ -2,34 +2,56 @@
 
 #include "OpenCLLib.h"
 
+#include "Core/CLDeviceCapabilities.h"
+#include "Core/CLDeviceEnumerator.h"
+
 #include <string>
 #include <memory>
 
 namespace OpenCL
 {
-	enum SVMSupport : uint8_t
-	{
-		None = 0,
-		Coarse,
-		Fine,
-	};
-
 	class CLWORKS_API Device
 	{
 	public:
+		/// <summary>
+		/// Selects among the platform's GPUs, or among its CPUs if it has none.
+		/// </summary>
 		Device(uint32_t deviceIndex = 0, 
 			   uint32_t platformIndex = 0);
 
+		/// <summary>
+		/// Uses an enumerated device, e.g. from DeviceEnumerator::SelectBest.
+		/// </summary>
+		explicit Device(const DeviceDescription& description);
+
+		/// <summary>
+		/// Takes ownership of a sub-device partitioned from the parent, see CLDevicePartition.h.
+		/// </summary>
+		Device(cl_device_id subDevice,
+			   const std::shared_ptr<Device>& parent);
+
 		~Device();
 	public:
 		bool AreImagesSupported() const;
 		SVMSupport GetSVMSupported() const;
 		bool IsExtensionSupported(const std::string& extension) const;
+
+		/// <summary>
+		/// Limits and features captured once for the device, free to consult on hot paths.
+		/// </summary>
+		const DeviceCapabilities& GetCapabilities() const { return *mpCapabilities; }
+
+		bool IsSubDevice() const { return mpParent != nullptr; }
+		const std::shared_ptr<Device>& GetParent() const { return mpParent; }
 	public:
 		operator cl_device_id() const { return mpDevice; }
 		cl_device_id Get() const { return mpDevice; }
 	private:
-		cl_device_id mpDevice;
+		cl_device_id mpDevice = nullptr;
+		DeviceCapabilitiesPtr mpCapabilities;
+
+		// Sub-devices keep their parent alive
+		std::shared_ptr<Device> mpParent;
 	};
 
 	using DevicePtr = std::shared_ptr<OpenCL::Device>;
@@ -39,4 +61,17 @@ namespace OpenCL
 	{
 		return std::make_shared<OpenCL::Device>(deviceIndex, platformIndex);
 	}
+
+	/// <summary>
+	/// Creates the highest scoring device for the workload.
+	/// </summary>
+	/// <returns>Nullptr if no device qualifies</returns>
+	inline static DevicePtr MakeBestDevice(DeviceWorkload workload = DeviceWorkload::General,
+										   cl_device_type typeMask = CL_DEVICE_TYPE_ALL)
+	{
+		const DeviceDescription* description = DeviceEnumerator::SelectBest(workload, typeMask);
+		if (!description)
+			return nullptr;
+		return std::make_shared<OpenCL::Device>(*description);
+	}
 }
\ No newline at end of file
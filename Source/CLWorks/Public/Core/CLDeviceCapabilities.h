@@ -0,0 +1,123 @@
+#pragma once
+
+#include "OpenCLLib.h"
+
+#include "Core/CLCore.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OpenCL
+{
+	enum SVMSupport : uint8_t
+	{
+		None = 0,
+		Coarse,
+		Fine,
+	};
+
+	/// <summary>
+	/// Immutable snapshot of a device's limits and features, captured once per device
+	/// so hot paths (allocation, kernel variant selection, scheduling) never query the driver.
+	/// </summary>
+	struct CLWORKS_API DeviceCapabilities
+	{
+		cl_device_id Device = nullptr;
+		cl_device_type Type = 0;
+
+		std::string Name;
+		std::string Vendor;
+		std::string Version;
+		std::string DriverVersion;
+		std::vector<std::string> Extensions;
+
+		// Limits ---------------------------------------------------------------------------------
+		uint32_t ComputeUnits = 0;
+		uint32_t ClockMHz = 0;
+		uint32_t MaxWorkItemDimensions = 0;
+		size_t MaxWorkItemSizes[3] = {};
+		size_t MaxWorkGroupSize = 0;
+		size_t MaxParameterSize = 0;
+
+		uint64_t GlobalMemSize = 0;
+		uint64_t GlobalMemCacheSize = 0;
+		uint64_t LocalMemSize = 0;
+		uint64_t ConstantBufferSize = 0;
+		uint64_t MaxAllocSize = 0;
+
+		// Work items and private memory (registers) a compute unit keeps resident at once, not reported
+		// by OpenCL so typical values refined by vendor queries, zero private memory is unbounded
+		size_t MaxResidentWorkItems = 0;
+		uint64_t PrivateMemSize = 0;
+		// ----------------------------------------------------------------------------------------
+
+		// Alignments -----------------------------------------------------------------------------
+		// Required alignment of sub-buffer origins and host pointers for zero-copy
+		uint32_t BaseAddressAlignment = 0;
+		uint32_t GlobalMemCacheLineSize = 0;
+		// ----------------------------------------------------------------------------------------
+
+		// Images ---------------------------------------------------------------------------------
+		bool bImageSupport = false;
+		size_t MaxImage2DWidth = 0;
+		size_t MaxImage2DHeight = 0;
+		size_t MaxImage3DWidth = 0;
+		size_t MaxImage3DHeight = 0;
+		size_t MaxImage3DDepth = 0;
+		size_t MaxImageArraySize = 0;
+		// ----------------------------------------------------------------------------------------
+
+		// Features -------------------------------------------------------------------------------
+		SVMSupport SVM = SVMSupport::None;
+		bool bUnifiedMemory = false;
+		bool bHalfSupport = false;
+		bool bDoubleSupport = false;
+
+		// Preferred vector widths of char, short, int, long, half, float and double, zero if unsupported
+		uint32_t PreferredVectorWidthChar = 0;
+		uint32_t PreferredVectorWidthShort = 0;
+		uint32_t PreferredVectorWidthInt = 0;
+		uint32_t PreferredVectorWidthLong = 0;
+		uint32_t PreferredVectorWidthHalf = 0;
+		uint32_t PreferredVectorWidthFloat = 0;
+		uint32_t PreferredVectorWidthDouble = 0;
+		// ----------------------------------------------------------------------------------------
+
+		// Partitioning ---------------------------------------------------------------------------
+		uint32_t PartitionMaxSubDevices = 0;
+
+		// Supported CL_DEVICE_PARTITION_* schemes
+		std::vector<cl_device_partition_property> PartitionTypes;
+		cl_device_affinity_domain PartitionAffinityDomains = 0;
+		// ----------------------------------------------------------------------------------------
+	public:
+		bool IsExtensionSupported(const std::string& extension) const;
+
+		/// <summary>
+		/// Read-write 2D formats of the device, queried on first use since they need a context.
+		/// </summary>
+		const std::vector<cl_image_format>& GetImageFormats() const;
+
+		bool IsImageFormatSupported(cl_channel_order order,
+									cl_channel_type type) const;
+
+		bool IsPartitionTypeSupported(cl_device_partition_property type) const;
+	public:
+		/// <summary>
+		/// The device's snapshot, captured on first request and shared for the process lifetime.
+		/// </summary>
+		static std::shared_ptr<const DeviceCapabilities> Get(cl_device_id device);
+
+		/// <summary>
+		/// Drops a released sub-device's snapshot, its handle may be reused by a new sub-device.
+		/// </summary>
+		static void Evict(cl_device_id device);
+	private:
+		mutable std::once_flag mImageFormatsOnce;
+		mutable std::vector<cl_image_format> mImageFormats;
+	};
+
+	using DeviceCapabilitiesPtr = std::shared_ptr<const DeviceCapabilities>;
+}
\ No newline at end of file
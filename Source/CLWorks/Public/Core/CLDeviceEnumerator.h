@@ -0,0 +1,108 @@
+#pragma once
+
+#include "OpenCLLib.h"
+
+#include "Core/CLDeviceCapabilities.h"
+
+#include <string>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// The kind of work a device is being picked for, weighting how devices are scored.
+	/// </summary>
+	enum class DeviceWorkload : uint8_t
+	{
+		General,
+
+		// Arithmetic bound kernels
+		Compute,
+
+		// Bandwidth bound kernels and large resident data sets
+		Memory,
+
+		// Kernels sampling or writing images
+		Image,
+
+		// Small dispatches sharing data with the host every frame
+		HostShared,
+	};
+
+	/// <summary>
+	/// Where a device sits among the platforms, its limits and features are the
+	/// shared DeviceCapabilities snapshot so every cache agrees.
+	/// </summary>
+	struct CLWORKS_API DeviceDescription
+	{
+		uint32_t PlatformIndex = 0;
+
+		// Index among the platform's devices of the same selection group (GPUs, else CPUs)
+		uint32_t DeviceIndex = 0;
+
+		cl_platform_id Platform = nullptr;
+		cl_device_id Device = nullptr;
+
+		std::string PlatformName;
+
+		DeviceCapabilitiesPtr Capabilities;
+	public:
+		const DeviceCapabilities& GetCapabilities() const { return *Capabilities; }
+
+		bool IsGPU() const { return (Capabilities->Type & CL_DEVICE_TYPE_GPU) != 0; }
+		bool IsCPU() const { return (Capabilities->Type & CL_DEVICE_TYPE_CPU) != 0; }
+
+		// GPUs that don't share memory with the host
+		bool IsDiscrete() const { return IsGPU() && !Capabilities->bUnifiedMemory; }
+	};
+
+	/// <summary>
+	/// Process-wide listing of every platform and device, queried once and cached for the
+	/// process' lifetime so the descriptions handed out stay valid.
+	/// </summary>
+	class CLWORKS_API DeviceEnumerator
+	{
+	public:
+		/// <summary>
+		/// Every device of every platform, ordered by platform then device.
+		/// </summary>
+		static const std::vector<DeviceDescription>& GetDevices();
+
+		/// <summary>
+		/// Whether the devices were enumerated, doesn't block on an enumeration in progress.
+		/// </summary>
+		static bool IsEnumerated();
+
+		/// <summary>
+		/// Resolves the indices the way Device does: GPUs of the platform first,
+		/// the platform's CPUs when it has none.
+		/// </summary>
+		/// <returns>Nullptr if the indices are out of range</returns>
+		static const DeviceDescription* GetDevice(uint32_t deviceIndex = 0,
+												  uint32_t platformIndex = 0);
+
+		/// <summary>
+		/// First device whose name contains the fragment (case-sensitive).
+		/// </summary>
+		static const DeviceDescription* FindDevice(const std::string& nameFragment);
+
+		/// <summary>
+		/// Estimated relative throughput of the device for the workload, zero if it can't run it.
+		/// </summary>
+		static double Score(const DeviceDescription& device,
+							DeviceWorkload workload);
+
+		/// <summary>
+		/// The highest scoring device for the workload. Ties go to the lower platform
+		/// and device index so the choice is stable between runs.
+		/// </summary>
+		/// <param name="typeMask">Restricts the candidates to these device types</param>
+		static const DeviceDescription* SelectBest(DeviceWorkload workload = DeviceWorkload::General,
+												   cl_device_type typeMask = CL_DEVICE_TYPE_ALL);
+
+		/// <summary>
+		/// Logs every device with its capabilities and scores.
+		/// </summary>
+		static void Dump();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Core/CLCommandQueue.h"
+#include "Core/CLContext.h"
+#include "Core/CLDevice.h"
+
+#include <memory>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// A sub-device with its own context and queue, isolating its compute units from the rest of the device.
+	/// </summary>
+	struct CLWORKS_API DevicePartition
+	{
+		DevicePtr Device;
+		ContextPtr Context;
+		std::shared_ptr<CommandQueue> Queue;
+	};
+
+	/// <summary>
+	/// Splits the device into as many sub-devices of the given compute units as fit.
+	/// </summary>
+	/// <returns>Empty if the device can't be partitioned equally</returns>
+	CLWORKS_API std::vector<DevicePtr> CreateSubDevicesEqually(const DevicePtr& parent,
+															   uint32_t computeUnits);
+
+	/// <summary>
+	/// Creates one sub-device per count, e.g. { total - 4 } leaves four cores to the engine's task graph.
+	/// </summary>
+	/// <returns>Empty if the device can't be partitioned by counts</returns>
+	CLWORKS_API std::vector<DevicePtr> CreateSubDevicesByCounts(const DevicePtr& parent,
+																const std::vector<uint32_t>& computeUnits);
+
+	/// <summary>
+	/// Creates one sub-device per affinity domain, e.g. per NUMA node of a multi-socket host,
+	/// so each partition's allocations stay local to its cores.
+	/// </summary>
+	/// <returns>Empty if the device can't be partitioned by the domain</returns>
+	CLWORKS_API std::vector<DevicePtr> CreateSubDevicesByAffinity(const DevicePtr& parent,
+																  cl_device_affinity_domain domain = CL_DEVICE_AFFINITY_DOMAIN_NUMA);
+
+	/// <summary>
+	/// Gives each sub-device its own context and queue.
+	/// </summary>
+	CLWORKS_API std::vector<DevicePartition> MakePartitions(const std::vector<DevicePtr>& subDevices);
+}
\ No newline at end of file
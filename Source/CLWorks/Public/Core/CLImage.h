@@ -74,6 +74,18 @@ namespace OpenCL
 
 			COUNT
 		};
+
+		enum class Compression : uint8_t
+		{
+			None,
+
+			BC1,
+			BC4,
+			BC5,
+			BC7,
+
+			COUNT
+		};
 	public:
 		Image() = default;
 
@@ -111,6 +123,30 @@ namespace OpenCL
 												bool async = false,
 												uint32_t maxBytesPerUpload = 64 * 2048);
 
+		/// <summary>
+		/// Encodes the image into BCn blocks on the device and creates a texture from them.
+		/// The image dimensions must be multiples of four, mips are not generated.
+		/// </summary>
+		/// <param name="queue">The queue executing the encoding</param>
+		/// <param name="compression">The block format</param>
+		/// <param name="isSRGB">Whether the texture is sampled as sRGB, floating point images are encoded before compression</param>
+		/// <returns>The compressed texture, or nullptr on failure</returns>
+		TObjectPtr<UTexture2D> CreateCompressedUTexture2D(const OpenCL::CommandQueue& queue,
+														  Compression compression,
+														  bool isSRGB = true);
+
+		/// <summary>
+		/// Converts the image into the pixel format on the device before reading it back,
+		/// only the converted pixels are transferred.
+		/// </summary>
+		/// <param name="queue">The queue executing the conversion</param>
+		/// <param name="pixelFormat">The texture format (BGRA8, RGBA8, RG8, R8 or their 16F equivalents)</param>
+		/// <param name="isSRGB">Whether the texture is sRGB, floating point images are encoded into its 8-bit channels</param>
+		/// <returns>The texture, or nullptr on failure</returns>
+		TObjectPtr<UTexture2D> CreateConvertedUTexture2D(const OpenCL::CommandQueue& queue,
+														 EPixelFormat pixelFormat,
+														 bool isSRGB = true);
+
 		TObjectPtr<UTexture2DArray> CreateUTexture2DArray(const OpenCL::CommandQueue& queue,
 														  bool isSRGB = true,
 														  bool genMips = false);
@@ -138,6 +174,19 @@ namespace OpenCL
 		bool Fetch(const OpenCL::CommandQueue& queue, 
 				   void* output = nullptr,
 				   bool isBlocking = true) const;
+
+		/// <summary>
+		/// Reads back the image converted into the pixel format on the device.
+		/// </summary>
+		/// <param name="queue">The queue executing the conversion</param>
+		/// <param name="pixelFormat">The destination format</param>
+		/// <param name="encodeSRGB">Whether floating point images are encoded to sRGB, 8-bit images are copied as is</param>
+		/// <param name="output">The destination, width * height * BlockBytes of the format</param>
+		/// <returns>True if the image was converted</returns>
+		bool FetchConverted(const OpenCL::CommandQueue& queue,
+							EPixelFormat pixelFormat,
+							bool encodeSRGB,
+							void* output) const;
 	private:
 		cl_mem CreateCLImage();
 
@@ -145,6 +194,17 @@ namespace OpenCL
 						void** output = nullptr,
 						bool isBlocking = true) const;
 
+		uint32_t GetMipCount(bool genMips) const;
+
+		bool CanConvertTo(EPixelFormat pixelFormat) const;
+
+		void WriteRawToUTexture2D(UTexture2D* texture,
+								  uint8_t* src,
+								  size_t dataSize,
+								  uint32_t rowPitch,
+								  uint32_t bytesPerBlock,
+								  bool isRecycled);
+
 		bool GenerateMips2D(std::vector<Mip>& output,
 							void* src);
 
@@ -217,5 +277,22 @@ namespace OpenCL
 					return PF_Unknown;
 			}
 		}
+
+		static EPixelFormat CompressionToPixelFormat(Image::Compression compression)
+		{
+			switch (compression)
+			{
+				case Image::Compression::BC1:
+					return PF_DXT1;
+				case Image::Compression::BC4:
+					return PF_BC4;
+				case Image::Compression::BC5:
+					return PF_BC5;
+				case Image::Compression::BC7:
+					return PF_BC7;
+				default:
+					return PF_Unknown;
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "OpenCLLib.h"
+
+#include "Core/CLCore.h"
+
+#include <memory>
+
+namespace OpenCL
+{
+	class CommandQueue;
+	class Kernel;
+
+	enum class TransferDirection : uint8_t
+	{
+		Upload,
+		Readback,
+
+		COUNT
+	};
+
+	enum class TransferCommand : uint8_t
+	{
+		Read,
+		Write,
+		Map,
+		Unmap,
+
+		COUNT
+	};
+
+	/// <summary>
+	/// Observer of the core's dispatches and transfers. The Unreal module installs
+	/// one feeding its profiler and work-group tuner, standalone builds run with the
+	/// default which profiles nothing. Events handed to the observer are owned by it.
+	/// </summary>
+	class CLWORKS_API Instrumentation
+	{
+	public:
+		virtual ~Instrumentation() = default;
+	public:
+		/// <summary>
+		/// Whether new command queues are created with profiling.
+		/// </summary>
+		virtual bool IsProfilingEnabled() const { return false; }
+
+		/// <summary>
+		/// Chooses the local size of a dispatch that doesn't specify one.
+		/// </summary>
+		/// <param name="output">Storage for up to three dimensions</param>
+		/// <param name="dispatchData">Observer state handed back with the dispatch's outcome</param>
+		/// <returns>The local size, nullptr to let the driver choose</returns>
+		virtual const size_t* SelectLocalSize(const CommandQueue& queue,
+											  const Kernel& kernel,
+											  size_t work_dim,
+											  const size_t* global_work_size,
+											  size_t* output,
+											  std::shared_ptr<void>& dispatchData);
+
+		/// <summary>
+		/// Reports that the selected local size was rejected, the dispatch is retried without one.
+		/// </summary>
+		virtual void OnDispatchRejected(const std::shared_ptr<void>& dispatchData);
+
+		/// <summary>
+		/// Reports an enqueued kernel, the event is only set on profiling queues.
+		/// </summary>
+		virtual void OnKernelEnqueued(const CommandQueue& queue,
+									  const Kernel& kernel,
+									  cl_event event,
+									  size_t work_dim,
+									  const size_t* global_work_size,
+									  const size_t* local_work_size,
+									  const std::shared_ptr<void>& dispatchData);
+
+		/// <summary>
+		/// Reports an enqueued transfer or map command of a profiling queue.
+		/// Bytes are only counted on the command moving the data.
+		/// </summary>
+		virtual void OnTransferEnqueued(const CommandQueue& queue,
+										cl_event event,
+										TransferDirection direction,
+										TransferCommand command,
+										uint64_t bytes,
+										MemoryStrategy strategy = MemoryStrategy::INVALID);
+
+		/// <summary>
+		/// Reports that a profiling queue is being released, commands still in flight may complete afterwards.
+		/// </summary>
+		virtual void OnQueueReleased(const CommandQueue& queue);
+
+		/// <summary>
+		/// Reports that a sub-device is being released, its handle may be reused by a new one.
+		/// </summary>
+		virtual void OnDeviceReleased(cl_device_id device);
+	public:
+		/// <summary>
+		/// Retrieves the installed observer, or the default one.
+		/// </summary>
+		static Instrumentation& Get();
+
+		/// <summary>
+		/// Installs an observer, nullptr restores the default. The caller keeps ownership.
+		/// </summary>
+		static void Set(Instrumentation* instrumentation);
+	};
+}
@@ -3,12 +3,47 @@
 #include "Core/CLProgram.h"
 #include "Core/CLBuffer.h"
 
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace OpenCL
 {
 	class CLWORKS_API Kernel
 	{
+	public:
+		struct ArgumentInfo
+		{
+			std::string Name;
+			std::string TypeName;
+
+			// Bytes a value must have, pointers and images bind a handle. Zero for __local
+			// arguments and types whose size isn't known from the name, e.g. structs
+			size_t Size = 0;
+
+			cl_kernel_arg_address_qualifier AddressQualifier = CL_KERNEL_ARG_ADDRESS_PRIVATE;
+			cl_kernel_arg_access_qualifier AccessQualifier = CL_KERNEL_ARG_ACCESS_NONE;
+			cl_kernel_arg_type_qualifier TypeQualifier = CL_KERNEL_ARG_TYPE_NONE;
+		};
+
+		struct KernelInfo
+		{
+			std::string Name;
+
+			// Source hash of the program the kernel was created from, tells same named kernels apart
+			uint64_t ProgramHash = 0;
+
+			size_t WorkGroupSize = 0;
+			size_t CompileWorkGroupSize[3] = {};
+			size_t PreferredWorkGroupMultiple = 0;
+
+			cl_ulong PrivateMemSize = 0;
+			cl_ulong LocalMemSize = 0;
+
+			// Names and types are only available for programs built with -cl-kernel-arg-info
+			std::vector<ArgumentInfo> Arguments;
+		};
 	public:
 		Kernel();
 
@@ -22,33 +57,145 @@ namespace OpenCL
 
 		inline bool IsValid() const { return mIsValid; }
 
-		inline std::string GetName() const { return mName; }
+		inline const std::string& GetName() const { return mName; }
+
+		/// <summary>
+		/// Retrieves the kernel's work-group properties and argument info, queried once on creation.
+		/// The info is shared so per-dispatch consumers can hold onto it without copies.
+		/// </summary>
+		inline const std::shared_ptr<const KernelInfo>& GetInfo() const { return mpInfo; }
+
+		/// <summary>
+		/// Retrieves the index of the named argument.
+		/// </summary>
+		/// <returns>The index, or -1 if the kernel has no such argument</returns>
+		int32_t GetArgumentIndex(const std::string& name) const;
 
 		template<typename T>
 		bool SetArgument(cl_uint arg_index,
 						 const T& arg_value)
 		{
-			mIsValid = SetArgument(arg_index, sizeof(T), &arg_value);
+			if constexpr (std::is_same_v<T, Buffer>)
+			{
+				const cl_mem mem = arg_value.Get();
+				if (arg_value.IsSVM())
+					mIsValid = SetArgumentSVMPointer(arg_index, arg_value.GetSVMPointer());
+				else
+					mIsValid = SetArgument(arg_index, sizeof(cl_mem), &mem);
+			}
+			else
+			{
+				static_assert(std::is_trivially_copyable_v<T>, "Kernel arguments passed by value must be trivially copyable");
+				mIsValid = SetArgument(arg_index, sizeof(T), &arg_value);
+			}
 			return mIsValid;
 		}
 
-		template<>
-		bool SetArgument(cl_uint arg_index,
-						 const OpenCL::Buffer& buffer)
+		template<typename T>
+		bool SetArgument(const std::string& name,
+						 const T& arg_value)
 		{
-			mIsValid = buffer.AttachToKernel(mpKernel, arg_index);
-			return mIsValid;
+			const int32_t index = GetArgumentIndex(name);
+			if (index < 0)
+				return ReportUnknownArgument(name);
+			return SetArgument(static_cast<cl_uint>(index), arg_value);
 		}
 
+		/// <summary>
+		/// Caches the argument's value, it's bound on the next flush only if it differs from the last one.
+		/// A null value with a size reserves __local memory.
+		/// </summary>
+		/// <returns>True if the index and size fit the kernel's argument</returns>
 		bool SetArgument(cl_uint arg_index,
 						 size_t arg_size,
 						 const void* arg_value);
+
+		/// <summary>
+		/// Caches a shared virtual memory pointer for the argument.
+		/// </summary>
+		bool SetArgumentSVMPointer(cl_uint arg_index,
+								   const void* pointer);
+
+		/// <summary>
+		/// Binds every argument changed since the last flush, called before each enqueue.
+		/// </summary>
+		/// <returns>False if the driver rejected an argument</returns>
+		bool FlushArguments() const;
+
+		/// <summary>
+		/// Forces the argument to be bound on the next flush, e.g. after binding it directly through clSetKernelArg.
+		/// </summary>
+		void MarkArgumentDirty(cl_uint arg_index) const;
+
+		bool IsArgumentDirty(cl_uint arg_index) const;
+
+		/// <summary>
+		/// Counter bumped whenever an argument's cached value changes, lets recordings of the
+		/// kernel tell whether they captured stale arguments.
+		/// </summary>
+		inline uint64_t GetArgumentVersion() const { return mArgumentVersion; }
+
+		inline size_t GetArgumentCount() const { return mArguments.size(); }
+
+		/// <summary>
+		/// Retrieves an argument's cached value, e.g. to update a recorded dispatch. Shared virtual
+		/// memory arguments retrieve the pointer itself, __local ones a null value with their size.
+		/// </summary>
+		/// <returns>False if the argument wasn't set</returns>
+		bool GetArgumentValue(cl_uint arg_index,
+							  const void*& value,
+							  size_t& size,
+							  bool& bSVM) const;
+
+		/// <summary>
+		/// Retrieves the local size selected for dispatches of a global size class on the device,
+		/// lets repeated dispatches skip the selection. A zero size is the driver's choice.
+		/// </summary>
+		/// <returns>False if no size was cached</returns>
+		bool FindLocalSize(cl_device_id device,
+						   uint32_t sizeClass,
+						   size_t* output) const;
+
+		void CacheLocalSize(cl_device_id device,
+							uint32_t sizeClass,
+							const size_t* localSize) const;
 	private:
 		void Initialize(cl_program program, 
 						const std::string& kernalName);
+
+		void QueryInfo(cl_device_id device,
+					   uint64_t programHash);
+
+		bool ReportUnknownArgument(const std::string& name);
+	private:
+		struct ArgumentValue
+		{
+			std::vector<uint8_t> Bytes;
+			size_t Size = 0;
+
+			bool bSVM = false;
+			bool bSet = false;
+			bool bDirty = false;
+		};
+
+		struct CachedLocalSize
+		{
+			cl_device_id Device = nullptr;
+			uint32_t SizeClass = 0;
+			size_t Size[3] = {};
+		};
 	private:
 		std::string mName;
 		cl_kernel mpKernel;
 		bool mIsValid;
+
+		std::shared_ptr<const KernelInfo> mpInfo;
+
+		// Host-side copies of the argument values, flushed lazily at enqueue
+		mutable std::vector<ArgumentValue> mArguments;
+		uint64_t mArgumentVersion = 0;
+
+		// Few devices and size classes per kernel, a linear search beats hashing
+		mutable std::vector<CachedLocalSize> mLocalSizes;
 	};
 }
\ No newline at end of file
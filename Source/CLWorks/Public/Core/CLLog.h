@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Core/CLCore.h"
+
+#include <functional>
+
+namespace OpenCL
+{
+	enum class LogLevel : uint8_t
+	{
+		Verbose,
+		Log,
+		Warning,
+		Error,
+	};
+
+	using LogSink = std::function<void(LogLevel level, const char* message)>;
+
+	/// <summary>
+	/// Replaces where core messages are written, an empty sink restores the default.
+	/// The default forwards to LogCLWorks inside Unreal and to stderr otherwise.
+	/// </summary>
+	CLWORKS_API void SetLogSink(LogSink sink);
+
+	/// <summary>
+	/// Formats a printf style message and writes it to the sink.
+	/// </summary>
+	CLWORKS_API void LogMessage(LogLevel level, 
+								const char* format, 
+								...);
+}
+
+#define CL_LOG(Level, Format, ...) OpenCL::LogMessage(OpenCL::LogLevel::Level, Format, ##__VA_ARGS__)
+
+#if CLWORKS_WITH_UNREAL
+	#define CL_ASSERT(Expr) check(Expr)
+#else
+	#include <cassert>
+	#define CL_ASSERT(Expr) assert(Expr)
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Core/CLBuffer.h"
+#include "Core/CLCommandQueue.h"
+#include "Core/CLContext.h"
+#include "Core/CLKernel.h"
+
+#include <memory>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// Splits kernel dispatches across several devices of one context, e.g. a CPU and a GPU.
+	/// The global range is divided along its last dimension proportionally to each device's
+	/// measured throughput, smoothed over dispatches.
+	/// </summary>
+	class CLWORKS_API MultiDeviceExecutor
+	{
+	public:
+		/// <summary>
+		/// A buffer argument whose slices along the split dimension are bound per device.
+		/// Each device gets a sub-buffer (or offset SVM pointer) of its slice migrated to it,
+		/// so the kernel must index it relative to get_global_offset() of the split dimension.
+		/// </summary>
+		struct PartitionedArgument
+		{
+			cl_uint ArgIndex = 0;
+			const OpenCL::Buffer* Buffer = nullptr;
+
+			// Bytes of the buffer per index of the split dimension
+			size_t BytesPerSlice = 0;
+		};
+	public:
+		/// <param name="context">Context created with all of the devices</param>
+		MultiDeviceExecutor(const ContextPtr& context,
+							const std::vector<DevicePtr>& devices);
+
+		~MultiDeviceExecutor();
+	public:
+		bool IsValid() const { return !mDevices.empty(); }
+
+		size_t GetDeviceCount() const { return mDevices.size(); }
+
+		const CommandQueue& GetQueue(size_t deviceIndex) const { return *mDevices[deviceIndex].Queue; }
+
+		/// <summary>
+		/// Fraction of the global range the device currently receives.
+		/// </summary>
+		double GetSplitRatio(size_t deviceIndex) const;
+
+		/// <summary>
+		/// Weight of the newest throughput sample, 1 follows the last dispatch only.
+		/// </summary>
+		void SetSmoothing(double alpha) { mSmoothing = alpha; }
+
+		/// <summary>
+		/// Overrides the learned split, ratios are normalized. Further dispatches keep adapting.
+		/// </summary>
+		void SetSplitRatios(const std::vector<double>& ratios);
+
+		/// <summary>
+		/// Enqueues the kernel on every device with its share of the range, each device gets at
+		/// least one granule when the range has enough. The global size of the split dimension
+		/// must be a multiple of its local size when one is given.
+		/// </summary>
+		/// <param name="partitioned">Buffers bound per device slice, the kernel's other arguments are shared</param>
+		/// <returns>False if any part failed to enqueue</returns>
+		bool EnqueueRange(Kernel& kernel,
+						  size_t work_dim,
+						  const size_t* global_work_size,
+						  const size_t* local_work_size = nullptr,
+						  const std::vector<PartitionedArgument>& partitioned = {});
+
+		/// <summary>
+		/// Waits for all devices and updates the split ratios from the dispatches' timings.
+		/// </summary>
+		void WaitForFinish();
+	private:
+		struct DeviceState
+		{
+			DevicePtr Device;
+			std::unique_ptr<CommandQueue> Queue;
+
+			// Relative estimate from the device's capabilities until measured
+			double Seed = 1.0;
+
+			// Smoothed work-items per second, zero until measured
+			double Throughput = 0.0;
+		};
+
+		struct PendingPart
+		{
+			size_t DeviceIndex = 0;
+			size_t WorkItems = 0;
+
+			// First command of the part (migration or kernel) and the kernel
+			cl_event FirstEvent = nullptr;
+			cl_event KernelEvent = nullptr;
+		};
+	private:
+		size_t GetGranularity(size_t work_dim,
+							  const size_t* local_work_size,
+							  const std::vector<PartitionedArgument>& partitioned) const;
+
+		void UpdateThroughput(const PendingPart& part);
+	private:
+		ContextPtr mpContext;
+		std::vector<DeviceState> mDevices;
+		std::vector<PendingPart> mPending;
+
+		double mSmoothing = 0.25;
+	};
+}
\ No newline at end of file
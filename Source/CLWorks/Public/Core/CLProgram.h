@@ -20,6 +20,18 @@ namespace OpenCL
 		~Program();
 	public:
 		cl_program Get() const { return mpProgram; };
+
+		inline DevicePtr GetDevicePtr() const { return mpDevice.lock(); }
+
+		/// <summary>
+		/// Hash of the source and build options the program was built from, stable between runs.
+		/// </summary>
+		inline uint64_t GetSourceHash() const { return mSourceHash; }
+
+		/// <summary>
+		/// Hashes a program source with the build options programs are built with.
+		/// </summary>
+		static uint64_t HashSource(const std::string& source);
 	public:
 		bool ReadFromFile(const std::filesystem::path& file, 
 						  std::string* errMsg = nullptr);
@@ -34,6 +46,7 @@ namespace OpenCL
 								std::string* errMsg);
 	private:
 		cl_program mpProgram;
+		uint64_t mSourceHash = 0;
 
 		std::weak_ptr<Context> mpContext;
 		std::weak_ptr<Device> mpDevice;
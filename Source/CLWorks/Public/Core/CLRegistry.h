@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core/CLCommandQueue.h"
+#include "Core/CLContext.h"
+#include "Core/CLDevice.h"
+#include "Core/CLProgram.h"
+
+#include <memory>
+#include <string>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// Process-wide owner of shared OpenCL state. Every device gets one context that all
+	/// objects created through the registry share, so their buffers, images and programs interoperate.
+	/// Queues are handed out per thread and dropped once it exits, compiled programs are cached
+	/// per context and device.
+	/// </summary>
+	class CLWORKS_API Registry
+	{
+	public:
+		/// <summary>
+		/// The shared device for the indices, resolved the way Device does.
+		/// </summary>
+		/// <returns>Nullptr if the indices are out of range</returns>
+		static DevicePtr GetDevice(uint32_t deviceIndex = 0,
+								   uint32_t platformIndex = 0);
+
+		/// <summary>
+		/// The shared context of the device, created on first request.
+		/// </summary>
+		static ContextPtr GetContext(const DevicePtr& device);
+
+		/// <summary>
+		/// The calling thread's queue on the device within the device's shared context.
+		/// </summary>
+		static std::shared_ptr<CommandQueue> GetQueue(const DevicePtr& device);
+
+		/// <summary>
+		/// The calling thread's queue on the device within any context, e.g. one made outside the registry.
+		/// </summary>
+		static std::shared_ptr<CommandQueue> GetQueue(const ContextPtr& context,
+													  const DevicePtr& device);
+
+		/// <summary>
+		/// Retrieves a named program, compiling it once per context, device and source.
+		/// </summary>
+		/// <param name="name">The program name</param>
+		/// <param name="source">The program source, compiled on the first request with its hash and build options</param>
+		/// <param name="errMsg">The build log if compilation failed</param>
+		/// <returns>The compiled program, or nullptr on failure</returns>
+		static std::shared_ptr<Program> GetProgram(const std::string& name,
+												   const char* source,
+												   const ContextPtr& context,
+												   const DevicePtr& device,
+												   std::string* errMsg = nullptr);
+
+		/// <summary>
+		/// Drops every cached queue so later requests create new ones, e.g. once profiling was toggled.
+		/// Queues still referenced elsewhere keep their settings.
+		/// </summary>
+		static void ReleaseQueues();
+
+		/// <summary>
+		/// Releases every shared device, context, queue and program held by the registry.
+		/// Objects still referencing them keep them alive.
+		/// </summary>
+		static void Reset();
+	};
+}
\ No newline at end of file
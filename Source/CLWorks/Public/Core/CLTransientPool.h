@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Core/CLContext.h"
+
+#include <memory>
+#include <vector>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// Describes transient storage, buffers of a size or 2D images of a format and extent.
+	/// </summary>
+	struct CLWORKS_API TransientDesc
+	{
+		enum class Type : uint8_t
+		{
+			Buffer,
+			Image2D,
+		};
+
+		Type Kind = Type::Buffer;
+
+		size_t Size = 0;
+
+		cl_image_format Format = {};
+		size_t Width = 0;
+		size_t Height = 0;
+	public:
+		/// <summary>
+		/// Whether an allocation made for this description can hold the other, buffers fit any
+		/// smaller size while images need the same format and extent.
+		/// </summary>
+		bool CanHold(const TransientDesc& other) const;
+
+		/// <summary>
+		/// Estimated bytes of the allocation.
+		/// </summary>
+		size_t GetBytes() const;
+	};
+
+	/// <summary>
+	/// Transient storage handed out by the pool for a range of a frame's passes.
+	/// </summary>
+	struct CLWORKS_API TransientAllocation
+	{
+		cl_mem Memory = nullptr;
+
+		// Last pass of the frame that used the memory before, -1 if it's the first use this frame
+		int32_t PreviousLastPass = -1;
+	};
+
+	/// <summary>
+	/// Device memory recycled across frames and aliased within one: storage whose last user pass
+	/// finished is handed to resources first used by a later pass. Allocations unused for a few
+	/// frames are released.
+	/// </summary>
+	class CLWORKS_API TransientPool
+	{
+	public:
+		TransientPool(const ContextPtr& context);
+
+		~TransientPool();
+
+		TransientPool(const TransientPool&) = delete;
+		TransientPool& operator=(const TransientPool&) = delete;
+	public:
+		inline const ContextPtr& GetContext() const { return mpContext; }
+
+		/// <summary>
+		/// Makes every allocation available again, the previous frame's passes are done with them.
+		/// </summary>
+		void BeginFrame();
+
+		/// <summary>
+		/// Retrieves storage for a resource used from the first through the last pass of the frame,
+		/// reusing the smallest free allocation that can hold it.
+		/// </summary>
+		/// <returns>Null memory if a new allocation failed</returns>
+		TransientAllocation Allocate(const TransientDesc& desc,
+									 uint32_t firstPass,
+									 uint32_t lastPass);
+
+		/// <summary>
+		/// Releases allocations that weren't used for the given number of frames.
+		/// </summary>
+		void EndFrame(uint32_t framesBeforeRelease = 3);
+
+		/// <summary>
+		/// Releases every allocation.
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Bytes currently allocated by the pool.
+		/// </summary>
+		size_t GetAllocatedBytes() const;
+
+		inline size_t GetAllocationCount() const { return mAllocations.size(); }
+	private:
+		struct Allocation
+		{
+			cl_mem Memory = nullptr;
+			TransientDesc Desc;
+
+			uint64_t LastUsedFrame = 0;
+
+			// Last pass of the current frame using the allocation, -1 while free
+			int32_t BusyUntilPass = -1;
+		};
+	private:
+		ContextPtr mpContext;
+
+		std::vector<Allocation> mAllocations;
+		uint64_t mFrame = 0;
+	};
+}
\ No newline at end of file
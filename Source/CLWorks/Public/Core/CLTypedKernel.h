@@ -0,0 +1,213 @@
+#pragma once
+
+#include "Core/CLCore.h"
+#include "Core/CLKernel.h"
+
+// Images depend on the engine's textures
+#if CLWORKS_WITH_UNREAL
+	#include "Core/CLImage.h"
+#endif
+
+#include <array>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace OpenCL
+{
+	/// <summary>
+	/// Tag reserving __local memory for an argument, the kernel receives a pointer to it.
+	/// </summary>
+	struct LocalMemory
+	{
+		size_t Size = 0;
+	};
+
+	/// <summary>
+	/// Reserves __local memory for count elements of T.
+	/// </summary>
+	template<typename T>
+	constexpr LocalMemory LocalArray(size_t count)
+	{
+		return LocalMemory{ sizeof(T) * count };
+	}
+
+	namespace Detail
+	{
+		enum class ArgumentKind : uint8_t
+		{
+			Value,
+			MemoryObject,
+			SVMPointer,
+			Sampler,
+			Local,
+		};
+
+		template<typename T>
+		struct KernelArgument
+		{
+			static_assert(!std::is_reference_v<T>, "Kernel signatures take arguments by type, not reference");
+			static_assert(std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>,
+						  "Kernel arguments passed by value must be trivially copyable, standard layout types");
+
+			static constexpr ArgumentKind Kind = ArgumentKind::Value;
+			static constexpr size_t Size = sizeof(T);
+
+			static bool Bind(Kernel& kernel, cl_uint index, const T& value)
+			{
+				return kernel.SetArgument(index, sizeof(T), &value);
+			}
+		};
+
+		template<>
+		struct KernelArgument<Buffer>
+		{
+			static constexpr ArgumentKind Kind = ArgumentKind::MemoryObject;
+			static constexpr size_t Size = sizeof(cl_mem);
+
+			static bool Bind(Kernel& kernel, cl_uint index, const Buffer& buffer)
+			{
+				return kernel.SetArgument(index, buffer);
+			}
+		};
+
+	#if CLWORKS_WITH_UNREAL
+		template<>
+		struct KernelArgument<Image>
+		{
+			static constexpr ArgumentKind Kind = ArgumentKind::MemoryObject;
+			static constexpr size_t Size = sizeof(cl_mem);
+
+			static bool Bind(Kernel& kernel, cl_uint index, const Image& image)
+			{
+				const cl_mem mem = image.Get();
+				return kernel.SetArgument(index, sizeof(cl_mem), &mem);
+			}
+		};
+	#endif
+
+		template<>
+		struct KernelArgument<cl_mem>
+		{
+			static constexpr ArgumentKind Kind = ArgumentKind::MemoryObject;
+			static constexpr size_t Size = sizeof(cl_mem);
+
+			static bool Bind(Kernel& kernel, cl_uint index, cl_mem mem)
+			{
+				return kernel.SetArgument(index, sizeof(cl_mem), &mem);
+			}
+		};
+
+		template<>
+		struct KernelArgument<cl_sampler>
+		{
+			static constexpr ArgumentKind Kind = ArgumentKind::Sampler;
+			static constexpr size_t Size = sizeof(cl_sampler);
+
+			static bool Bind(Kernel& kernel, cl_uint index, cl_sampler sampler)
+			{
+				return kernel.SetArgument(index, sizeof(cl_sampler), &sampler);
+			}
+		};
+
+		template<typename T>
+		struct KernelArgument<T*>
+		{
+			// Other handles are pointers as well, but can't be kernel arguments
+			static_assert(!std::is_same_v<std::remove_cv_t<T>, _cl_platform_id> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_device_id> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_context> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_command_queue> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_program> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_kernel> &&
+						  !std::is_same_v<std::remove_cv_t<T>, _cl_event>,
+						  "Raw pointers bind shared virtual memory, OpenCL handles other than cl_mem and cl_sampler can't be arguments");
+
+			static constexpr ArgumentKind Kind = ArgumentKind::SVMPointer;
+			static constexpr size_t Size = 0;
+
+			static bool Bind(Kernel& kernel, cl_uint index, T* pointer)
+			{
+				return kernel.SetArgumentSVMPointer(index, pointer);
+			}
+		};
+
+		template<>
+		struct KernelArgument<LocalMemory>
+		{
+			static constexpr ArgumentKind Kind = ArgumentKind::Local;
+			static constexpr size_t Size = 0;
+
+			static bool Bind(Kernel& kernel, cl_uint index, const LocalMemory& local)
+			{
+				return kernel.SetArgument(index, local.Size, nullptr);
+			}
+		};
+
+		struct SignatureArgument
+		{
+			ArgumentKind Kind = ArgumentKind::Value;
+			size_t Size = 0;
+		};
+
+		/// <summary>
+		/// Checks the signature against the kernel's reflected arguments, logging every mismatch.
+		/// Kernels without argument info pass.
+		/// </summary>
+		CLWORKS_API bool CheckSignature(const Kernel& kernel,
+										const SignatureArgument* arguments,
+										size_t count);
+	}
+
+	/// <summary>
+	/// A kernel with its signature fixed at compile time, e.g. TypedKernel<Buffer, Buffer, float, LocalMemory>.
+	/// Value types are checked to be trivially copyable when compiled and the signature, including value sizes,
+	/// against the kernel once on creation, so binding every argument per dispatch is a single call without lookups.
+	/// Raw pointers bind shared virtual memory, cl_mem and cl_sampler handles bind as memory objects and samplers.
+	/// </summary>
+	template<typename... Args>
+	class TypedKernel
+	{
+	public:
+		TypedKernel(const Program& program,
+					const std::string& kernelName)
+			: mKernel(program, kernelName)
+		{
+			static constexpr std::array<Detail::SignatureArgument, sizeof...(Args)> Signature =
+			{
+				Detail::SignatureArgument{ Detail::KernelArgument<std::remove_cv_t<Args>>::Kind,
+										   Detail::KernelArgument<std::remove_cv_t<Args>>::Size }...
+			};
+
+			mIsValid = mKernel.IsValid() && Detail::CheckSignature(mKernel, Signature.data(), Signature.size());
+		}
+
+		TypedKernel(const TypedKernel&) = delete;
+		TypedKernel& operator=(const TypedKernel&) = delete;
+	public:
+		operator const Kernel&() const { return mKernel; }
+		inline Kernel& GetKernel() { return mKernel; }
+
+		inline bool IsValid() const { return mIsValid && mKernel.IsValid(); }
+
+		/// <summary>
+		/// Binds every argument, only the changed ones reach the driver on the next enqueue.
+		/// </summary>
+		/// <returns>True if all arguments were accepted</returns>
+		bool operator()(const Args&... args)
+		{
+			if (!mIsValid)
+				return false;
+			return Bind(std::index_sequence_for<Args...>{}, args...);
+		}
+	private:
+		template<size_t... Indices>
+		bool Bind(std::index_sequence<Indices...>, const Args&... args)
+		{
+			return (Detail::KernelArgument<std::remove_cv_t<Args>>::Bind(mKernel, static_cast<cl_uint>(Indices), args) && ...);
+		}
+	private:
+		Kernel mKernel;
+		bool mIsValid = false;
+	};
+}
\ No newline at end of file
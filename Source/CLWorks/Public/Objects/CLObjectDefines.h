@@ -41,3 +41,52 @@ enum class UCLImageFormat : uint8
 	R32				UMETA(DisplayName = "32F Red"),
 	RGBA32			UMETA(DisplayName = "32F RGBA"),
 };
+
+UENUM(BlueprintType)
+enum class UCLTextureCompression : uint8
+{
+	BC1				UMETA(DisplayName = "BC1 (RGB)"),
+	BC4				UMETA(DisplayName = "BC4 (Red)"),
+	BC5				UMETA(DisplayName = "BC5 (Red-Green)"),
+	BC7				UMETA(DisplayName = "BC7 (RGBA)"),
+};
+
+USTRUCT(BlueprintType)
+struct CLWORKS_API FCLKernelArgumentInfo
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	FString Name;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	FString TypeName;
+
+	// Bytes a value must have, zero for __local arguments and unknown types
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	int32 Size = 0;
+};
+
+USTRUCT(BlueprintType)
+struct CLWORKS_API FCLKernelInfo
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	int64 WorkGroupSize = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	int64 PreferredWorkGroupMultiple = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	FIntVector CompileWorkGroupSize = FIntVector::ZeroValue;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	int64 PrivateMemSize = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	int64 LocalMemSize = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "CLWorks")
+	TArray<FCLKernelArgumentInfo> Arguments;
+};
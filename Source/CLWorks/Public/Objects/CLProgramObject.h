@@ -96,6 +96,21 @@ public:
 	/// <returns>True if the operation was successful</returns>
 	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Set Image Argument")
 	bool SetImageArg(int32 index, UCLImageObject* image);
+
+	/// <summary>
+	/// Retrieves the index of a named argument, resolve it once and reuse it with the setters.
+	/// </summary>
+	/// <param name="argumentName">The argument name as written in the kernel source</param>
+	/// <returns>The argument index, or -1 if the kernel has no such argument</returns>
+	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Find Argument Index")
+	int32 FindArgumentIndex(const FString& argumentName) const;
+
+	/// <summary>
+	/// Retrieves the kernel's work-group properties and arguments.
+	/// </summary>
+	/// <returns>The kernel info, empty if the kernel is invalid</returns>
+	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Get Kernel Info")
+	FCLKernelInfo GetKernelInfo() const;
 protected:
 	void Initialize(const TObjectPtr<UCLContextObject>& context,
 					const TObjectPtr<UCLProgramAsset>& program, 
@@ -107,6 +122,6 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CLWorks")
 	FString Name;
 private:
-	std::unique_ptr<OpenCL::Program> mpProgram = nullptr;
+	std::shared_ptr<OpenCL::Program> mpProgram = nullptr;
 	std::unique_ptr<OpenCL::Kernel> mpKernel = nullptr;
 };
\ No newline at end of file
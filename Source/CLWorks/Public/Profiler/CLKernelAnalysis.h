@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Core/CLDevice.h"
+#include "Core/CLKernel.h"
+
+#include "Profiler/CLProfilerManager.h"
+
+/// <summary>
+/// Work a kernel does per work item, declared by the caller since it
+/// can't be derived from the binary.
+/// </summary>
+struct CLWORKS_API FCLKernelCost
+{
+	// Global memory read and written
+	double BytesPerWorkItem = 0.0;
+
+	// Arithmetic operations, a fused multiply-add counts as two
+	double OpsPerWorkItem = 0.0;
+};
+
+/// <summary>
+/// Sustained device throughput measured by the built-in microbenchmark.
+/// </summary>
+struct CLWORKS_API FCLDevicePeaks
+{
+	double BandwidthGBps = 0.0;
+	double GFlops = 0.0;
+
+	bool IsValid() const { return BandwidthGBps > 0.0 && GFlops > 0.0; }
+
+	// Arithmetic intensity (ops per byte) above which kernels are compute-bound
+	double GetRidgePoint() const { return IsValid() ? GFlops / BandwidthGBps : 0.0; }
+};
+
+/// <summary>
+/// Occupancy and roofline placement of a kernel over all analyzed dispatches.
+/// </summary>
+struct CLWORKS_API FCLKernelAnalysisResult
+{
+	FName Name;
+
+	uint64 Dispatches = 0;
+	double AverageMs = 0.0;
+
+	// Fraction of a compute unit's work items kept resident, limited by local memory and group size
+	double Occupancy = 0.0;
+
+	// Fraction of compute unit slots filled across all waves of work-groups
+	double WaveEfficiency = 0.0;
+
+	bool bHasCost = false;
+
+	double AchievedGBps = 0.0;
+	double AchievedGFlops = 0.0;
+	double ArithmeticIntensity = 0.0;
+
+	// Achieved throughput relative to the device peaks, zero without measured peaks
+	double BandwidthUtilization = 0.0;
+	double ComputeUtilization = 0.0;
+
+	bool bMemoryBound = false;
+};
+
+/// <summary>
+/// Combines completed kernel profiles with device limits and declared kernel
+/// costs into occupancy and roofline figures, fed by the profiler on tick.
+/// 
+/// Occupancy is the theoretical one visible through OpenCL: a compute unit is
+/// assumed to hold at most the device's maximum work-group size in work items,
+/// reduced by the kernel's local memory use.
+/// </summary>
+class CLWORKS_API FCLKernelAnalysis
+{
+public:
+	/// <summary>
+	/// Declares the work of a kernel, enabling its bandwidth and FLOP/s reports.
+	/// </summary>
+	/// <param name="kernelName">The kernel function name</param>
+	/// <param name="cost">The per work item cost</param>
+	static void DeclareKernelCost(FName kernelName,
+								  const FCLKernelCost& cost);
+
+	/// <summary>
+	/// Runs the bandwidth and FMA microbenchmarks on a device, blocking until done.
+	/// </summary>
+	/// <param name="device">The device</param>
+	/// <param name="output">The measured peaks</param>
+	/// <returns>True if both benchmarks completed</returns>
+	static bool MeasurePeaks(const OpenCL::DevicePtr& device,
+							 FCLDevicePeaks& output);
+
+	/// <summary>
+	/// Retrieves the last measured peaks of a device.
+	/// </summary>
+	static bool GetPeaks(cl_device_id device,
+						 FCLDevicePeaks& output);
+
+	/// <summary>
+	/// Computes the theoretical occupancy of a dispatch, limited by the resident work items, local and private memory of a compute unit.
+	/// </summary>
+	/// <param name="metrics">The device limits</param>
+	/// <param name="info">The kernel properties</param>
+	/// <param name="localWorkSize">The work items per group</param>
+	/// <returns>The resident fraction of a compute unit in [0, 1]</returns>
+	static double GetTheoreticalOccupancy(const FCLHardwareMetrics& metrics,
+										  const OpenCL::Kernel::KernelInfo& info,
+										  uint64 localWorkSize);
+
+	/// <summary>
+	/// Retrieves the analysis of a kernel, safe from any thread.
+	/// </summary>
+	static bool GetKernelAnalysis(FName kernelName,
+								  FCLKernelAnalysisResult& output);
+
+	/// <summary>
+	/// Retrieves the analysis of all profiled kernels, safe from any thread.
+	/// </summary>
+	static TArray<FCLKernelAnalysisResult> GetAllKernelAnalysis();
+
+	/// <summary>
+	/// Logs the analysis of all profiled kernels, slowest first.
+	/// </summary>
+	static void Dump();
+
+	/// <summary>
+	/// Clears the accumulated dispatches, declared costs and peaks are kept.
+	/// </summary>
+	static void Reset();
+
+	/// <summary>
+	/// Accumulates the completed profiles, called by the profiler on tick.
+	/// </summary>
+	static void Process(const TArray<FKernelProfile>& kernels);
+};
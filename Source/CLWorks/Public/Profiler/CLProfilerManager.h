@@ -1,12 +1,15 @@
 #pragma once
 
 #include "Tickable.h"
+#include "Delegates/Delegate.h"
 
 #include "Core/CLCommandQueue.h"
 #include "Core/CLKernel.h"
 #include "Core/CLEvent.h"
+#include "Core/CLInstrumentation.h"
 
-#include <mutex>
+#include <atomic>
+#include <memory>
 
 struct CLWORKS_API FCLHardwareMetrics
 {
@@ -14,6 +17,78 @@ struct CLWORKS_API FCLHardwareMetrics
 	size_t MaxWorkGroupSize = 0;
 	cl_ulong GlobalMemSize = 0;
 	cl_ulong LocalMemSize = 0;
+
+	// Per compute unit, zero resident work items falls back to the largest group and zero private memory is unbounded
+	size_t MaxResidentWorkItems = 0;
+	cl_ulong PrivateMemSize = 0;
+};
+
+/// <summary>
+/// Aggregated timings of a kernel over the most recent dispatches.
+/// </summary>
+struct CLWORKS_API FCLKernelStats
+{
+	FName Name;
+
+	// Dispatches in the window
+	int32 Count = 0;
+
+	// Lifetime dispatches
+	uint64 TotalCount = 0;
+
+	double TotalMs = 0.0;
+	double MinMs = 0.0;
+	double MaxMs = 0.0;
+
+	double P50Ms = 0.0;
+	double P95Ms = 0.0;
+	double P99Ms = 0.0;
+
+	double GetAverageMs() const { return Count > 0 ? TotalMs / Count : 0.0; }
+};
+
+// Shared with the core's instrumentation
+using ECLTransferDirection = OpenCL::TransferDirection;
+using ECLTransferCommand = OpenCL::TransferCommand;
+
+/// <summary>
+/// Accumulated transfers, bytes are only counted on the command moving the data.
+/// </summary>
+struct CLWORKS_API FCLTransferStats
+{
+	uint64 Count = 0;
+	uint64 Bytes = 0;
+	uint64 DeviceTimeNs = 0;
+
+	double GetGBps() const { return DeviceTimeNs > 0 ? double(Bytes) / double(DeviceTimeNs) : 0.0; }
+};
+
+struct CLWORKS_API FTransferProfile
+{
+public:
+	uint64_t GetDurationNs() const
+	{
+		return (mEndTimeNs > mStartTimeNs) ? mEndTimeNs - mStartTimeNs : 0;
+	}
+public:
+	cl_command_queue mpQueue = nullptr;
+
+	// The owning queue's id, its handle may be reused once released
+	uint64_t mQueueId = 0;
+	cl_device_id mpDevice = nullptr;
+
+	ECLTransferDirection mDirection = ECLTransferDirection::Upload;
+	ECLTransferCommand mCommand = ECLTransferCommand::Read;
+	OpenCL::MemoryStrategy mStrategy = OpenCL::MemoryStrategy::INVALID;
+
+	uint64_t mBytes = 0;
+
+	// Host time of the enqueue, correlates device time when the device can't report host time
+	uint64_t mEnqueueCycles = 0;
+
+	uint64_t mQueuedTimeNs = 0;
+	uint64_t mStartTimeNs = 0;
+	uint64_t mEndTimeNs = 0;
 };
 
 struct CLWORKS_API FKernelProfile
@@ -28,23 +103,28 @@ public:
 	{
 		return (mLocalWorkSize > 0) ? mGlobalWorkSize / mLocalWorkSize : 0;
 	}
+
+	const std::string& GetName() const;
 public:
-	std::string mName;
-	cl_event mEvent;
+	// Shared with the kernel, holds the name and work-group properties
+	std::shared_ptr<const OpenCL::Kernel::KernelInfo> mpInfo;
+
+	cl_command_queue mpQueue = nullptr;
+	cl_device_id mpDevice = nullptr;
+
+	// Host time of the enqueue, correlates device time when the device can't report host time
+	uint64_t mEnqueueCycles = 0;
+
+	uint64_t mQueuedTimeNs = 0;
 	uint64_t mStartTimeNs = 0;
 	uint64_t mEndTimeNs = 0;
 
-	size_t KernelWorkGroupSize = 0;
-	size_t CompiledWorkGroupSize[3] = {};
-	size_t PreferredWorkGroupMultiple = 0;
-
 	uint64_t mGlobalWorkSize = 0;
 	uint64_t mLocalWorkSize = 0;
-
-	cl_ulong PrivateMemSize = 0;
-	cl_ulong LocalMemSizeUsed = 0;
 };
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FCLOnProfilingChanged, bool /* bEnabled */);
+
 class CLWORKS_API FCLProfilerManager : public FTickableGameObject
 {
 public:
@@ -61,20 +141,108 @@ public:
 
 	virtual TStatId GetStatId() const override;
 public:
+	/// <summary>
+	/// Whether new command queues are created with profiling, controlled by
+	/// the CLWorks.Profiling console variable (on in editor builds) or -CLProfile.
+	/// </summary>
+	static bool IsProfilingEnabled();
+
+	/// <summary>
+	/// Broadcast on the game thread once CLWorks.Profiling was toggled, after the shared queues
+	/// were dropped. Owners of long lived queues recreate them to pick up the setting.
+	/// </summary>
+	static FCLOnProfilingChanged& OnProfilingChanged();
+
+	/// <summary>
+	/// Tracks a dispatched kernel, the profiler takes ownership of the event.
+	/// Completion is reported by the runtime through an event callback, which
+	/// pushes the timings into a lock-free ring drained on tick.
+	/// </summary>
 	static void EnqueueProfiledKernel(const OpenCL::CommandQueue& queue,
 									  const OpenCL::Kernel& kernel,
 									  const OpenCL::Event& event,
 									  size_t work_dim,
 									  const size_t* global_work_size,
 									  const size_t* local_work_size);
+
+	/// <summary>
+	/// Tracks a transfer or map command, the profiler takes ownership of the event.
+	/// Image transfers have no memory strategy and are reported under INVALID.
+	/// </summary>
+	static void EnqueueProfiledTransfer(const OpenCL::CommandQueue& queue,
+										cl_event event,
+										ECLTransferDirection direction,
+										ECLTransferCommand command,
+										uint64_t bytes,
+										OpenCL::MemoryStrategy strategy = OpenCL::MemoryStrategy::INVALID);
+
+	/// <summary>
+	/// Retrieves the transfers of a memory strategy since the last reset, safe from any thread.
+	/// </summary>
+	static FCLTransferStats GetTransferStats(OpenCL::MemoryStrategy strategy,
+											 ECLTransferDirection direction);
+
+	/// <summary>
+	/// Retrieves the transfers of a command queue since the last reset, safe from any thread.
+	/// </summary>
+	static FCLTransferStats GetQueueTransferStats(const OpenCL::CommandQueue& queue,
+												  ECLTransferDirection direction);
+
+	/// <summary>
+	/// Drops the transfer stats of a queue being released, its transfers completing afterwards aren't counted per queue.
+	/// </summary>
+	static void ReleaseQueueStats(const OpenCL::CommandQueue& queue);
+
+	/// <summary>
+	/// Clears all transfer stats.
+	/// </summary>
+	static void ResetTransferStats();
+
+	/// <summary>
+	/// Retrieves the rolling window stats of a kernel, safe from any thread.
+	/// </summary>
+	/// <param name="kernelName">The kernel function name</param>
+	/// <param name="output">The stats</param>
+	/// <returns>True if the kernel has been profiled</returns>
+	static bool GetKernelStats(FName kernelName, 
+							   FCLKernelStats& output);
+
+	/// <summary>
+	/// Retrieves the rolling window stats of all profiled kernels, safe from any thread.
+	/// </summary>
+	static TArray<FCLKernelStats> GetAllKernelStats();
+
+	/// <summary>
+	/// Clears all kernel histories.
+	/// </summary>
+	static void ResetKernelStats();
 private:
-	void PollEvents();
+	static void CL_CALLBACK OnKernelComplete(cl_event event, cl_int status, void* userData);
+
+	static void CL_CALLBACK OnTransferComplete(cl_event event, cl_int status, void* userData);
+
+	void DrainCompleted();
 
 	void UpdateStats();
+
+	void UpdateKernelHistories();
+
+	void UpdateTransferStats();
+
+	void UpdateHardwareMetrics();
 private:
 	static FCLHardwareMetrics HardwareMetrics;
 
-	static TArray<FKernelProfile> ActiveKernels;
+	// Filled once the devices are enumerated, which happens off the game thread at startup
+	bool mbHasHardwareMetrics = false;
+
+	static std::atomic<int32> InFlightKernels;
+
+	static std::atomic<uint32> DroppedKernelProfiles;
+
+	static std::atomic<uint32> DroppedTransferProfiles;
+
+	TArray<FKernelProfile> CompletedKernels;
 
-	static TArray<FKernelProfile> CompletedKernels;
+	TArray<FTransferProfile> CompletedTransfers;
 };
\ No newline at end of file
@@ -5,6 +5,13 @@
 DECLARE_STATS_GROUP(TEXT("OpenCL"), STATGROUP_OpenCL, STATCAT_Advanced);
 
 DECLARE_FLOAT_COUNTER_STAT(TEXT("Kernel Time (ms)"), STAT_OpenCL_KernelTime, STATGROUP_OpenCL);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Kernel Dispatches"), STAT_OpenCL_KernelDispatches, STATGROUP_OpenCL);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Transfers"), STAT_OpenCL_Transfers, STATGROUP_OpenCL);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Upload (MB)"), STAT_OpenCL_UploadMB, STATGROUP_OpenCL);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback (MB)"), STAT_OpenCL_ReadbackMB, STATGROUP_OpenCL);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Upload Bandwidth (GB/s)"), STAT_OpenCL_UploadGBps, STATGROUP_OpenCL);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback Bandwidth (GB/s)"), STAT_OpenCL_ReadbackGBps, STATGROUP_OpenCL);
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("Total Compute Units"), STAT_OpenCL_TotalComputeUnits, STATGROUP_OpenCL);
 DECLARE_DWORD_COUNTER_STAT(TEXT("Total Work Groups"), STAT_OpenCL_TotalWorkgroups, STATGROUP_OpenCL);
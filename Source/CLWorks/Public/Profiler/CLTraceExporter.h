@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+#include "OpenCLLib.h"
+
+struct FKernelProfile;
+struct FTransferProfile;
+
+UE_TRACE_CHANNEL_EXTERN(CLWorksChannel, CLWORKS_API);
+
+/// <summary>
+/// Turns completed device profiles into a host-aligned timeline.
+/// While the CLWorks trace channel is enabled (-trace=gpu,clworks) events are
+/// emitted as GPU timing events on the Unreal Insights GPU track selected by
+/// CLWorks.Trace.GPUIndex and, while a capture is running, collected into a
+/// Chrome trace JSON file (chrome://tracing or Perfetto) with a row per queue.
+/// 
+/// Device timestamps are correlated with FPlatformTime cycles through
+/// clGetDeviceAndHostTimer, devices without it fall back to aligning the
+/// command's queued time with the host time of its enqueue. Insights receives
+/// the device timestamps along with that correlation as the frame's calibration.
+/// </summary>
+class CLWORKS_API FCLTraceExporter
+{
+public:
+	/// <summary>
+	/// Starts collecting a Chrome trace.
+	/// </summary>
+	/// <param name="filePath">The output file, defaults to Saved/Profiling/CLWorks</param>
+	static void StartCapture(const FString& filePath = FString());
+
+	/// <summary>
+	/// Stops collecting and writes the Chrome trace.
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	static bool StopCapture();
+
+	static bool IsCapturing();
+
+	/// <summary>
+	/// Emits the completed profiles, called by the profiler on tick.
+	/// </summary>
+	static void Process(const TArray<FKernelProfile>& kernels,
+						const TArray<FTransferProfile>& transfers);
+
+	/// <summary>
+	/// Drops the clock correlation of a released sub-device, safe from any thread.
+	/// </summary>
+	static void ReleaseDevice(cl_device_id device);
+private:
+	struct FClockSync
+	{
+		uint64 DeviceNs = 0;
+		uint64 HostCycles = 0;
+		double LastSyncSeconds = 0.0;
+		bool bSupported = true;
+	};
+
+	struct FTimingEvent
+	{
+		FName Name;
+		uint64 StartNs = 0;
+		uint64 EndNs = 0;
+	};
+
+	// A device's events of one tick, in device time
+	struct FTimingFrame
+	{
+		// Device and host time of the same instant
+		uint64 CalibrationDeviceNs = 0;
+		uint64 CalibrationHostCycles = 0;
+
+		TArray<FTimingEvent> Events;
+	};
+private:
+	/// <summary>
+	/// Re-correlates the device and host clocks once the last correlation is older than the sync interval.
+	/// </summary>
+	/// <returns>False if the device can't report its host time</returns>
+	static bool SyncClock(cl_device_id device,
+						  FClockSync& output);
+
+	static uint64 DeviceToCycles(cl_device_id device,
+								 uint64 deviceNs,
+								 uint64 queuedNs,
+								 uint64 enqueueCycles);
+
+	static void AddTimingEvent(FName name,
+							   cl_device_id device,
+							   uint64 startNs,
+							   uint64 endNs,
+							   uint64 queuedNs,
+							   uint64 enqueueCycles,
+							   TMap<cl_device_id, FTimingFrame>& timingFrames);
+
+	static void Emit(const TCHAR* name,
+					 const TCHAR* category,
+					 cl_command_queue queue,
+					 uint64 startCycles,
+					 uint64 endCycles,
+					 uint64 bytes);
+
+	static void EmitTimingEvents(TArray<FTimingFrame>&& timingFrames);
+private:
+	// Read by the profiler tick, pruned by device releases on any thread
+	static FCriticalSection ClockSyncLock;
+	static TMap<cl_device_id, FClockSync> ClockSyncs;
+
+	static bool bCapturing;
+	static FString CapturePath;
+	static uint64 CaptureStartCycles;
+	static TArray<FString> CaptureEvents;
+	static TMap<cl_command_queue, int32> CaptureQueues;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Core/CLCommandQueue.h"
+#include "Core/CLKernel.h"
+
+#include <memory>
+
+/// <summary>
+/// Picks local work sizes for dispatches that leave them to the driver.
+/// The first dispatches of a (kernel, program, device, global size class) cycle
+/// through candidate local sizes on profiling queues, the fastest one is
+/// kept and persisted to Saved/CLWorks/WorkGroupTuning.json. Kernels cache
+/// the tuned sizes so later dispatches on any queue skip the lookup.
+/// </summary>
+class CLWORKS_API FCLWorkGroupTuner
+{
+public:
+	struct FTrial
+	{
+		// The tuned entry, kernel name, program source hash, device name and global size class
+		FString mKey;
+		int32 mCandidate = INDEX_NONE;
+
+		bool IsActive() const { return mCandidate != INDEX_NONE; }
+	};
+public:
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Selects the local size of a dispatch without one.
+	/// </summary>
+	/// <param name="queue">The dispatching queue, only profiling queues run trials</param>
+	/// <param name="kernel">The kernel</param>
+	/// <param name="work_dim">The dimensions</param>
+	/// <param name="global_work_size">The global size</param>
+	/// <param name="output">Storage for the selected size</param>
+	/// <param name="trial">Set if the dispatch is a tuning trial</param>
+	/// <returns>The local size, nullptr to let the driver choose</returns>
+	static const size_t* SelectLocalSize(const OpenCL::CommandQueue& queue,
+										 const OpenCL::Kernel& kernel,
+										 size_t work_dim,
+										 const size_t* global_work_size,
+										 size_t* output,
+										 FTrial& trial);
+
+	/// <summary>
+	/// Times a trial dispatch, the tuner retains its own reference of the event.
+	/// </summary>
+	static void RecordTrial(const FTrial& trial, 
+							cl_event event);
+
+	/// <summary>
+	/// Excludes the candidate of a trial that failed to enqueue.
+	/// </summary>
+	static void RejectTrial(const FTrial& trial);
+
+	/// <summary>
+	/// Writes the tuned sizes if any changed.
+	/// </summary>
+	static void Save();
+
+	/// <summary>
+	/// Drops all tuned sizes, including the persisted ones.
+	/// </summary>
+	static void Reset();
+};
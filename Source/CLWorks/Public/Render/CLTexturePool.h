@@ -0,0 +1,96 @@
+#pragma once
+
+#include "UObject/GCObject.h"
+#include "UObject/ObjectKey.h"
+
+#include "Engine/Texture2D.h"
+
+struct CLWORKS_API FCLTexturePoolKey
+{
+public:
+	bool operator==(const FCLTexturePoolKey& other) const
+	{
+		return Width == other.Width &&
+			   Height == other.Height &&
+			   PixelFormat == other.PixelFormat &&
+			   NumMips == other.NumMips &&
+			   bSRGB == other.bSRGB;
+	}
+
+	friend uint32 GetTypeHash(const FCLTexturePoolKey& key)
+	{
+		uint32 hash = HashCombine(GetTypeHash(key.Width), GetTypeHash(key.Height));
+		hash = HashCombine(hash, GetTypeHash(static_cast<uint8>(key.PixelFormat)));
+		hash = HashCombine(hash, GetTypeHash(key.NumMips));
+		return HashCombine(hash, GetTypeHash(key.bSRGB));
+	}
+public:
+	int32 Width = 0;
+	int32 Height = 0;
+	EPixelFormat PixelFormat = PF_Unknown;
+	int32 NumMips = 1;
+	bool bSRGB = true;
+};
+
+/// <summary>
+/// Pool of transient UTexture2Ds keyed by size, format, mip count and sRGB.
+/// Released textures are kept alive and handed back on the next matching
+/// acquire, so repeated image-to-texture conversions upload in place instead
+/// of creating new UObjects and RHI resources. Only the owner a texture was
+/// handed out to can release it, so a texture already recycled for another
+/// request can't be released twice.
+/// </summary>
+class CLWORKS_API FCLTexturePool : public FGCObject
+{
+public:
+	FCLTexturePool();
+	~FCLTexturePool();
+public:
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+
+	virtual FString GetReferencerName() const override { return TEXT("FCLTexturePool"); }
+public:
+	/// <summary>
+	/// Retrieves a texture matching the key, recycling a released one if available.
+	/// </summary>
+	/// <param name="key">The texture description</param>
+	/// <param name="isRecycled">Set to true if the texture already owns a matching resource</param>
+	/// <returns>The texture, or nullptr on invalid keys</returns>
+	static UTexture2D* Acquire(const FCLTexturePoolKey& key,
+							   bool& isRecycled);
+
+	/// <summary>
+	/// Assigns the owner of a texture just handed out by Acquire, only it can release the texture.
+	/// </summary>
+	/// <param name="texture">The texture</param>
+	/// <param name="owner">The object holding on to the texture</param>
+	static void SetOwner(UTexture2D* texture,
+						 const UObject* owner);
+
+	/// <summary>
+	/// Returns a texture previously handed out by Acquire to the pool.
+	/// Textures not handed out by the pool, or owned by another object, are ignored.
+	/// </summary>
+	/// <param name="texture">The texture</param>
+	/// <param name="owner">The owner assigned by SetOwner, nullptr for textures without one</param>
+	static void Release(UTexture2D* texture,
+						const UObject* owner = nullptr);
+
+	/// <summary>
+	/// Drops all released textures, letting the garbage collector reclaim them.
+	/// </summary>
+	static void Trim();
+private:
+	static UTexture2D* CreateTexture(const FCLTexturePoolKey& key);
+
+	static FCLTexturePoolKey GetKey(const UTexture2D* texture);
+private:
+	static constexpr int32 MaxFreeTexturesPerKey = 4;
+
+	static FCLTexturePool* Instance;
+
+	TMap<FCLTexturePoolKey, TArray<TObjectPtr<UTexture2D>>> FreeTextures;
+
+	// Textures handed out by Acquire and not released yet, to their owner
+	TMap<FObjectKey, FObjectKey> HandedOutTextures;
+};
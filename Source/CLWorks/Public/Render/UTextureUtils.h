@@ -3,10 +3,108 @@
 #include "Engine/Texture2D.h"
 #include "Engine/TextureRenderTarget2D.h"
 
+#include <functional>
+
+class FTextureResource;
+class FTextureRenderTargetResource;
+
 namespace UTextureUtils
 {
-	static bool BlitTextureToRenderTarget(const TObjectPtr<UTexture2D> source,
-										  TObjectPtr<UTextureRenderTarget2D>& output,
-										  FIntPoint subRect = FIntPoint::ZeroValue,
-										  const std::function<void()>& onWriteComplete = nullptr);
-};
\ No newline at end of file
+	enum EBlitChannel : int32
+	{
+		Red = 0,
+		Green,
+		Blue,
+		Alpha,
+		Zero,
+		One,
+	};
+
+	struct CLWORKS_API FBlitRequest
+	{
+	public:
+		TObjectPtr<UTexture2D> Source = nullptr;
+		TObjectPtr<UTextureRenderTarget2D> Output = nullptr;
+
+		FIntPoint SourceOffset = FIntPoint::ZeroValue;
+		FIntPoint DestOffset = FIntPoint::ZeroValue;
+
+		// Copied region, zero covers the whole source (clipped to the output).
+		FIntPoint Size = FIntPoint::ZeroValue;
+
+		// Source channel written to each output channel (see EBlitChannel), only applies to four channel formats.
+		FIntVector4 Swizzle = FIntVector4(Red, Green, Blue, Alpha);
+	};
+
+	/// <summary>
+	/// Collects blits and records them into a single render graph on submission.
+	/// </summary>
+	class CLWORKS_API FBlitBatch
+	{
+	public:
+		/// <summary>
+		/// Queues a blit, the request is validated and clipped on the game thread.
+		/// </summary>
+		/// <param name="request">The blit</param>
+		/// <param name="onWriteComplete">Game thread callback once the batch has executed</param>
+		/// <returns>True if the blit was queued</returns>
+		bool Add(const FBlitRequest& request,
+				 const std::function<void()>& onWriteComplete = nullptr);
+
+		/// <summary>
+		/// Records all queued blits into one render graph and clears the batch.
+		/// </summary>
+		/// <param name="onBatchComplete">Game thread callback once the batch has executed</param>
+		/// <returns>True if any blits were submitted</returns>
+		bool Submit(const std::function<void()>& onBatchComplete = nullptr);
+
+		int32 Num() const { return mRequests.Num(); }
+	private:
+		// Textures are resolved to their resources on submission, they may be destroyed or
+		// have their resources recreated while queued
+		struct FQueuedBlit
+		{
+			TWeakObjectPtr<UTexture2D> Source;
+			TWeakObjectPtr<UTextureRenderTarget2D> Output;
+
+			FIntPoint SourceOffset;
+			FIntPoint DestOffset;
+			FIntPoint Size;
+			FIntVector4 Swizzle;
+			uint8 ChannelFormat = 0;
+		};
+
+		TArray<FQueuedBlit> mRequests;
+		TArray<std::function<void()>> mCallbacks;
+	};
+
+	/// <summary>
+	/// Retrieves the shared batch flushed once per frame.
+	/// </summary>
+	CLWORKS_API FBlitBatch& GetFrameBatch();
+
+	/// <summary>
+	/// Submits the shared frame batch.
+	/// </summary>
+	CLWORKS_API void FlushFrameBatch();
+
+	CLWORKS_API bool BlitTextureToRenderTarget(const TObjectPtr<UTexture2D> source,
+											   TObjectPtr<UTextureRenderTarget2D>& output,
+											   FIntPoint subRect = FIntPoint::ZeroValue,
+											   const std::function<void()>& onWriteComplete = nullptr);
+
+	/// <summary>
+	/// Uploads host pixels directly into the render target's RHI texture, resolved on the render thread
+	/// so a destroyed target or a recreated resource is never written through a stale pointer.
+	/// The pixel data must match the render target format and is freed by this call.
+	/// </summary>
+	/// <param name="srcData">The pixels, allocated with new[]</param>
+	/// <param name="srcPitch">The row pitch in bytes</param>
+	/// <param name="output">The render target</param>
+	/// <param name="onWriteComplete">Game thread callback once the upload was submitted</param>
+	/// <returns>True if the upload was enqueued</returns>
+	CLWORKS_API bool WriteToRenderTarget(void* srcData,
+										 uint32 srcPitch,
+										 TObjectPtr<UTextureRenderTarget2D>& output,
+										 const std::function<void()>& onWriteComplete = nullptr);
+};
@@ -1,6 +1,8 @@
 #include "CLWorksLibrary.h"
 
 #include "CLWorksLib.h"
+#include "Profiler/CLProfilerManager.h"
+#include "Render/CLTexturePool.h"
 
 #include <memory>
 
@@ -13,15 +15,20 @@ UCLCommandQueueObject* UCLWorksLibrary::mpGlobalQueue = nullptr;
 
 void FCLWorksBlueprintModule::StartupModule()
 {
+	mProfilingChangedHandle = FCLProfilerManager::OnProfilingChanged().AddLambda([](bool bEnabled)
+	{
+		UCLWorksLibrary::RecreateGlobalQueue();
+	});
 }
 
 void FCLWorksBlueprintModule::ShutdownModule()
 {
+	FCLProfilerManager::OnProfilingChanged().Remove(mProfilingChangedHandle);
 }
 
 UCLWorksLibrary::UCLWorksLibrary(const class FObjectInitializer& ObjectInitializer)
 {
-	InitializeLibray();
+	// The global context and queue are created on first use, not while the CDO is constructed at boot
 }
 
 void UCLWorksLibrary::BeginDestroy()
@@ -33,11 +40,53 @@ void UCLWorksLibrary::BeginDestroy()
 
 void UCLWorksLibrary::InitializeLibray()
 {
-	mpGlobalContext = UCLWorksLibrary::CreateCustomContext(0);
-	mpGlobalContext->AddToRoot();
+	if (!mpGlobalContext)
+	{
+		mpGlobalContext = UCLWorksLibrary::CreateCustomContext(0);
+		if (!mpGlobalContext)
+		{
+			UE_LOG(LogCLWorksBlueprint, Error, TEXT("Couldn't Create the Global OpenCL Context!"));
+			return;
+		}
+		mpGlobalContext->AddToRoot();
+	}
 
-	mpGlobalQueue = UCLWorksLibrary::CreateCommandQueue(mpGlobalContext);
-	mpGlobalQueue->AddToRoot();
+	if (!mpGlobalQueue)
+	{
+		mpGlobalQueue = UCLWorksLibrary::CreateCommandQueue(mpGlobalContext);
+		if (!mpGlobalQueue)
+		{
+			UE_LOG(LogCLWorksBlueprint, Error, TEXT("Couldn't Create the Global OpenCL Queue!"));
+			return;
+		}
+		mpGlobalQueue->AddToRoot();
+	}
+}
+
+UCLContextObject* UCLWorksLibrary::GetGlobalContext()
+{
+	if (!mpGlobalContext)
+		InitializeLibray();
+	return mpGlobalContext;
+}
+
+UCLCommandQueueObject* UCLWorksLibrary::GetGlobalQueue()
+{
+	if (!mpGlobalQueue)
+		InitializeLibray();
+	return mpGlobalQueue;
+}
+
+void UCLWorksLibrary::RecreateGlobalQueue()
+{
+	// Not created yet, the first use picks up the setting
+	if (!mpGlobalQueue || !mpGlobalContext)
+		return;
+
+	// Work already enqueued keeps the previous queue alive until the last reference drops
+	mpGlobalQueue->Initialize(mpGlobalContext);
+	if (!mpGlobalQueue->IsValid())
+		UE_LOG(LogCLWorksBlueprint, Error, TEXT("Couldn't Recreate the Global OpenCL Queue!"));
 }
 
 void UCLWorksLibrary::DeinitializeLibray()
@@ -78,9 +127,16 @@ UCLContextObject* UCLWorksLibrary::CreateCustomContext(int32 deviceIndex)
 
 UCLCommandQueueObject* UCLWorksLibrary::CreateCommandQueue(UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLCommandQueueObject* queue = NewObject<UCLCommandQueueObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	queue->Initialize(contextOverride ? contextOverride : mpGlobalContext);
+	queue->Initialize(context);
 
 	if (!queue->IsValid())
 	{
@@ -100,9 +156,16 @@ UCLProgramObject* UCLWorksLibrary::CreateProgram(UCLProgramAsset* asset,
 		return nullptr;
 	}
 
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLProgramObject* program = NewObject<UCLProgramObject>(GetTransientPackage(), NAME_None, RF_Transient);
 	
-	program->Initialize(contextOverride ? contextOverride : mpGlobalContext, asset, kernelName);
+	program->Initialize(context, asset, kernelName);
 
 	if (!program->IsValid())
 	{
@@ -117,9 +180,16 @@ UCLBufferObject* UCLWorksLibrary::CreateIntBuffer(const TArray<int32>& values,
 												  UCLMemoryStrategy strategy,
 												  UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(int32),
 					   access,
@@ -138,9 +208,16 @@ UCLBufferObject* UCLWorksLibrary::CreateFloatBuffer(const TArray<float>& values,
 													UCLMemoryStrategy strategy,
 													UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(float),
 					   access,
@@ -159,9 +236,16 @@ UCLBufferObject* UCLWorksLibrary::CreateIntVector2Buffer(const TArray<FIntPoint>
 														 UCLMemoryStrategy strategy,
 														 UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(FIntPoint),
 					   access,
@@ -180,9 +264,16 @@ UCLBufferObject* UCLWorksLibrary::CreateIntVector4Buffer(const TArray<FIntVector
 														 UCLMemoryStrategy strategy,
 														 UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(FIntVector4),
 					   access,
@@ -201,9 +292,16 @@ UCLBufferObject* UCLWorksLibrary::CreateVector2fBuffer(const TArray<FVector2f>&
 													   UCLMemoryStrategy strategy,
 													   UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(FVector2f),
 					   access,
@@ -222,9 +320,16 @@ UCLBufferObject* UCLWorksLibrary::CreateVector4fBuffer(const TArray<FVector4f>&
 													   UCLMemoryStrategy strategy,
 													   UCLContextObject* contextOverride)
 {
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
+
 	UCLBufferObject* buffer = NewObject<UCLBufferObject>(GetTransientPackage(), NAME_None, RF_Transient);
 
-	buffer->Initialize(contextOverride ? contextOverride : mpGlobalContext,
+	buffer->Initialize(context,
 					   (void*)values.GetData(),
 					   values.Num() * sizeof(FVector4f),
 					   access,
@@ -246,7 +351,12 @@ UCLImageObject* UCLWorksLibrary::CreateImage(int32 width,
 											 UCLAccessType access, 
 											 UCLContextObject* contextOverride)
 {
-	UCLContextObject* context = contextOverride ? contextOverride : mpGlobalContext;
+	UCLContextObject* context = contextOverride ? contextOverride : GetGlobalContext();
+	if (!context)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Context!"));
+		return nullptr;
+	}
 
 	if (!context->HasImageSupport())
 	{
@@ -296,7 +406,13 @@ bool UCLWorksLibrary::RunProgram(UCLProgramObject* program,
 		return false;
 	}
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return false;
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 
 	commandQueue.EnqueueRange(*program->mpKernel, 
 							  dimensions, 
@@ -313,7 +429,13 @@ TArray<int32> UCLWorksLibrary::ReadIntBuffer(UCLBufferObject* buffer,
 	TArray<int32> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(int32), 0);
 
 	return output;
@@ -327,7 +449,13 @@ TArray<float> UCLWorksLibrary::ReadFloatBuffer(UCLBufferObject* buffer,
 	TArray<float> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(float), 0);
 
 	return output;
@@ -341,7 +469,13 @@ TArray<FIntPoint> UCLWorksLibrary::ReadIntVector2Buffer(UCLBufferObject* buffer,
 	TArray<FIntPoint> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(FIntPoint), 0);
 
 	return output;
@@ -355,7 +489,13 @@ TArray<FIntVector4> UCLWorksLibrary::ReadIntVector4Buffer(UCLBufferObject* buffe
 	TArray<FIntVector4> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(FIntVector4), 0);
 
 	return output;
@@ -369,7 +509,13 @@ TArray<FVector2f> UCLWorksLibrary::ReadVector2fBuffer(UCLBufferObject* buffer,
 	TArray<FVector2f> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(FVector2f), 0);
 
 	return output;
@@ -383,7 +529,13 @@ TArray<FVector4f> UCLWorksLibrary::ReadVector4fBuffer(UCLBufferObject* buffer,
 	TArray<FVector4f> output;
 	output.SetNumZeroed(numElements);
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return {};
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 	buffer->mpBuffer->Fetch(commandQueue, output.GetData(), numElements * sizeof(FVector4f), 0);
 
 	return output;
@@ -392,7 +544,8 @@ TArray<FVector4f> UCLWorksLibrary::ReadVector4fBuffer(UCLBufferObject* buffer,
 UTexture2D* UCLWorksLibrary::ImageToTexture2D(UCLImageObject* image, 
 											  UCLCommandQueueObject* queueOverride,
 											  bool isSRGB,
-											  bool generateMipMaps)
+											  bool generateMipMaps,
+											  bool recyclePrevious)
 {
 	if (image->GetData() == nullptr)
 	{
@@ -400,9 +553,79 @@ UTexture2D* UCLWorksLibrary::ImageToTexture2D(UCLImageObject* image,
 		return nullptr;
 	}
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return nullptr;
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
+
+	// Hand the previous conversion back to the pool, a matching request picks it up again and uploads in place.
+	if (recyclePrevious)
+		FCLTexturePool::Release(Cast<UTexture2D>(image->Texture), image);
 
-	return image->mpImage->CreateUTexture2D(commandQueue, isSRGB, generateMipMaps);
+	UTexture2D* texture = image->mpImage->CreateUTexture2D(commandQueue, isSRGB, generateMipMaps);
+	FCLTexturePool::SetOwner(texture, image);
+	image->Texture = texture;
+
+	return texture;
+}
+
+UTexture2D* UCLWorksLibrary::ImageToCompressedTexture2D(UCLImageObject* image,
+														UCLTextureCompression compression,
+														UCLCommandQueueObject* queueOverride,
+														bool isSRGB,
+														bool recyclePrevious)
+{
+	if (image->GetData() == nullptr)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Image!"));
+		return nullptr;
+	}
+
+	OpenCL::Image::Compression clCompression = OpenCL::Image::Compression::None;
+	switch (compression)
+	{
+	case UCLTextureCompression::BC1:
+		clCompression = OpenCL::Image::Compression::BC1;
+		break;
+	case UCLTextureCompression::BC4:
+		clCompression = OpenCL::Image::Compression::BC4;
+		break;
+	case UCLTextureCompression::BC5:
+		clCompression = OpenCL::Image::Compression::BC5;
+		break;
+	case UCLTextureCompression::BC7:
+		clCompression = OpenCL::Image::Compression::BC7;
+		break;
+	}
+
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return nullptr;
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
+
+	if (recyclePrevious)
+		FCLTexturePool::Release(Cast<UTexture2D>(image->Texture), image);
+
+	UTexture2D* texture = image->mpImage->CreateCompressedUTexture2D(commandQueue, clCompression, isSRGB);
+	FCLTexturePool::SetOwner(texture, image);
+	image->Texture = texture;
+
+	return texture;
+}
+
+void UCLWorksLibrary::ReleaseTexture2D(UCLImageObject* image)
+{
+	if (!image)
+		return;
+
+	FCLTexturePool::Release(Cast<UTexture2D>(image->Texture), image);
+	image->Texture = nullptr;
 }
 
 UTexture2DArray* UCLWorksLibrary::ImageToTexture2DArray(UCLImageObject* image, 
@@ -416,7 +639,13 @@ UTexture2DArray* UCLWorksLibrary::ImageToTexture2DArray(UCLImageObject* image,
 		return nullptr;
 	}
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return nullptr;
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 
 	return image->mpImage->CreateUTexture2DArray(commandQueue, isSRGB, generateMipMaps);
 }
@@ -431,7 +660,13 @@ bool UCLWorksLibrary::WriteToRenderTarget2D(UTextureRenderTarget2D* output,
 		return false;
 	}
 
-	OpenCL::CommandQueue& commandQueue = queueOverride ? *queueOverride->mpQueue : *mpGlobalQueue->mpQueue;
+	UCLCommandQueueObject* queueObject = queueOverride ? queueOverride : GetGlobalQueue();
+	if (!queueObject || !queueObject->mpQueue)
+	{
+		UE_LOG(LogCLWorksBlueprint, Warning, TEXT("Invalid Command Queue!"));
+		return false;
+	}
+	OpenCL::CommandQueue& commandQueue = *queueObject->mpQueue;
 
 	return image->mpImage->UploadToUTextureRenderTarget2D(output, commandQueue);
 }
\ No newline at end of file
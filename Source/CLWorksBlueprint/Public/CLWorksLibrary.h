@@ -20,6 +20,7 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 private:
+	FDelegateHandle mProfilingChangedHandle;
 };
 
 
@@ -44,8 +45,19 @@ public:
 
 	virtual void BeginDestroy() override;
 public:
-	void InitializeLibray();
-	void DeinitializeLibray();
+	static void InitializeLibray();
+	static void DeinitializeLibray();
+
+	/// <summary>
+	/// The context and queue used without overrides, created on first use.
+	/// </summary>
+	static UCLContextObject* GetGlobalContext();
+	static UCLCommandQueueObject* GetGlobalQueue();
+
+	/// <summary>
+	/// Recreates the global queue so it picks up the current profiling setting.
+	/// </summary>
+	static void RecreateGlobalQueue();
 public:
 	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Create Custom Context")
 	static UCLContextObject* CreateCustomContext(int32 deviceIndex);
@@ -149,7 +161,21 @@ public:
 	static UTexture2D* ImageToTexture2D(UCLImageObject* image,
 									    UCLCommandQueueObject* queueOverride = nullptr,
 										bool isSRGB = true,
-									    bool generateMipMaps = false);
+									    bool generateMipMaps = false,
+										bool recyclePrevious = false);
+
+	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Convert To Compressed Texture2D")
+	static UTexture2D* ImageToCompressedTexture2D(UCLImageObject* image,
+												  UCLTextureCompression compression,
+												  UCLCommandQueueObject* queueOverride = nullptr,
+												  bool isSRGB = true,
+												  bool recyclePrevious = false);
+
+	/// <summary>
+	/// Hands the image's last converted texture back to the pool, it must no longer be used.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Release Texture2D")
+	static void ReleaseTexture2D(UCLImageObject* image);
 
 	UFUNCTION(BlueprintCallable, Category = "OpenCL", DisplayName = "Convert To Texture2DArray")
 	static UTexture2DArray* ImageToTexture2DArray(UCLImageObject* image,
@@ -11,8 +11,8 @@ void SShaderEditorWidget::Construct(const FArguments& InArgs)
 	// Initial Internal Data --------------------
 	mpProgramData = MakeShared<ProgramData>();
 
-	mpProgramData->mpDevice = OpenCL::MakeDevice();
-	mpProgramData->mpContext = OpenCL::MakeContext(mpProgramData->mpDevice);
+	mpProgramData->mpDevice = OpenCL::Registry::GetDevice();
+	mpProgramData->mpContext = OpenCL::Registry::GetContext(mpProgramData->mpDevice);
 	// ------------------------------------------
 
 	ChildSlot
@@ -1,4 +1,4 @@
 #pragma once
 
-#include "Cl/cl.h"
-#include "Cl/cl_ext.h"
+#include "CL/cl.h"
+#include "CL/cl_ext.h"
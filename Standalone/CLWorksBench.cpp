@@ -0,0 +1,299 @@
+// Headless counterpart of the "CLWorks Benchmark" automation spec, runs the
+// core paths that don't need Unreal (e.g. on a POCL CPU device):
+//   CLWorksBench [--platform N] [--device N] [--output Results.json] [--baseline Previous.json] [--tolerance 10]
+//   CLWorksBench --list
+// Exits with 1 if any benchmark regressed beyond the tolerance.
+
+#include "Core/CLBuffer.h"
+#include "Core/CLCommandQueue.h"
+#include "Core/CLContext.h"
+#include "Core/CLDevice.h"
+#include "Core/CLKernel.h"
+#include "Core/CLLog.h"
+#include "Core/CLProgram.h"
+
+#include "Utils/MipGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Result
+	{
+		double Value = 0.0;
+		std::string Unit;
+		bool IsHigherBetter = true;
+	};
+
+	std::map<std::string, Result> Results;
+
+	double Now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Best wall time of the repetitions in seconds, after one warm up run
+	template<typename Func>
+	double TimeBest(int repetitions, 
+					Func&& func)
+	{
+		func();
+
+		double best = 1e30;
+		for (int i = 0; i < repetitions; ++i)
+		{
+			const double start = Now();
+			func();
+			best = std::min(best, Now() - start);
+		}
+		return best;
+	}
+
+	void Report(const std::string& name, 
+				double value, 
+				const char* unit, 
+				bool isHigherBetter)
+	{
+		std::printf("%-40s %12.3f %s\n", name.c_str(), value, unit);
+		Results[name] = Result{ value, unit, isHigherBetter };
+	}
+
+	double ToMBps(size_t bytes, double seconds)
+	{
+		return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+	}
+
+	// Same layout as the automation spec: { "name": { "value": 1.0, "unit": "MB/s", "higherIsBetter": true } }
+	bool WriteResults(const std::string& path)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+			return false;
+
+		file << "{\n";
+		for (auto itr = Results.begin(); itr != Results.end(); ++itr)
+		{
+			file << "\t\"" << itr->first << "\": { \"value\": " << itr->second.Value
+				 << ", \"unit\": \"" << itr->second.Unit
+				 << "\", \"higherIsBetter\": " << (itr->second.IsHigherBetter ? "true" : "false") << " }"
+				 << (std::next(itr) != Results.end() ? ",\n" : "\n");
+		}
+		file << "}\n";
+		return true;
+	}
+
+	// Only reads the values written by WriteResults or the automation spec
+	std::map<std::string, double> ReadBaseline(const std::string& path)
+	{
+		std::map<std::string, double> baseline;
+
+		std::ifstream file(path);
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		const std::string json = buffer.str();
+
+		size_t pos = 0;
+		while ((pos = json.find("\"value\"", pos)) != std::string::npos)
+		{
+			const size_t nameEnd = json.rfind('"', json.rfind('{', pos) - 1);
+			const size_t nameStart = json.rfind('"', nameEnd - 1);
+
+			const size_t valueStart = json.find(':', pos) + 1;
+			baseline[json.substr(nameStart + 1, nameEnd - nameStart - 1)] = std::strtod(json.c_str() + valueStart, nullptr);
+			pos = valueStart;
+		}
+		return baseline;
+	}
+
+	void BenchmarkBuffers(const OpenCL::DevicePtr& device, 
+						  const OpenCL::ContextPtr& context)
+	{
+		const OpenCL::MemoryStrategy strategies[] =
+		{
+			OpenCL::MemoryStrategy::COPY_ONCE,
+			OpenCL::MemoryStrategy::STREAM,
+			OpenCL::MemoryStrategy::ZERO_COPY
+		};
+		const char* strategyNames[] = { "CopyOnce", "Stream", "ZeroCopy" };
+
+		const size_t sizes[] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024 };
+
+		OpenCL::CommandQueue queue(context, device);
+
+		for (size_t s = 0; s < 3; ++s)
+		{
+			for (size_t size : sizes)
+			{
+				std::vector<uint8_t> host(size, 1);
+
+				OpenCL::Buffer buffer(device, context, host.data(), size, OpenCL::AccessType::READ_WRITE, strategies[s]);
+				if (!buffer.IsValid())
+					continue;
+
+				const std::string name = std::string("Buffer.") + strategyNames[s] + "." + std::to_string(size / 1024) + "KB";
+
+				// COPY_ONCE buffers can't be uploaded into after creation
+				if (strategies[s] != OpenCL::MemoryStrategy::COPY_ONCE)
+				{
+					const double uploadSeconds = TimeBest(5, [&]()
+					{
+						buffer.Upload(queue, host.data(), size);
+						queue.WaitForFinish();
+					});
+					Report(name + ".Upload", ToMBps(size, uploadSeconds), "MB/s", true);
+				}
+
+				const double fetchSeconds = TimeBest(5, [&]()
+				{
+					buffer.Fetch(queue, host.data(), size);
+				});
+				Report(name + ".Readback", ToMBps(size, fetchSeconds), "MB/s", true);
+			}
+		}
+	}
+
+	void BenchmarkKernels(const OpenCL::DevicePtr& device, 
+						  const OpenCL::ContextPtr& context)
+	{
+		const char* source = "__kernel void scale(__global float* data, float factor)\n"
+							 "{ int i = get_global_id(0);\n"
+							 "data[i] = data[i] * factor + sin(data[i]); }";
+
+		// Drivers may keep their own binary cache, cold builds use a fresh context each time
+		const double buildSeconds = TimeBest(3, [&]()
+		{
+			OpenCL::ContextPtr buildContext = OpenCL::MakeContext(device);
+			OpenCL::Program program(buildContext, device);
+			program.ReadFromString(source);
+		});
+		Report("Program.Build.Cold", buildSeconds * 1e3, "ms", false);
+
+		OpenCL::Program program(context, device);
+		if (!program.ReadFromString(source))
+			return;
+
+		const size_t count = 1;
+		OpenCL::Buffer buffer(device, context, nullptr, sizeof(float), OpenCL::AccessType::READ_WRITE, OpenCL::MemoryStrategy::STREAM);
+
+		OpenCL::Kernel kernel(program, "scale");
+		if (!kernel.SetArgument<OpenCL::Buffer>(0, buffer) || !kernel.SetArgument(1, 1.0f))
+			return;
+
+		OpenCL::CommandQueue queue(context, device);
+
+		const int launches = 1000;
+		const double seconds = TimeBest(3, [&]()
+		{
+			for (int i = 0; i < launches; ++i)
+				queue.EnqueueRange(kernel, 1, &count);
+			queue.WaitForFinish();
+		});
+		Report("Kernel.EnqueueRange", seconds * 1e6 / launches, "us", false);
+	}
+
+	template<typename T>
+	void BenchmarkMips(const char* format, 
+					   T value,
+					   void (*generate)(std::vector<Mip>&, T* const, size_t, size_t, size_t, uint8_t))
+	{
+		const size_t width = 1024;
+		const size_t height = 1024;
+		const uint8_t channels = 4;
+
+		std::vector<T> src(width * height * channels, value);
+		std::vector<Mip> mips;
+
+		const double seconds = TimeBest(3, [&]()
+		{
+			generate(mips, src.data(), width, height, 1, channels);
+
+			// The first mip is the source
+			for (size_t i = 1; i < mips.size(); ++i)
+				delete[] static_cast<T*>(mips[i].mPixels);
+			mips.clear();
+		});
+		Report(std::string("MipGenerator.") + format, seconds > 0.0 ? width * height / seconds * 1e-6 : 0.0, "MPixels/s", true);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t platformIndex = 0;
+	uint32_t deviceIndex = 0;
+	std::string outputFile = "CLWorksBenchResults.json";
+	std::string baselineFile;
+	double tolerance = 10.0;
+
+	if (argc == 2 && !std::strcmp(argv[1], "--list"))
+	{
+		OpenCL::SetLogSink([](OpenCL::LogLevel, const char* message) { std::printf("%s\n", message); });
+		OpenCL::DeviceEnumerator::Dump();
+		return 0;
+	}
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (!std::strcmp(argv[i], "--platform"))
+			platformIndex = static_cast<uint32_t>(std::atoi(argv[i + 1]));
+		else if (!std::strcmp(argv[i], "--device"))
+			deviceIndex = static_cast<uint32_t>(std::atoi(argv[i + 1]));
+		else if (!std::strcmp(argv[i], "--output"))
+			outputFile = argv[i + 1];
+		else if (!std::strcmp(argv[i], "--baseline"))
+			baselineFile = argv[i + 1];
+		else if (!std::strcmp(argv[i], "--tolerance"))
+			tolerance = std::atof(argv[i + 1]);
+	}
+
+	OpenCL::DevicePtr device = OpenCL::MakeDevice(deviceIndex, platformIndex);
+	if (!device->Get())
+	{
+		CL_LOG(Error, "No OpenCL Device at Platform %u, Device %u!", platformIndex, deviceIndex);
+		return 2;
+	}
+
+	OpenCL::ContextPtr context = OpenCL::MakeContext(device);
+
+	BenchmarkBuffers(device, context);
+	BenchmarkKernels(device, context);
+
+	BenchmarkMips<uint8_t>("Int8", 128, &MipGenerator::GenerateMipsInt8);
+	BenchmarkMips<uint32_t>("UInt32", 128, &MipGenerator::GenerateMipsUInt32);
+	BenchmarkMips<int32_t>("Int32", 128, &MipGenerator::GenerateMipsInt32);
+	BenchmarkMips<uint16_t>("Float16", 0x3800 /* 0.5 */, &MipGenerator::GenerateMipsFloat16);
+	BenchmarkMips<float>("Float", 0.5f, &MipGenerator::GenerateMipsFloat);
+
+	if (!WriteResults(outputFile))
+		CL_LOG(Error, "Failed Writing Benchmark Results: %s", outputFile.c_str());
+
+	if (baselineFile.empty())
+		return 0;
+
+	int regressions = 0;
+	for (const auto& [name, baselineValue] : ReadBaseline(baselineFile))
+	{
+		auto found = Results.find(name);
+		if (found == Results.end() || baselineValue <= 0.0)
+			continue;
+
+		const Result& result = found->second;
+
+		// Positive is an improvement
+		const double change = (result.IsHigherBetter ? result.Value - baselineValue : baselineValue - result.Value) / baselineValue * 100.0;
+		if (change < -tolerance)
+		{
+			std::printf("Regression %s: %.3f %s vs Baseline %.3f %s (%.1f%%)\n", name.c_str(), result.Value, result.Unit.c_str(), baselineValue, result.Unit.c_str(), change);
+			++regressions;
+		}
+	}
+	return regressions > 0 ? 1 : 0;
+}